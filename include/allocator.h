@@ -0,0 +1,165 @@
+/*! @file allocator.h
+    @brief alocadores que podem ser usados pelo vector.
+*/
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#ifndef CSTDLIB
+#define CSTDLIB
+#include <cstdlib>
+#endif
+
+#ifndef NEW
+#define NEW
+#include <new>
+#endif
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef SYS_MMAN_H
+#define SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+/*! @brief alocador baseado em malloc/free que também oferece 'reallocate'.
+    Com ele, e T relocável (ver is_relocatable), o reserve do vector usa realloc: o bloco cresce no lugar quando há
+    espaço livre depois dele, e blocos grandes (acima do M_MMAP_THRESHOLD da glibc) crescem com mremap, sem cópia.
+    @tparam T tipo de dado alocado
+*/
+template < typename T >
+class malloc_allocator {
+    public:
+        typedef T value_type;  /*!< @var tipo de dado alocado */
+
+        static_assert( alignof(T) <= alignof(std::max_align_t), "malloc nao garante o alinhamento de T" );
+
+        malloc_allocator( void ) { /* empty */ }
+
+        template < typename U >
+        malloc_allocator( const malloc_allocator<U>& ) { /* empty */ }
+
+        /**
+        * @brief aloca memória bruta para 'n' elementos
+        * @param n quantidade de elementos
+        * @return ponteiro para a memória
+        */
+        T * allocate( size_t n ){
+            if ( n > size_t(-1) / sizeof(T) ) throw std::bad_alloc();
+            void * p = std::malloc( n*sizeof(T) );
+            if ( p == nullptr ) throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+
+        /**
+        * @brief devolve a memória
+        * @param p memória obtida com allocate ou reallocate
+        */
+        void deallocate( T * p, size_t ){
+            std::free( p );
+        }
+
+        /**
+        * @brief muda o tamanho de um bloco mantendo seu conteúdo (bytes), como o realloc
+        * @param p bloco atual, pode ser nullptr
+        * @param new_n nova quantidade de elementos
+        * @return ponteiro para o bloco, possivelmente o mesmo 'p'
+        */
+        T * reallocate( T * p, size_t, size_t new_n ){
+            if ( new_n > size_t(-1) / sizeof(T) ) throw std::bad_alloc();
+            void * q = std::realloc( static_cast<void*>(p), new_n*sizeof(T) );
+            if ( q == nullptr ) throw std::bad_alloc();
+            return static_cast<T*>(q);
+        }
+
+        template < typename U >
+        bool operator==( const malloc_allocator<U>& ) const{ return true; }
+
+        template < typename U >
+        bool operator!=( const malloc_allocator<U>& ) const{ return false; }
+};
+
+/*! @brief alocador com alinhamento escolhido e, para blocos grandes, páginas enormes (transparent huge pages).
+    Todo bloco começa num múltiplo de Alignment (ex: 64 para linha de cache e loads AVX alinhados, 4096 para
+    página). Blocos de HugePageBytes bytes ou mais são alinhados a 2MB, arredondados para múltiplos de 2MB e
+    marcados com madvise(MADV_HUGEPAGE): cada página do TLB cobre 2MB em vez de 4KB, o que reduz as faltas no
+    TLB em acessos aleatórios a vectors grandes. HugePageBytes = 0 desliga as páginas enormes.
+    O alinhamento vale para o começo do bloco: data() está alinhado enquanto o vector não tiver espaço livre no
+    começo (depois de pop_front/erase do começo, ver front_gap).
+    ex: vector<float, aligned_allocator<float, 64, 64 << 20>> v;
+    @tparam T tipo de dado alocado
+    @tparam Alignment alinhamento de cada bloco, potência de 2 e no mínimo alignof(T)
+    @tparam HugePageBytes tamanho a partir do qual o bloco usa páginas enormes, ou 0
+*/
+template < typename T, size_t Alignment = 64, size_t HugePageBytes = 0 >
+class aligned_allocator {
+    public:
+        typedef T value_type;  /*!< @var tipo de dado alocado */
+
+        static const size_t alignment = Alignment;  //!< alinhamento de cada bloco
+        static const size_t huge_page = size_t(2) << 20;  //!< tamanho da página enorme (x86-64 e arm64)
+
+        static_assert( ( Alignment & ( Alignment-1 ) ) == 0, "Alignment precisa ser potencia de 2" );
+        static_assert( Alignment >= alignof(T), "Alignment menor que o alinhamento de T" );
+
+        /*! @brief o mesmo alocador para outro tipo; necessário porque os parâmetros não são todos tipos */
+        template < typename U >
+        struct rebind {
+            typedef aligned_allocator<U, Alignment, HugePageBytes> other;
+        };
+
+        aligned_allocator( void ) { /* empty */ }
+
+        template < typename U >
+        aligned_allocator( const aligned_allocator<U, Alignment, HugePageBytes>& ) { /* empty */ }
+
+        /**
+        * @brief aloca memória bruta, alinhada, para 'n' elementos
+        * @param n quantidade de elementos
+        * @return ponteiro para a memória
+        */
+        T * allocate( size_t n ){
+            if ( n > ( size_t(-1) - huge_page ) / sizeof(T) ) throw std::bad_alloc();
+            size_t bytes = n*sizeof(T);
+            if ( uses_huge_pages( bytes ) ){
+                size_t rounded = ( bytes + huge_page - 1 ) / huge_page * huge_page;
+                void * p = std::aligned_alloc( huge_page, rounded );
+                if ( p == nullptr ) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+                // só um pedido: se o sistema não tiver páginas enormes livres, usa páginas normais.
+                ::madvise( p, rounded, MADV_HUGEPAGE );
+#endif
+                return static_cast<T*>(p);
+            }
+            return static_cast<T*>( ::operator new( bytes, std::align_val_t( Alignment ) ) );
+        }
+
+        /**
+        * @brief devolve a memória
+        * @param p memória obtida com allocate
+        * @param n a mesma quantidade pedida em allocate
+        */
+        void deallocate( T * p, size_t n ){
+            if ( uses_huge_pages( n*sizeof(T) ) ){
+                std::free( p );
+                return;
+            }
+            ::operator delete( static_cast<void*>(p), std::align_val_t( Alignment ) );
+        }
+
+        /** @brief true se um bloco de 'bytes' usa páginas enormes */
+        static bool uses_huge_pages( size_t bytes ){
+            return HugePageBytes != 0 && bytes >= HugePageBytes;
+        }
+
+        template < typename U >
+        bool operator==( const aligned_allocator<U, Alignment, HugePageBytes>& ) const{ return true; }
+
+        template < typename U >
+        bool operator!=( const aligned_allocator<U, Alignment, HugePageBytes>& ) const{ return false; }
+};
+
+#endif
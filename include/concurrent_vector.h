@@ -0,0 +1,349 @@
+/*! @file concurrent_vector.h
+    @brief vector só de acréscimo em que várias threads fazem push_back ao mesmo tempo, sem lock.
+
+    Os elementos moram em segmentos que nunca mudam de lugar: o segmento 0 tem first_segment elementos e o
+    segmento k (k > 0) tem first_segment * 2^(k-1), então crescer só aloca o próximo segmento e nenhum ponteiro
+    ou referência já entregue é invalidado.
+    - push_back/grow_by reservam índices com um CAS no contador de reservados, depois de obter os segmentos
+      que os cobrem; se um construtor lançar, os índices restantes da reserva são marcados como vazios
+    - o segmento que falta é alocado por quem precisar primeiro; quem perder a corrida (CAS) libera o seu
+    - cada elemento construido é marcado como pronto, e o tamanho publicado (size()) avança enquanto os
+      próximos estiverem prontos; qualquer thread pode ler [0, size()) enquanto outras acrescentam
+*/
+
+#ifndef ATOMIC
+#define ATOMIC
+#include <atomic>
+#endif
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef ITERATOR
+#define ITERATOR
+#include <iterator>
+#endif
+
+#ifndef MEMORY
+#define MEMORY
+#include <memory>
+#endif
+
+#ifndef STDEXCEPT
+#define STDEXCEPT
+#include <stdexcept>
+#endif
+
+/*! @brief vector de acréscimo concorrente com segmentos de endereço fixo
+    @tparam T tipo de dado armazenado
+    @tparam Allocator alocador da memória dos segmentos
+*/
+template < typename T, typename Allocator = std::allocator<T> >
+class concurrent_vector {
+    public:
+        typedef T value_type;  /*!< @var tipo de dado armazenado */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos e índices */
+        typedef T& reference;
+        typedef const T& const_reference;
+
+        static const size_t first_segment_log2 = 5; //!< o segmento 0 tem 2^5 elementos
+        static const size_t first_segment = size_t(1) << first_segment_log2;
+        static const size_t max_segments = 64 - first_segment_log2 + 1;
+
+        /**
+        * @brief construtor vazio, nenhum segmento alocado
+        * @param alloc alocador a ser usado
+        */
+        explicit concurrent_vector( const Allocator& alloc = Allocator() )
+            : allocator{ alloc },
+            reserved{ 0 },
+            published{ 0 }
+        {
+            for ( size_t k = 0; k < max_segments; ++k ) segments[k].store( nullptr, std::memory_order_relaxed );
+        }
+
+        concurrent_vector( const concurrent_vector& ) = delete;
+        concurrent_vector& operator=( const concurrent_vector& ) = delete;
+
+        /** @brief destroi os elementos e libera os segmentos; nenhuma thread pode estar usando o vector */
+        ~concurrent_vector(){
+            clear();
+            for ( size_t k = 0; k < max_segments; ++k ){
+                segment * s = segments[k].load( std::memory_order_relaxed );
+                if ( s != nullptr ) free_segment( s, segment_size(k) );
+            }
+        }
+
+        /**
+        * @brief acrescenta uma cópia de value, de qualquer thread
+        * @return índice do novo elemento
+        */
+        size_t push_back( const T& value ){
+            return emplace_back( value );
+        }
+
+        /**
+        * @brief acrescenta value por move, de qualquer thread
+        * @return índice do novo elemento
+        */
+        size_t push_back( T&& value ){
+            return emplace_back( std::move(value) );
+        }
+
+        /**
+        * @brief constroi um elemento no fim, de qualquer thread
+        * @return índice do novo elemento
+        */
+        template < typename... Args >
+        size_t emplace_back( Args&&... args ){
+            size_t i = reserve_indices( 1 );
+            try{
+                construct_at( i, std::forward<Args>(args)... );
+            }catch(...){
+                fail_range( i, i+1 );
+                throw;
+            }
+            publish();
+            return i;
+        }
+
+        /**
+        * @brief acrescenta n cópias de value numa única reserva de índices, de qualquer thread
+        * @return índice do primeiro dos novos elementos
+        */
+        size_t grow_by( size_t n, const T& value = T() ){
+            size_t first = reserve_indices( n );
+            size_t i = first;
+            try{
+                for ( ; i < first+n; ++i ) construct_at( i, value );
+            }catch(...){
+                fail_range( i, first+n );
+                throw;
+            }
+            publish();
+            return first;
+        }
+
+        /**
+        * @brief acrescenta os elementos de [first, last) numa única reserva de índices, de qualquer thread
+        * @return índice do primeiro dos novos elementos
+        */
+        template < typename ForwardIt, typename = typename std::iterator_traits<ForwardIt>::iterator_category >
+        size_t grow_by( ForwardIt first, ForwardIt last ){
+            size_t n = (size_t) std::distance( first, last );
+            size_t start = reserve_indices( n );
+            size_t i = start;
+            try{
+                for ( ; first != last; ++first, ++i ) construct_at( i, *first );
+            }catch(...){
+                fail_range( i, start+n );
+                throw;
+            }
+            publish();
+            return start;
+        }
+
+        /**
+        * @brief aloca antes os segmentos para n elementos; nada muda de lugar, não invalida nada
+        * @param n quantidade de elementos
+        */
+        void reserve( size_t n ){
+            if ( n == 0 ) return;
+            for ( size_t k = 0; k <= segment_of( n-1 ); ++k ) get_segment( k );
+        }
+
+        /**
+        * @brief quantidade de elementos publicados: [0, size()) pode ser lido de qualquer thread
+        */
+        size_t size( void ) const{
+            return published.load( std::memory_order_acquire );
+        }
+
+        /** @brief true se nenhum elemento foi publicado */
+        bool empty( void ) const{
+            return size() == 0;
+        }
+
+        /** @brief quantidade de elementos que cabem nos segmentos já alocados */
+        size_t capacity( void ) const{
+            size_t k = 0;
+            while ( k < max_segments && segments[k].load( std::memory_order_acquire ) != nullptr ) ++k;
+            return ( k == 0 ) ? 0 : segment_base( k-1 ) + segment_size( k-1 );
+        }
+
+        /**
+        * @brief elemento i, sem verificação; i < size() é seguro em qualquer thread
+        */
+        T& operator[]( size_t i ){
+            size_t k = segment_of( i );
+            return segments[k].load( std::memory_order_acquire )->data[ i - segment_base(k) ];
+        }
+
+        const T& operator[]( size_t i ) const{
+            size_t k = segment_of( i );
+            return segments[k].load( std::memory_order_acquire )->data[ i - segment_base(k) ];
+        }
+
+        /**
+        * @brief elemento i
+        * @throw std::out_of_range se i >= size()
+        */
+        T& at( size_t i ){
+            if ( i >= size() ) throw std::out_of_range( "concurrent_vector::at" );
+            return (*this)[i];
+        }
+
+        const T& at( size_t i ) const{
+            if ( i >= size() ) throw std::out_of_range( "concurrent_vector::at" );
+            return (*this)[i];
+        }
+
+        /**
+        * @brief false se o construtor do elemento i lançou exceção: o índice ficou vazio e não deve ser lido
+        */
+        bool constructed( size_t i ) const{
+            size_t k = segment_of( i );
+            return segments[k].load( std::memory_order_acquire )->ready[ i - segment_base(k) ].load( std::memory_order_acquire ) == slot_ready;
+        }
+
+        /**
+        * @brief destroi todos os elementos e mantém os segmentos; nenhuma outra thread pode estar usando o vector
+        */
+        void clear( void ){
+            size_t n = reserved.load( std::memory_order_relaxed );
+            for ( size_t i = 0; i < n; ++i ){
+                size_t k = segment_of( i );
+                segment * s = segments[k].load( std::memory_order_relaxed );
+                std::atomic<unsigned char>& flag = s->ready[ i - segment_base(k) ];
+                if ( flag.load( std::memory_order_relaxed ) == slot_ready ){
+                    alloc_traits::destroy( allocator, s->data + ( i - segment_base(k) ) );
+                }
+                flag.store( slot_empty, std::memory_order_relaxed );
+            }
+            reserved.store( 0, std::memory_order_relaxed );
+            published.store( 0, std::memory_order_release );
+        }
+
+        /** @brief segmento do índice i */
+        static size_t segment_of( size_t i ){
+            size_t j = i >> first_segment_log2;
+            return ( j == 0 ) ? 0 : 64 - __builtin_clzll( j );
+        }
+
+        /** @brief primeiro índice do segmento k */
+        static size_t segment_base( size_t k ){
+            return ( k == 0 ) ? 0 : first_segment << (k-1);
+        }
+
+        /** @brief quantidade de elementos do segmento k */
+        static size_t segment_size( size_t k ){
+            return ( k == 0 ) ? first_segment : first_segment << (k-1);
+        }
+
+    private:
+        typedef std::allocator_traits<Allocator> alloc_traits; //!< acesso uniforme ao alocador.
+
+        static const unsigned char slot_empty = 0;  //!< ainda não construido
+        static const unsigned char slot_ready = 1;  //!< construido e visível
+        static const unsigned char slot_failed = 2; //!< o construtor lançou, índice vazio
+
+        /*! @brief memória de um segmento e a marca de pronto de cada elemento */
+        struct segment {
+            T * data;
+            std::atomic<unsigned char> * ready;
+        };
+
+        Allocator allocator; //!< Alocador da memória dos segmentos.
+        std::atomic<segment*> segments[ max_segments ]; //!< Segmentos, alocados sob demanda.
+        std::atomic<size_t> reserved; //!< Índices já entregues a alguma thread.
+        std::atomic<size_t> published; //!< Prefixo de índices construidos (ou vazios por exceção).
+
+        /** @brief segmento k, alocando-o se ainda não existe */
+        segment * get_segment( size_t k ){
+            segment * s = segments[k].load( std::memory_order_acquire );
+            if ( s != nullptr ) return s;
+
+            size_t n = segment_size( k );
+            segment * fresh = new segment{ nullptr, nullptr };
+            try{
+                fresh->data = alloc_traits::allocate( allocator, n );
+                fresh->ready = new std::atomic<unsigned char>[ n ];
+            }catch(...){
+                if ( fresh->data != nullptr ) alloc_traits::deallocate( allocator, fresh->data, n );
+                delete fresh;
+                throw;
+            }
+            for ( size_t i = 0; i < n; ++i ) fresh->ready[i].store( slot_empty, std::memory_order_relaxed );
+
+            if ( segments[k].compare_exchange_strong( s, fresh, std::memory_order_acq_rel, std::memory_order_acquire ) ){
+                return fresh;
+            }
+            // outra thread alocou primeiro: usa o dela.
+            free_segment( fresh, n );
+            return s;
+        }
+
+        void free_segment( segment * s, size_t n ){
+            alloc_traits::deallocate( allocator, s->data, n );
+            delete[] s->ready;
+            delete s;
+        }
+
+        /**
+        * @brief reserva n índices consecutivos. Os segmentos que os cobrem são obtidos antes do CAS: se a
+        *        alocação lança, nada foi reservado, e todo índice reservado tem onde ser marcado
+        * @return primeiro índice reservado
+        */
+        size_t reserve_indices( size_t n ){
+            size_t r = reserved.load( std::memory_order_relaxed );
+            for (;;){
+                if ( n > 0 ){
+                    for ( size_t k = segment_of( r ); k <= segment_of( r+n-1 ); ++k ) get_segment( k );
+                }
+                // se o CAS falhar, r recebe o valor atual e os segmentos são conferidos de novo.
+                if ( reserved.compare_exchange_weak( r, r+n, std::memory_order_relaxed ) ) return r;
+            }
+        }
+
+        /** @brief constroi o elemento i (já reservado, com segmento) e o marca como pronto */
+        template < typename... Args >
+        void construct_at( size_t i, Args&&... args ){
+            size_t k = segment_of( i );
+            segment * s = segments[k].load( std::memory_order_acquire );
+            size_t off = i - segment_base( k );
+            alloc_traits::construct( allocator, s->data + off, std::forward<Args>(args)... );
+            s->ready[off].store( slot_ready );
+        }
+
+        /**
+        * @brief marca como vazios os índices reservados [first, last) que não serão construidos (um construtor
+        *        lançou) e publica, para que o tamanho passe deles
+        */
+        void fail_range( size_t first, size_t last ){
+            for ( size_t i = first; i < last; ++i ){
+                size_t k = segment_of( i );
+                segments[k].load( std::memory_order_acquire )->ready[ i - segment_base(k) ].store( slot_failed );
+            }
+            publish();
+        }
+
+        /**
+        * @brief avança o tamanho publicado enquanto o próximo índice estiver pronto; qualquer thread ajuda.
+        *        As marcas e o tamanho usam ordem seq_cst: quem marca um índice e depois lê 'published' não pode
+        *        perder a corrida com quem avança 'published' e depois lê a marca, senão os dois parariam
+        */
+        void publish( void ){
+            size_t p = published.load();
+            for (;;){
+                if ( p >= reserved.load() ) return;
+                size_t k = segment_of( p );
+                segment * s = segments[k].load();
+                if ( s == nullptr ) return;
+                if ( s->ready[ p - segment_base(k) ].load() == slot_empty ) return;
+                // se o CAS falhar, p recebe o valor atual e o laço continua dali.
+                if ( published.compare_exchange_weak( p, p+1 ) ) ++p;
+            }
+        }
+};
@@ -0,0 +1,597 @@
+/*! @file cow_vector.h
+    @brief vector com cópia sob demanda (copy-on-write): cow_vector<T> e retratos imutáveis cow_snapshot<T>.
+
+    Os elementos moram num bloco com contador atômico de referências, então copiar um cow_vector custa O(1):
+    as cópias dividem o bloco até que uma delas o altere.
+    - alterar um elemento existente (operator[], begin(), data(), front/back não constantes, insert, erase)
+      num bloco dividido primeiro copia os elementos para um bloco só seu
+    - push_back num bloco dividido não copia nada enquanto houver espaço e ninguém tiver acrescentado depois
+      do seu tamanho: os outros donos não enxergam posições além do próprio tamanho. O bloco guarda até onde
+      há elementos construidos, e quem chega depois na mesma posição (um CAS falha) copia
+    - snapshot() entrega uma visão só de leitura dos elementos atuais, que continua valendo enquanto o dono
+      acrescenta; pode ir para outras threads e ser copiada por elas
+    Um cow_vector, como um vector, não pode ser usado por duas threads ao mesmo tempo; objetos diferentes que
+    dividem o bloco (cópias e snapshots) podem. Para ler sem copiar use o objeto constante (cbegin, std::as_const).
+*/
+
+#ifndef ALGORITHM
+#define ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef ATOMIC
+#define ATOMIC
+#include <atomic>
+#endif
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef CSTRING
+#define CSTRING
+#include <cstring>
+#endif
+
+#ifndef MEMORY
+#define MEMORY
+#include <memory>
+#endif
+
+#ifndef STDEXCEPT
+#define STDEXCEPT
+#include <stdexcept>
+#endif
+
+#ifndef UTILITY
+#define UTILITY
+#include <utility>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+// [I] Bloco compartilhado
+
+/*! @brief cabeçalho do bloco; os elementos vêm logo depois, alinhados para T
+    @tparam T tipo de dado armazenado
+    @tparam Allocator alocador de T (o bloco é alocado pelo mesmo alocador, reassociado)
+*/
+template < typename T, typename Allocator >
+struct cow_block {
+    std::atomic<size_t> refs; //!< cow_vectors e snapshots que usam o bloco
+    std::atomic<size_t> high; //!< elementos construidos em [0, high)
+    size_t capacity; //!< elementos que cabem no bloco
+    Allocator allocator; //!< alocador que criou o bloco; destroi os elementos e devolve o bloco
+
+    static const size_t alignment = alignof(T) > alignof(std::atomic<size_t>) ? alignof(T) : alignof(std::atomic<size_t>);
+
+    /*! @brief unidade de alocação do bloco */
+    struct alignas(alignment) unit {
+        unsigned char bytes[ alignment ];
+    };
+
+    typedef std::allocator_traits<Allocator> alloc_traits;
+    typedef typename alloc_traits::template rebind_alloc<unit> unit_allocator;
+    typedef std::allocator_traits<unit_allocator> unit_traits;
+
+    /** @brief bytes do cabeçalho, arredondados para o alinhamento de T */
+    static size_t data_offset( void ){
+        return ( sizeof(cow_block) + alignof(T) - 1 ) / alignof(T) * alignof(T);
+    }
+
+    static size_t units_for( size_t cap ){
+        if ( cap > ( size_t(-1) / 2 ) / sizeof(T) ) throw std::bad_alloc();
+        return ( data_offset() + cap*sizeof(T) + alignment - 1 ) / alignment;
+    }
+
+    T * data( void ){
+        return reinterpret_cast<T*>( reinterpret_cast<unsigned char*>( this ) + data_offset() );
+    }
+
+    explicit cow_block( const Allocator& a, size_t cap ) : refs{ 1 }, high{ 0 }, capacity{ cap }, allocator( a ) { /* empty */ }
+
+    /** @brief bloco novo, vazio, com uma referência */
+    static cow_block * create( const Allocator& a, size_t cap ){
+        unit_allocator ua( a );
+        unit * u = unit_traits::allocate( ua, units_for( cap ) );
+        return ::new ( static_cast<void*>( u ) ) cow_block( a, cap );
+    }
+
+    /** @brief devolve o bloco ao alocador sem destruir elementos */
+    static void free( cow_block * b ){
+        unit_allocator ua( b->allocator );
+        size_t units = units_for( b->capacity );
+        b->~cow_block();
+        unit_traits::deallocate( ua, reinterpret_cast<unit*>( b ), units );
+    }
+
+    static void retain( cow_block * b ){
+        if ( b != nullptr ) b->refs.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    /** @brief solta uma referência; a última destroi os elementos construidos e devolve o bloco */
+    static void release( cow_block * b ){
+        if ( b == nullptr || b->refs.fetch_sub( 1, std::memory_order_acq_rel ) != 1 ) return;
+        T * p = b->data();
+        size_t n = b->high.load( std::memory_order_relaxed );
+        for ( size_t i = 0; i < n; ++i ) alloc_traits::destroy( b->allocator, p+i );
+        free( b );
+    }
+};
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Snapshot
+
+template < typename T, typename Allocator, typename GrowthPolicy > class cow_vector;
+
+/*! @brief visão imutável dos elementos que um cow_vector tinha quando snapshot() foi chamado. Mantém o bloco
+    vivo; o dono pode continuar acrescentando, e qualquer outra alteração dele vai para um bloco próprio
+*/
+template < typename T, typename Allocator = std::allocator<T> >
+class cow_snapshot {
+    public:
+        typedef T value_type;  /*!< @var tipo de dado armazenado */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos e índices */
+        typedef const T& const_reference;
+        typedef const T * const_iterator;  /*!< @var os elementos são contíguos */
+
+        /** @brief snapshot vazio */
+        cow_snapshot() : blk{ nullptr }, count{ 0 } { /* empty */ }
+
+        cow_snapshot( const cow_snapshot& s ) : blk{ s.blk }, count{ s.count } {
+            block::retain( blk );
+        }
+
+        cow_snapshot( cow_snapshot && s ) noexcept : blk{ s.blk }, count{ s.count } {
+            s.blk = nullptr;
+            s.count = 0;
+        }
+
+        cow_snapshot& operator=( cow_snapshot s ) noexcept {
+            std::swap( blk, s.blk );
+            std::swap( count, s.count );
+            return *this;
+        }
+
+        ~cow_snapshot(){
+            block::release( blk );
+        }
+
+        size_t size( void ) const{ return count; }
+        bool empty( void ) const{ return count == 0; }
+
+        const T * data( void ) const{ return ( blk == nullptr ) ? nullptr : blk->data(); }
+        const_iterator begin( void ) const{ return data(); }
+        const_iterator end( void ) const{ return data() + count; }
+
+        const T& operator[]( size_t i ) const{ return blk->data()[i]; }
+        const T& front( void ) const{ return blk->data()[0]; }
+        const T& back( void ) const{ return blk->data()[count-1]; }
+
+        /**
+        * @brief elemento i
+        * @throw std::out_of_range se i >= size()
+        */
+        const T& at( size_t i ) const{
+            if ( i >= count ) throw std::out_of_range( "cow_snapshot::at" );
+            return blk->data()[i];
+        }
+
+    private:
+        template < typename, typename, typename > friend class cow_vector;
+        typedef cow_block<T, Allocator> block;
+
+        /** @brief nova referência aos n primeiros elementos de b */
+        cow_snapshot( block * b, size_t n ) : blk{ b }, count{ n } {
+            block::retain( blk );
+        }
+
+        block * blk; //!< bloco dividido com o cow_vector
+        size_t count; //!< elementos visíveis
+};
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] cow_vector
+
+/*! @brief vector com cópias em O(1) e cópia dos elementos só na primeira alteração
+    @tparam T tipo de dado armazenado
+    @tparam Allocator alocador do bloco; cópias com alocadores diferentes não dividem o bloco
+    @tparam GrowthPolicy política de crescimento da capacidade, como no vector
+*/
+template < typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = growth_factor_2 >
+class cow_vector {
+    public:
+        typedef T value_type;  /*!< @var tipo de dado armazenado */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos e índices */
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T * iterator;  /*!< @var os elementos são contíguos */
+        typedef const T * const_iterator;
+        typedef Allocator allocator_type;
+        typedef cow_snapshot<T, Allocator> snapshot_type;  /*!< @var visão imutável devolvida por snapshot() */
+
+        // [III.1] membros especiais
+
+        /**
+        * @brief construtor vazio, sem alocar memória
+        * @param alloc alocador a ser usado
+        */
+        explicit cow_vector( const Allocator& alloc = Allocator() )
+            : allocator{ alloc },
+            blk{ nullptr },
+            size_now{ 0 }
+        { /* empty */ }
+
+        /**
+        * @brief construtor que iguala o cow_vector a uma lista, ex: {1, 2, 3}
+        */
+        cow_vector( std::initializer_list<T> l, const Allocator& alloc = Allocator() )
+            : allocator{ alloc },
+            blk{ nullptr },
+            size_now{ 0 }
+        {
+            reserve( l.size() );
+            for ( const T& x : l ) emplace_back( x );
+        }
+
+        /**
+        * @brief cópia em O(1): os dois passam a dividir o bloco (se o alocador copiado for igual ao original)
+        */
+        cow_vector( const cow_vector& source )
+            : allocator{ alloc_traits::select_on_container_copy_construction( source.allocator ) },
+            blk{ nullptr },
+            size_now{ 0 }
+        {
+            share_or_copy( source );
+        }
+
+        cow_vector( cow_vector && s ) noexcept
+            : allocator{ std::move( s.allocator ) },
+            blk{ s.blk },
+            size_now{ s.size_now }
+        {
+            s.blk = nullptr;
+            s.size_now = 0;
+        }
+
+        /**
+        * @brief passa a dividir o bloco de rhs, em O(1) se os alocadores forem iguais
+        */
+        cow_vector& operator=( const cow_vector& rhs ){
+            if ( this == &rhs ) return *this;
+            if ( alloc_traits::propagate_on_container_copy_assignment::value && allocator != rhs.allocator ){
+                // o bloco atual pertence a outro alocador, precisa ser devolvido antes da troca.
+                block::release( blk );
+                blk = nullptr;
+                size_now = 0;
+            }
+            copy_allocator( rhs.allocator, typename alloc_traits::propagate_on_container_copy_assignment() );
+            share_or_copy( rhs );
+            return *this;
+        }
+
+        cow_vector& operator=( cow_vector && s ){
+            if ( this == &s ) return *this;
+            if ( alloc_traits::propagate_on_container_move_assignment::value || allocator == s.allocator ){
+                block::release( blk );
+                move_allocator( s.allocator, typename alloc_traits::propagate_on_container_move_assignment() );
+                blk = s.blk;
+                size_now = s.size_now;
+                s.blk = nullptr;
+                s.size_now = 0;
+            }else{
+                // o bloco de 's' não pode ser devolvido pelo nosso alocador, move elemento a elemento.
+                clear();
+                reserve( s.size_now );
+                for ( size_t i = 0; i < s.size_now; ++i ) emplace_back( std::move( s.mutable_data()[i] ) );
+                s.clear();
+            }
+            return *this;
+        }
+
+        /** @brief solta o bloco; o último a soltar destroi os elementos */
+        ~cow_vector(){
+            block::release( blk );
+        }
+
+        // fim [III.1]
+
+        // [III.2] Leitura, sem cópia
+
+        size_t size( void ) const{ return size_now; }
+        bool empty( void ) const{ return size_now == 0; }
+        size_t capacity( void ) const{ return ( blk == nullptr ) ? 0 : blk->capacity; }
+        allocator_type get_allocator( void ) const{ return allocator; }
+
+        /** @brief quantos cow_vectors e snapshots dividem o bloco (0 sem bloco) */
+        size_t use_count( void ) const{
+            return ( blk == nullptr ) ? 0 : blk->refs.load( std::memory_order_acquire );
+        }
+
+        const T * data( void ) const{ return ( blk == nullptr ) ? nullptr : blk->data(); }
+        const_iterator begin( void ) const{ return data(); }
+        const_iterator end( void ) const{ return data() + size_now; }
+        const_iterator cbegin( void ) const{ return data(); }
+        const_iterator cend( void ) const{ return data() + size_now; }
+
+        const T& operator[]( size_t i ) const{ return blk->data()[i]; }
+        const T& front( void ) const{ return blk->data()[0]; }
+        const T& back( void ) const{ return blk->data()[size_now-1]; }
+
+        /**
+        * @brief elemento i
+        * @throw std::out_of_range se i >= size()
+        */
+        const T& at( size_t i ) const{
+            if ( i >= size_now ) throw std::out_of_range( "cow_vector::at" );
+            return blk->data()[i];
+        }
+
+        /**
+        * @brief visão imutável dos elementos atuais, em O(1); continua valendo enquanto este cow_vector acrescenta
+        */
+        snapshot_type snapshot( void ) const{
+            return snapshot_type( blk, size_now );
+        }
+
+        // fim [III.2]
+
+        // [III.3] Escrita: num bloco dividido, copia antes
+
+        T * data( void ){ return mutable_data(); }
+        iterator begin( void ){ return mutable_data(); }
+        iterator end( void ){ return mutable_data() + size_now; }
+
+        T& operator[]( size_t i ){ return mutable_data()[i]; }
+        T& front( void ){ return mutable_data()[0]; }
+        T& back( void ){ return mutable_data()[size_now-1]; }
+
+        T& at( size_t i ){
+            if ( i >= size_now ) throw std::out_of_range( "cow_vector::at" );
+            return mutable_data()[i];
+        }
+
+        void push_back( const T& value ){ emplace_back( value ); }
+        void push_back( T && value ){ emplace_back( std::move( value ) ); }
+
+        /**
+        * @brief constroi um elemento no fim. Num bloco dividido não copia nada se houver espaço e ninguém tiver
+        *        acrescentado depois de size(); snapshots existentes não são afetados
+        * @return referência para o novo elemento
+        */
+        template < typename... Args >
+        T& emplace_back( Args&&... args ){
+            if ( blk != nullptr && size_now < blk->capacity ){
+                T * p = blk->data() + size_now;
+                if ( owned() ){
+                    alloc_traits::construct( allocator, p, std::forward<Args>(args)... );
+                    blk->high.store( ++size_now, std::memory_order_relaxed );
+                    return *p;
+                }
+                // dividido: a posição size() é nossa se ninguém construiu nela (high == size()).
+                size_t expected = size_now;
+                if ( blk->high.compare_exchange_strong( expected, size_now+1, std::memory_order_acq_rel ) ){
+                    try{
+                        alloc_traits::construct( allocator, p, std::forward<Args>(args)... );
+                    }catch(...){
+                        blk->high.store( size_now, std::memory_order_release );
+                        throw;
+                    }
+                    ++size_now;
+                    return *p;
+                }
+            }
+            T temp( std::forward<Args>(args)... ); // os argumentos podem ser elementos do próprio cow_vector
+            reallocate( std::max( next_capacity( size_now+1 ), capacity() ) );
+            T * p = blk->data() + size_now;
+            alloc_traits::construct( allocator, p, std::move( temp ) );
+            blk->high.store( ++size_now, std::memory_order_relaxed );
+            return *p;
+        }
+
+        /** @brief remove o último elemento; num bloco dividido ele continua lá para os outros donos */
+        void pop_back( void ){
+            // owned() antes de diminuir o tamanho: depois ele mesmo destruiria o último, e o destroy abaixo
+            // seria o segundo.
+            if ( owned() ){
+                alloc_traits::destroy( allocator, blk->data() + --size_now );
+                blk->high.store( size_now, std::memory_order_relaxed );
+            }else{
+                --size_now;
+            }
+        }
+
+        /**
+        * @brief insere value antes de pos
+        * @return iterator para o elemento inserido
+        */
+        iterator insert( const_iterator pos, const T& value ){
+            size_t i = pos - cbegin();
+            T temp( value ); // value pode ser um elemento do próprio cow_vector
+            return insert_at( i, std::move( temp ) );
+        }
+
+        iterator insert( const_iterator pos, T && value ){
+            size_t i = pos - cbegin();
+            T temp( std::move( value ) );
+            return insert_at( i, std::move( temp ) );
+        }
+
+        /** @brief apaga o elemento em pos */
+        iterator erase( const_iterator pos ){
+            return erase( pos, pos+1 );
+        }
+
+        /**
+        * @brief apaga os elementos de [first, last), deslocando o final uma única vez
+        * @return iterator para o elemento que ocupou o lugar de first
+        */
+        iterator erase( const_iterator first, const_iterator last ){
+            size_t i = first - cbegin(), n = last - first;
+            T * p = mutable_data();
+            if ( n != 0 ){
+                std::move( p+i+n, p+size_now, p+i );
+                for ( size_t k = size_now-n; k < size_now; ++k ) alloc_traits::destroy( allocator, p+k );
+                size_now -= n;
+                blk->high.store( size_now, std::memory_order_relaxed );
+            }
+            return p+i;
+        }
+
+        /** @brief apaga todos os elementos; um bloco dividido é solto em vez de copiado */
+        void clear( void ){
+            if ( owned() ){
+                if ( blk == nullptr ) return;
+                T * p = blk->data();
+                for ( size_t i = 0; i < size_now; ++i ) alloc_traits::destroy( allocator, p+i );
+                blk->high.store( 0, std::memory_order_relaxed );
+            }else{
+                block::release( blk );
+                blk = nullptr;
+            }
+            size_now = 0;
+        }
+
+        /**
+        * @brief garante espaço para new_cap elementos num bloco só deste cow_vector
+        */
+        void reserve( size_t new_cap ){
+            if ( new_cap > capacity() ) reallocate( new_cap );
+        }
+
+        /** @brief troca o bloco por um de exatamente size() elementos */
+        void shrink_to_fit( void ){
+            if ( blk == nullptr || capacity() == size_now ) return;
+            if ( size_now == 0 ){
+                block::release( blk );
+                blk = nullptr;
+                return;
+            }
+            reallocate( size_now );
+        }
+
+        // fim [III.3]
+
+    private:
+        typedef std::allocator_traits<Allocator> alloc_traits; //!< acesso uniforme ao alocador.
+        typedef cow_block<T, Allocator> block;
+
+        Allocator allocator; //!< Alocador dos elementos e do bloco.
+        block * blk; //!< Bloco, possivelmente dividido, ou nullptr.
+        size_t size_now; //!< Elementos que este cow_vector enxerga em blk.
+
+        /**
+        * @brief true se ninguém mais usa o bloco (ou não há bloco). Nesse caso os elementos que outro dono tenha
+        *        deixado depois de size() são destruidos, e o bloco volta a ter exatamente size() construidos
+        */
+        bool owned( void ){
+            if ( blk == nullptr ) return true;
+            if ( blk->refs.load( std::memory_order_acquire ) != 1 ) return false;
+            size_t high = blk->high.load( std::memory_order_relaxed );
+            if ( high != size_now ){
+                for ( size_t i = size_now; i < high; ++i ) alloc_traits::destroy( allocator, blk->data() + i );
+                blk->high.store( size_now, std::memory_order_relaxed );
+            }
+            return true;
+        }
+
+        /** @brief elementos num bloco só deste cow_vector, copiando-os se o bloco é dividido */
+        T * mutable_data( void ){
+            if ( !owned() ) reallocate( capacity() );
+            return ( blk == nullptr ) ? nullptr : blk->data();
+        }
+
+        size_t next_capacity( size_t required ) const{
+            return GrowthPolicy::next_capacity( capacity(), required, sizeof(T) );
+        }
+
+        /**
+        * @brief passa os elementos para um bloco novo de new_cap elementos, só deste cow_vector: movidos se o
+        *        bloco atual é só nosso (memcpy para tipos relocáveis), copiados se é dividido
+        * @param new_cap nova capacidade, no mínimo size()
+        */
+        void reallocate( size_t new_cap ){
+            block * nb = block::create( allocator, new_cap );
+            if ( blk == nullptr ){
+                blk = nb;
+                return;
+            }
+            T * to = nb->data();
+            if ( owned() ){
+                relocate( to, nb, is_relocatable<T>() );
+            }else{
+                const T * from = blk->data();
+                size_t i = 0;
+                try{
+                    for ( ; i < size_now; ++i ) alloc_traits::construct( allocator, to+i, from[i] );
+                }catch(...){
+                    for ( size_t k = 0; k < i; ++k ) alloc_traits::destroy( allocator, to+k );
+                    block::free( nb );
+                    throw;
+                }
+            }
+            nb->high.store( size_now, std::memory_order_relaxed );
+            block::release( blk );
+            blk = nb;
+        }
+
+        void relocate( T * to, block * nb, std::true_type ){
+            if ( size_now == 0 ) return;
+            std::memcpy( static_cast<void*>( to ), static_cast<const void*>( blk->data() ), size_now*sizeof(T) );
+            blk->high.store( 0, std::memory_order_relaxed ); // os bits foram levados, nada a destruir no bloco antigo
+            (void) nb;
+        }
+
+        void relocate( T * to, block * nb, std::false_type ){
+            if ( size_now == 0 ) return;
+            T * from = blk->data();
+            size_t i = 0;
+            try{
+                for ( ; i < size_now; ++i ) alloc_traits::construct( allocator, to+i, std::move_if_noexcept( from[i] ) );
+            }catch(...){
+                for ( size_t k = 0; k < i; ++k ) alloc_traits::destroy( allocator, to+k );
+                block::free( nb );
+                throw;
+            }
+        }
+
+        template < typename U >
+        iterator insert_at( size_t i, U && value ){
+            emplace_back( std::forward<U>( value ) );
+            T * p = mutable_data();
+            std::rotate( p+i, p+size_now-1, p+size_now );
+            return p+i;
+        }
+
+        /** @brief divide o bloco de source, ou copia seus elementos se os alocadores diferem */
+        void share_or_copy( const cow_vector& source ){
+            if ( allocator == source.allocator ){
+                block::retain( source.blk );
+                block::release( blk );
+                blk = source.blk;
+                size_now = source.size_now;
+                return;
+            }
+            clear();
+            reserve( source.size_now );
+            for ( size_t i = 0; i < source.size_now; ++i ) emplace_back( source[i] );
+        }
+
+        void copy_allocator( const Allocator& a, std::true_type ){ allocator = a; }
+        void copy_allocator( const Allocator&, std::false_type ){ /* empty */ }
+
+        void move_allocator( Allocator& a, std::true_type ){ allocator = std::move(a); }
+        void move_allocator( Allocator&, std::false_type ){ /* empty */ }
+};
+
+// fim [III]
@@ -0,0 +1,576 @@
+/*! @file flat_map.h
+    @brief conjunto e mapa ordenados sobre o vector: flat_set<Key> e flat_map<Key, T>.
+
+    Os elementos ficam ordenados num único vector, sem nós: a busca binária percorre memória contígua e cada
+    elemento ocupa só o seu tamanho. Feitos para dados muito lidos e pouco alterados:
+    - insert(first, last) acrescenta tudo no fim, ordena só o trecho novo e faz um único merge, em vez de n
+      inserções que deslocam o vector cada uma
+    - insert/erase de um elemento custam O(n), como num vector ordenado
+    - a busca é escolhida pelo parâmetro Lookup: branchless_search (padrão) faz a busca binária sem desvios no
+      próprio vector; eytzinger_search mantém também uma cópia das chaves na ordem de Eytzinger (a árvore
+      binária em largura), em que os próximos níveis da busca ficam em linhas de cache vizinhas e podem ser
+      trazidos antes (prefetch)
+*/
+
+#ifndef ALGORITHM
+#define ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef FUNCTIONAL
+#define FUNCTIONAL
+#include <functional>
+#endif
+
+#ifndef ITERATOR
+#define ITERATOR
+#include <iterator>
+#endif
+
+#ifndef STDEXCEPT
+#define STDEXCEPT
+#include <stdexcept>
+#endif
+
+#ifndef TYPE_TRAITS
+#define TYPE_TRAITS
+#include <type_traits>
+#endif
+
+#ifndef UTILITY
+#define UTILITY
+#include <utility>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+// [I] Políticas de busca
+
+/*! @brief busca binária sem desvios no próprio vector: o laço tem sempre log2(n) passos e a escolha da metade
+    vira um cmov, então não há erros de previsão de desvio. Não usa memória extra.
+*/
+struct branchless_search {
+    template < typename Key >
+    class index {
+        public:
+            /** @brief nada a guardar: a busca usa o vector ordenado */
+            template < typename Value, typename KeyOf >
+            void rebuild( const Value *, size_t, KeyOf ){ /* empty */ }
+
+            void invalidate( void ){ /* empty */ }
+
+            /**
+            * @brief quantidade de elementos do começo para os quais before( chave ) é true
+            * @param data elementos ordenados
+            * @param n quantidade de elementos
+            * @param key_of extrai a chave de um elemento
+            * @param before predicado monótono: true numa parte inicial do vector e false no resto
+            */
+            template < typename Value, typename KeyOf, typename Before >
+            size_t partition_point( const Value * data, size_t n, KeyOf key_of, Before before ) const{
+                return branchless_search::partition_point( data, n, key_of, before );
+            }
+    };
+
+    template < typename Value, typename KeyOf, typename Before >
+    static size_t partition_point( const Value * data, size_t n, KeyOf key_of, Before before ){
+        if ( n == 0 ) return 0;
+        const Value * base = data;
+        while ( n > 1 ){
+            size_t half = n / 2;
+            base = before( key_of( base[half] ) ) ? base + half : base;
+            n -= half;
+        }
+        return (size_t) ( base - data ) + ( before( key_of( *base ) ) ? 1 : 0 );
+    }
+};
+
+/*! @brief busca numa cópia das chaves na ordem de Eytzinger: o nó k tem filhos 2k e 2k+1, então os 4 níveis
+    seguintes de um nó ficam numa faixa contígua e são pedidos ao cache antes de serem necessários.
+    Custa uma cópia das chaves; a posição no vector ordenado sai de uma conta com o número do nó. O índice é refeito pelo insert(first, last), pelos
+    construtores de intervalo e por build_index(); inserts e erases de um elemento só o marcam como velho, e
+    até o próximo build_index() as buscas usam branchless_search.
+*/
+struct eytzinger_search {
+    template < typename Key >
+    class index {
+        public:
+            index() : fresh{ false } { /* empty */ }
+
+            /** @brief refaz a cópia das chaves a partir dos n elementos ordenados */
+            template < typename Value, typename KeyOf >
+            void rebuild( const Value * data, size_t n, KeyOf key_of ){
+                keys.clear();
+                keys.reserve( n );
+                for ( size_t k = 1; k <= n; ++k ) keys.push_back( key_of( data[ rank( k, n ) ] ) );
+                fresh = true;
+            }
+
+            void invalidate( void ){
+                fresh = false;
+            }
+
+            template < typename Value, typename KeyOf, typename Before >
+            size_t partition_point( const Value * data, size_t n, KeyOf key_of, Before before ) const{
+                if ( !fresh ) return branchless_search::partition_point( data, n, key_of, before );
+                const Key * tree = keys.data(); // o nó k está em tree[k-1]
+                size_t k = 1;
+                while ( k <= n ){
+                    // 4 níveis abaixo: os 16 descendentes de k começam em 16k.
+                    if ( k*prefetch_stride <= n ) __builtin_prefetch( tree + k*prefetch_stride - 1 );
+                    k = 2*k + ( before( tree[k-1] ) ? 1 : 0 );
+                }
+                // sobe enquanto veio da direita: o nó onde a busca virou à esquerda pela última vez é a resposta.
+                k >>= __builtin_ffsll( (long long) ~k );
+                return ( k == 0 ) ? n : rank( k, n );
+            }
+
+        private:
+            static const size_t prefetch_stride = 16;
+
+            ::vector<Key> keys; //!< chaves na ordem de Eytzinger: o nó k em keys[k-1]
+            bool fresh; //!< false depois de uma alteração que não refez a cópia
+
+            /**
+            * @brief posição no vector ordenado do nó k de uma árvore de n nós, sem tabela: numa árvore cheia de h
+            *        níveis o nó k no nível d tem posição (2(k - 2^d) + 1) 2^(h-d-1) - 1; do último nível, que pode
+            *        estar incompleto, faltam os nós finais, que ocupariam as posições pares depois dos m presentes
+            */
+            static size_t rank( size_t k, size_t n ){
+                size_t h = 64 - __builtin_clzll( n );
+                size_t d = 63 - __builtin_clzll( k );
+                size_t full = ( ( 2*( k - ( size_t(1) << d ) ) + 1 ) << ( h-d-1 ) ) - 1;
+                size_t m = n - ( ( size_t(1) << (h-1) ) - 1 );
+                size_t bottom_left = ( full+1 )/2; // posições do último nível antes de full
+                return full - ( bottom_left > m ? bottom_left - m : 0 );
+            }
+    };
+};
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Base comum
+
+/*! @brief vector ordenado e sem chaves repetidas; flat_set e flat_map só dizem como extrair a chave
+    @tparam Key tipo da chave
+    @tparam Value tipo do elemento guardado
+    @tparam KeyOf objeto que extrai a chave de um elemento
+    @tparam Compare ordem estrita das chaves
+    @tparam Lookup política de busca (branchless_search ou eytzinger_search)
+    @tparam Allocator alocador do vector
+    @tparam GrowthPolicy política de crescimento do vector
+*/
+template < typename Key, typename Value, typename KeyOf, typename Compare, typename Lookup,
+           typename Allocator, typename GrowthPolicy >
+class flat_tree {
+    public:
+        typedef Key key_type;  /*!< @var tipo da chave */
+        typedef Value value_type;  /*!< @var tipo do elemento */
+        typedef Compare key_compare;  /*!< @var ordem das chaves */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos */
+        typedef ::vector<Value, Allocator, GrowthPolicy> container_type;  /*!< @var vector ordenado */
+        typedef typename container_type::iterator iterator;
+        typedef typename container_type::const_iterator const_iterator;
+        typedef typename container_type::reverse_iterator reverse_iterator;
+        typedef typename container_type::const_reverse_iterator const_reverse_iterator;
+
+        // [II.1] membros especiais
+
+        /**
+        * @brief construtor vazio
+        * @param comp ordem das chaves
+        * @param alloc alocador do vector
+        */
+        explicit flat_tree( const Compare& comp = Compare(), const Allocator& alloc = Allocator() )
+            : elements( alloc ),
+            comp{ comp }
+        { /* empty */ }
+
+        /**
+        * @brief construtor com os elementos de [first, last), em qualquer ordem; de chaves repetidas fica a primeira
+        */
+        template < typename InputIterator >
+        flat_tree( InputIterator first, InputIterator last, const Compare& comp = Compare(), const Allocator& alloc = Allocator() )
+            : elements( alloc ),
+            comp{ comp }
+        {
+            insert( first, last );
+        }
+
+        /**
+        * @brief construtor a partir de uma lista, ex: {3, 1, 2}
+        */
+        flat_tree( std::initializer_list<Value> l, const Compare& comp = Compare(), const Allocator& alloc = Allocator() )
+            : elements( alloc ),
+            comp{ comp }
+        {
+            insert( l.begin(), l.end() );
+        }
+
+        // fim [II.1]
+
+        // [II.2] Iterators e capacidade
+
+        iterator begin( void ){ return elements.begin(); }
+        iterator end( void ){ return elements.end(); }
+        const_iterator begin( void ) const{ return elements.begin(); }
+        const_iterator end( void ) const{ return elements.end(); }
+        const_iterator cbegin( void ) const{ return elements.cbegin(); }
+        const_iterator cend( void ) const{ return elements.cend(); }
+        reverse_iterator rbegin( void ){ return elements.rbegin(); }
+        reverse_iterator rend( void ){ return elements.rend(); }
+        const_reverse_iterator rbegin( void ) const{ return elements.rbegin(); }
+        const_reverse_iterator rend( void ) const{ return elements.rend(); }
+
+        size_t size( void ) const{ return elements.size(); }
+        bool empty( void ) const{ return elements.empty(); }
+        size_t capacity( void ) const{ return elements.capacity(); }
+        void reserve( size_t n ){ elements.reserve( n ); }
+        void shrink_to_fit( void ){ elements.shrink_to_fit(); }
+
+        /** @brief vector ordenado com os elementos, só para leitura */
+        const container_type& sequence( void ) const{ return elements; }
+
+        key_compare key_comp( void ) const{ return comp; }
+
+        // fim [II.2]
+
+        // [II.3] Modifiers
+
+        void clear( void ){
+            elements.clear();
+            lookup.invalidate();
+        }
+
+        /**
+        * @brief insere value se a chave ainda não existe, em O(n)
+        * @return iterator para o elemento com a chave e true se value foi inserido
+        */
+        std::pair<iterator, bool> insert( const value_type& value ){
+            return insert_unique( value );
+        }
+
+        std::pair<iterator, bool> insert( value_type && value ){
+            return insert_unique( std::move( value ) );
+        }
+
+        /**
+        * @brief insere value usando hint como palpite: se value cabe logo antes de hint, não há busca
+        * @return iterator para o elemento com a chave
+        */
+        iterator insert( const_iterator hint, const value_type& value ){
+            return insert_hint( hint, value );
+        }
+
+        iterator insert( const_iterator hint, value_type && value ){
+            return insert_hint( hint, std::move( value ) );
+        }
+
+        /**
+        * @brief insere de uma vez os elementos de [first, last), em qualquer ordem: acrescenta no fim, ordena
+        *        só o trecho novo e faz um merge com o que já havia. De chaves repetidas fica a mais antiga
+        */
+        template < typename InputIterator >
+        void insert( InputIterator first, InputIterator last ){
+            size_t old = elements.size();
+            typedef typename std::iterator_traits<InputIterator>::iterator_category category;
+            if constexpr ( std::is_base_of<std::forward_iterator_tag, category>::value ){
+                elements.insert( elements.end(), first, last );
+            }else{
+                for ( ; first != last; ++first ) elements.push_back( *first );
+            }
+            merge_tail( old );
+        }
+
+        void insert( std::initializer_list<Value> l ){
+            insert( l.begin(), l.end() );
+        }
+
+        /**
+        * @brief constroi um elemento com args e o insere se a chave ainda não existe
+        */
+        template < typename... Args >
+        std::pair<iterator, bool> emplace( Args&&... args ){
+            return insert_unique( value_type( std::forward<Args>(args)... ) );
+        }
+
+        /** @brief apaga o elemento em pos */
+        iterator erase( iterator pos ){
+            lookup.invalidate();
+            return elements.erase( pos );
+        }
+
+        iterator erase( const_iterator pos ){
+            lookup.invalidate();
+            return elements.erase( mutable_at( pos ) );
+        }
+
+        iterator erase( const_iterator first, const_iterator last ){
+            lookup.invalidate();
+            return elements.erase( mutable_at( first ), mutable_at( last ) );
+        }
+
+        /**
+        * @brief apaga o elemento com a chave k, se existir
+        * @return quantidade de elementos apagados (0 ou 1)
+        */
+        template < typename K >
+        size_t erase( const K& k ){
+            iterator it = find( k );
+            if ( it == end() ) return 0;
+            erase( it );
+            return 1;
+        }
+
+        /**
+        * @brief refaz o índice de busca (eytzinger_search) depois de inserts ou erases de um elemento
+        */
+        void build_index( void ){
+            lookup.rebuild( elements.data(), elements.size(), KeyOf() );
+        }
+
+        // fim [II.3]
+
+        // [II.4] Busca
+        //  As buscas aceitam qualquer tipo K: com um Compare transparente (ex: std::less<>) ele é comparado
+        //  direto com as chaves; se não, é convertido uma vez para key_type.
+
+        /** @brief primeiro elemento com chave não menor que k */
+        template < typename K >
+        iterator lower_bound( const K& k ){ return begin() + lower_index( k ); }
+
+        template < typename K >
+        const_iterator lower_bound( const K& k ) const{ return begin() + lower_index( k ); }
+
+        /** @brief primeiro elemento com chave maior que k */
+        template < typename K >
+        iterator upper_bound( const K& k ){ return begin() + upper_index( k ); }
+
+        template < typename K >
+        const_iterator upper_bound( const K& k ) const{ return begin() + upper_index( k ); }
+
+        /** @brief elemento com a chave k, ou end() */
+        template < typename K >
+        iterator find( const K& k ){ return begin() + find_index( k ); }
+
+        template < typename K >
+        const_iterator find( const K& k ) const{ return begin() + find_index( k ); }
+
+        template < typename K >
+        bool contains( const K& k ) const{ return find_index( k ) != size(); }
+
+        template < typename K >
+        size_t count( const K& k ) const{ return contains( k ) ? 1 : 0; }
+
+        template < typename K >
+        std::pair<iterator, iterator> equal_range( const K& k ){
+            size_t i = lower_index( k );
+            size_t j = ( i != size() && !comp( lookup_key<K>( k ), KeyOf()( elements[i] ) ) ) ? i+1 : i;
+            return std::pair<iterator, iterator>( begin() + i, begin() + j );
+        }
+
+        template < typename K >
+        std::pair<const_iterator, const_iterator> equal_range( const K& k ) const{
+            size_t i = lower_index( k );
+            size_t j = ( i != size() && !comp( lookup_key<K>( k ), KeyOf()( elements[i] ) ) ) ? i+1 : i;
+            return std::pair<const_iterator, const_iterator>( begin() + i, begin() + j );
+        }
+
+        // fim [II.4]
+
+        friend bool operator==( const flat_tree& a, const flat_tree& b ){
+            return a.size() == b.size() && std::equal( a.begin(), a.end(), b.begin() );
+        }
+
+        friend bool operator!=( const flat_tree& a, const flat_tree& b ){
+            return !( a == b );
+        }
+
+    protected:
+        /*! @brief com Compare transparente a chave buscada é usada como veio; se não, vira um key_type */
+        template < typename C, typename = void >
+        struct transparent : std::false_type {};
+
+        template < typename C >
+        struct transparent< C, std::void_t<typename C::is_transparent> > : std::true_type {};
+
+        template < typename K >
+        using lookup_key = typename std::conditional< transparent<Compare>::value, K, Key >::type;
+
+        container_type elements; //!< elementos ordenados pela chave, sem repetição
+        Compare comp; //!< ordem das chaves
+        typename Lookup::template index<Key> lookup; //!< estrutura auxiliar da busca
+
+        /** @brief posição do primeiro elemento com chave não menor que k */
+        template < typename K >
+        size_t lower_index( const K& key ) const{
+            const lookup_key<K>& k = key;
+            return lookup.partition_point( elements.data(), elements.size(), KeyOf(),
+                                           [&]( const Key& x ){ return comp( x, k ); } );
+        }
+
+        template < typename K >
+        size_t upper_index( const K& key ) const{
+            const lookup_key<K>& k = key;
+            return lookup.partition_point( elements.data(), elements.size(), KeyOf(),
+                                           [&]( const Key& x ){ return !comp( k, x ); } );
+        }
+
+        /** @brief posição do elemento com chave k, ou size() */
+        template < typename K >
+        size_t find_index( const K& key ) const{
+            const lookup_key<K>& k = key;
+            size_t i = lower_index( k );
+            return ( i != size() && !comp( k, KeyOf()( elements[i] ) ) ) ? i : size();
+        }
+
+        iterator mutable_at( const_iterator pos ){
+            return elements.begin() + ( pos - elements.cbegin() );
+        }
+
+        template < typename V >
+        std::pair<iterator, bool> insert_unique( V && value ){
+            size_t i = lower_index( KeyOf()( value ) );
+            if ( i != size() && !comp( KeyOf()( value ), KeyOf()( elements[i] ) ) ) return std::pair<iterator, bool>( begin() + i, false );
+            lookup.invalidate();
+            return std::pair<iterator, bool>( elements.insert( begin() + i, std::forward<V>( value ) ), true );
+        }
+
+        template < typename V >
+        iterator insert_hint( const_iterator hint, V && value ){
+            const Key& k = KeyOf()( value );
+            size_t i = hint - cbegin();
+            // o palpite serve se a chave fica entre o anterior e hint.
+            if ( ( i == size() || comp( k, KeyOf()( elements[i] ) ) ) && ( i == 0 || comp( KeyOf()( elements[i-1] ), k ) ) ){
+                lookup.invalidate();
+                return elements.insert( begin() + i, std::forward<V>( value ) );
+            }
+            return insert_unique( std::forward<V>( value ) ).first;
+        }
+
+        /**
+        * @brief ordena os elementos de [old, size()), junta com os de [0, old) e tira as chaves repetidas;
+        *        sort e merge estáveis mantêm a mais antiga de cada chave na frente
+        */
+        void merge_tail( size_t old ){
+            auto less = [&]( const Value& a, const Value& b ){ return comp( KeyOf()( a ), KeyOf()( b ) ); };
+            iterator mid = begin() + old;
+            std::stable_sort( mid, end(), less );
+            // se o trecho novo começa depois do último antigo (acréscimo em ordem), não há o que juntar.
+            if ( old != 0 && mid != end() && less( *mid, *(mid-1) ) ) std::inplace_merge( begin(), mid, end(), less );
+            iterator last = std::unique( begin(), end(), [&]( const Value& a, const Value& b ){ return !less( a, b ); } );
+            elements.erase( last, end() );
+            build_index();
+        }
+};
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] flat_set e flat_map
+
+/*! @brief chave de um flat_set: o próprio elemento */
+struct flat_identity {
+    template < typename T >
+    const T& operator()( const T& x ) const{ return x; }
+};
+
+/*! @brief chave de um flat_map: o primeiro campo do par */
+struct flat_first {
+    template < typename P >
+    const typename P::first_type& operator()( const P& p ) const{ return p.first; }
+};
+
+/*! @brief conjunto ordenado de chaves num vector
+    @tparam Key tipo da chave
+    @tparam Compare ordem estrita das chaves
+    @tparam Lookup branchless_search ou eytzinger_search
+*/
+template < typename Key, typename Compare = std::less<Key>, typename Lookup = branchless_search,
+           typename Allocator = std::allocator<Key>, typename GrowthPolicy = growth_factor_2 >
+class flat_set : public flat_tree< Key, Key, flat_identity, Compare, Lookup, Allocator, GrowthPolicy > {
+        typedef flat_tree< Key, Key, flat_identity, Compare, Lookup, Allocator, GrowthPolicy > base;
+
+    public:
+        using base::base;
+};
+
+/*! @brief mapa ordenado de Key para T num vector de std::pair<Key, T>; as chaves não devem ser alteradas
+    pelos iterators, o que quebraria a ordem
+    @tparam Key tipo da chave
+    @tparam T tipo do valor
+    @tparam Compare ordem estrita das chaves
+    @tparam Lookup branchless_search ou eytzinger_search
+*/
+template < typename Key, typename T, typename Compare = std::less<Key>, typename Lookup = branchless_search,
+           typename Allocator = std::allocator< std::pair<Key, T> >, typename GrowthPolicy = growth_factor_2 >
+class flat_map : public flat_tree< Key, std::pair<Key, T>, flat_first, Compare, Lookup, Allocator, GrowthPolicy > {
+        typedef flat_tree< Key, std::pair<Key, T>, flat_first, Compare, Lookup, Allocator, GrowthPolicy > base;
+
+    public:
+        typedef T mapped_type;  /*!< @var tipo do valor */
+        typedef typename base::iterator iterator;
+
+        using base::base;
+
+        /**
+        * @brief valor da chave k, inserindo T() se ela não existe
+        */
+        T& operator[]( const Key& k ){
+            return try_emplace( k ).first->second;
+        }
+
+        T& operator[]( Key && k ){
+            return try_emplace( std::move( k ) ).first->second;
+        }
+
+        /**
+        * @brief valor da chave k
+        * @throw std::out_of_range se a chave não existe
+        */
+        T& at( const Key& k ){
+            iterator it = this->find( k );
+            if ( it == this->end() ) throw std::out_of_range( "flat_map::at" );
+            return it->second;
+        }
+
+        const T& at( const Key& k ) const{
+            auto it = this->find( k );
+            if ( it == this->end() ) throw std::out_of_range( "flat_map::at" );
+            return it->second;
+        }
+
+        /**
+        * @brief insere (k, T(args...)) se a chave não existe; se existe, nada é construido
+        * @return iterator para o elemento com a chave e true se ele foi inserido
+        */
+        template < typename K, typename... Args >
+        std::pair<iterator, bool> try_emplace( K && k, Args&&... args ){
+            size_t i = this->lower_index( k );
+            if ( i != this->size() && !this->comp( k, this->elements[i].first ) ) return std::pair<iterator, bool>( this->begin() + i, false );
+            this->lookup.invalidate();
+            iterator it = this->elements.emplace( this->begin() + i, std::piecewise_construct,
+                                                  std::forward_as_tuple( std::forward<K>(k) ),
+                                                  std::forward_as_tuple( std::forward<Args>(args)... ) );
+            return std::pair<iterator, bool>( it, true );
+        }
+
+        /**
+        * @brief insere (k, obj), ou troca o valor por obj se a chave já existe
+        * @return iterator para o elemento com a chave e true se ele foi inserido
+        */
+        template < typename K, typename M >
+        std::pair<iterator, bool> insert_or_assign( K && k, M && obj ){
+            std::pair<iterator, bool> r = try_emplace( std::forward<K>(k), std::forward<M>(obj) );
+            if ( !r.second ) r.first->second = std::forward<M>(obj);
+            return r;
+        }
+};
+
+// fim [III]
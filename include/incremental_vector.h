@@ -0,0 +1,471 @@
+/*! @file incremental_vector.h
+    @brief vector com realocação incremental: incremental_vector<T>, push_back com latência limitada.
+
+    No vector, o push_back que encontra o bloco cheio move todos os elementos de uma vez, e num vector de
+    centenas de milhões de elementos essa única chamada leva centenas de milissegundos. Aqui o crescimento só
+    aloca o bloco novo; os elementos antigos passam para ele aos poucos, alguns a cada push_back seguinte:
+    - durante a migração, [0, moved) e [old_size, size) já estão no bloco novo e [moved, old_size) ainda no
+      antigo; operator[] escolhe o bloco com uma comparação, então leitura e iteração seguem corretas
+    - cada push_back migra step elementos, o bastante para a migração acabar antes de o bloco novo encher
+      (com growth_factor_2, 2 por push_back): nenhum push_back move mais que step + 1 elementos
+    - data() termina a migração antes de devolver o bloco; finish() faz o mesmo sob demanda
+    Com malloc, blocos grandes voltam por munmap, que custa ~50us por MB já tocado; para que o push_back que
+    esvazia um bloco antigo de centenas de MB não pague isso de uma vez, as páginas já migradas de blocos a
+    partir de 1MB são devolvidas ao sistema durante a migração, 256KB por vez, com madvise(MADV_DONTNEED).
+*/
+
+#ifndef ALGORITHM
+#define ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef CSTDINT
+#define CSTDINT
+#include <cstdint>
+#endif
+
+#ifndef CSTRING
+#define CSTRING
+#include <cstring>
+#endif
+
+#ifndef INITIALIZER_LIST
+#define INITIALIZER_LIST
+#include <initializer_list>
+#endif
+
+#ifndef ITERATOR
+#define ITERATOR
+#include <iterator>
+#endif
+
+#ifndef MEMORY
+#define MEMORY
+#include <memory>
+#endif
+
+#ifndef STDEXCEPT
+#define STDEXCEPT
+#include <stdexcept>
+#endif
+
+#ifndef SYS_MMAN_H
+#define SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#ifndef UTILITY
+#define UTILITY
+#include <utility>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+// [I] incremental_vector
+
+/*! @brief vector cujo crescimento migra os elementos aos poucos
+    @tparam T tipo de dado armazenado
+    @tparam Allocator alocador de T
+    @tparam GrowthPolicy política de crescimento, como em vector
+*/
+template < typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = growth_factor_2 >
+class incremental_vector {
+    public:
+        typedef T value_type;  /*!< @var tipo de dado armazenado */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos e índices */
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef Allocator allocator_type;
+
+        /*! @brief iterator por índice: durante a migração os elementos estão em dois blocos */
+        template < bool Const >
+        class basic_iterator {
+            public:
+                typedef std::random_access_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef typename std::conditional<Const, const T&, T&>::type reference;
+                typedef typename std::conditional<Const, const T*, T*>::type pointer;
+                typedef typename std::conditional<Const, const incremental_vector*, incremental_vector*>::type owner_pointer;
+
+                basic_iterator() : owner{ nullptr }, index{ 0 } { /* empty */ }
+                basic_iterator( owner_pointer o, size_t i ) : owner{ o }, index{ i } { /* empty */ }
+
+                /** @brief iterator comum vira constante */
+                template < bool C = Const, typename = typename std::enable_if<C>::type >
+                basic_iterator( const basic_iterator<false>& m ) : owner{ m.owner }, index{ m.index } { /* empty */ }
+
+                reference operator*( ) const{ return (*owner)[index]; }
+                pointer operator->( ) const{ return &(*owner)[index]; }
+                reference operator[]( difference_type d ) const{ return (*owner)[index+d]; }
+
+                basic_iterator& operator++( ){ ++index; return *this; }
+                basic_iterator operator++( int ){ basic_iterator t( *this ); ++index; return t; }
+                basic_iterator& operator--( ){ --index; return *this; }
+                basic_iterator operator--( int ){ basic_iterator t( *this ); --index; return t; }
+                basic_iterator& operator+=( difference_type d ){ index += d; return *this; }
+                basic_iterator& operator-=( difference_type d ){ index -= d; return *this; }
+
+                friend basic_iterator operator+( basic_iterator m, difference_type d ){ return m += d; }
+                friend basic_iterator operator+( difference_type d, basic_iterator m ){ return m += d; }
+                friend basic_iterator operator-( basic_iterator m, difference_type d ){ return m -= d; }
+                friend difference_type operator-( basic_iterator a, basic_iterator b ){
+                    return (difference_type) a.index - (difference_type) b.index;
+                }
+
+                friend bool operator==( basic_iterator a, basic_iterator b ){ return a.index == b.index; }
+                friend bool operator!=( basic_iterator a, basic_iterator b ){ return a.index != b.index; }
+                friend bool operator<( basic_iterator a, basic_iterator b ){ return a.index < b.index; }
+                friend bool operator>( basic_iterator a, basic_iterator b ){ return a.index > b.index; }
+                friend bool operator<=( basic_iterator a, basic_iterator b ){ return a.index <= b.index; }
+                friend bool operator>=( basic_iterator a, basic_iterator b ){ return a.index >= b.index; }
+
+            private:
+                friend class basic_iterator<!Const>;
+
+                owner_pointer owner; //!< vector percorrido
+                size_t index; //!< posição do elemento
+        };
+
+        typedef basic_iterator<false> iterator;  /*!< @var nome padrão do iterator */
+        typedef basic_iterator<true> const_iterator;  /*!< @var nome padrão do iterator constante */
+
+        // [I.1] membros especiais
+
+        /**
+        * @brief construtor vazio, sem alocar memória
+        * @param alloc alocador a ser usado
+        */
+        explicit incremental_vector( const Allocator& alloc = Allocator() )
+            : allocator{ alloc },
+            fresh{ nullptr },
+            capacity_now{ 0 },
+            size_now{ 0 },
+            old{ nullptr },
+            old_capacity{ 0 },
+            old_size{ 0 },
+            moved{ 0 },
+            released{ 0 },
+            step{ 0 }
+        { /* empty */ }
+
+        /**
+        * @brief construtor que iguala o incremental_vector a uma lista, ex: {1, 2, 3}
+        */
+        incremental_vector( std::initializer_list<T> l, const Allocator& alloc = Allocator() )
+            : incremental_vector( alloc )
+        {
+            reserve( l.size() );
+            for ( const T& x : l ) emplace_back( x );
+        }
+
+        /** @brief cópia num único bloco, sem migração pendente */
+        incremental_vector( const incremental_vector& source )
+            : incremental_vector( alloc_traits::select_on_container_copy_construction( source.allocator ) )
+        {
+            reserve( source.size_now );
+            for ( size_t i = 0; i < source.size_now; ++i ) emplace_back( source[i] );
+        }
+
+        incremental_vector( incremental_vector && s ) noexcept
+            : allocator{ std::move( s.allocator ) },
+            fresh{ s.fresh },
+            capacity_now{ s.capacity_now },
+            size_now{ s.size_now },
+            old{ s.old },
+            old_capacity{ s.old_capacity },
+            old_size{ s.old_size },
+            moved{ s.moved },
+            released{ s.released },
+            step{ s.step }
+        {
+            s.forget();
+        }
+
+        incremental_vector& operator=( const incremental_vector& rhs ){
+            if ( this == &rhs ) return *this;
+            if ( alloc_traits::propagate_on_container_copy_assignment::value && allocator != rhs.allocator ){
+                // os blocos atuais pertencem a outro alocador, precisam ser devolvidos antes da troca.
+                release();
+            }
+            copy_allocator( rhs.allocator, typename alloc_traits::propagate_on_container_copy_assignment() );
+            clear();
+            reserve( rhs.size_now );
+            for ( size_t i = 0; i < rhs.size_now; ++i ) emplace_back( rhs[i] );
+            return *this;
+        }
+
+        incremental_vector& operator=( incremental_vector && s ){
+            if ( this == &s ) return *this;
+            if ( alloc_traits::propagate_on_container_move_assignment::value || allocator == s.allocator ){
+                release();
+                move_allocator( s.allocator, typename alloc_traits::propagate_on_container_move_assignment() );
+                fresh = s.fresh;
+                capacity_now = s.capacity_now;
+                size_now = s.size_now;
+                old = s.old;
+                old_capacity = s.old_capacity;
+                old_size = s.old_size;
+                moved = s.moved;
+                released = s.released;
+                step = s.step;
+                s.forget();
+            }else{
+                // os blocos de 's' não podem ser devolvidos pelo nosso alocador, move elemento a elemento.
+                clear();
+                reserve( s.size_now );
+                for ( size_t i = 0; i < s.size_now; ++i ) emplace_back( std::move( s[i] ) );
+                s.clear();
+            }
+            return *this;
+        }
+
+        ~incremental_vector(){
+            release();
+        }
+
+        // fim [I.1]
+
+        // [I.2] Leitura
+
+        size_t size( void ) const{ return size_now; }
+        bool empty( void ) const{ return size_now == 0; }
+        size_t capacity( void ) const{ return capacity_now; }
+        allocator_type get_allocator( void ) const{ return allocator; }
+
+        /** @brief true enquanto há elementos no bloco antigo */
+        bool migrating( void ) const{ return old != nullptr; }
+
+        iterator begin( void ){ return iterator( this, 0 ); }
+        iterator end( void ){ return iterator( this, size_now ); }
+        const_iterator begin( void ) const{ return const_iterator( this, 0 ); }
+        const_iterator end( void ) const{ return const_iterator( this, size_now ); }
+        const_iterator cbegin( void ) const{ return begin(); }
+        const_iterator cend( void ) const{ return end(); }
+
+        /** @brief elemento i, no bloco novo ou, se ainda não migrou, no antigo */
+        T& operator[]( size_t i ){ return *slot( i ); }
+        const T& operator[]( size_t i ) const{ return *slot( i ); }
+
+        /**
+        * @brief elemento i
+        * @throw std::out_of_range se i >= size()
+        */
+        T& at( size_t i ){
+            if ( i >= size_now ) throw std::out_of_range( "incremental_vector::at" );
+            return *slot( i );
+        }
+
+        const T& at( size_t i ) const{
+            if ( i >= size_now ) throw std::out_of_range( "incremental_vector::at" );
+            return *slot( i );
+        }
+
+        T& front( void ){ return *slot( 0 ); }
+        const T& front( void ) const{ return *slot( 0 ); }
+        T& back( void ){ return *slot( size_now-1 ); }
+        const T& back( void ) const{ return *slot( size_now-1 ); }
+
+        /** @brief elementos contíguos: termina antes a migração pendente, de uma vez */
+        T * data( void ){
+            finish();
+            return fresh;
+        }
+
+        // fim [I.2]
+
+        // [I.3] Escrita
+
+        void push_back( const T& value ){ emplace_back( value ); }
+        void push_back( T && value ){ emplace_back( std::move( value ) ); }
+
+        /**
+        * @brief constroi um elemento no fim e migra até step elementos do bloco antigo. Com o bloco cheio, só
+        *        aloca o bloco novo: o antigo continua valendo, inclusive para args que apontem para ele
+        */
+        template < typename... Args >
+        T& emplace_back( Args&&... args ){
+            if ( size_now == capacity_now ) grow();
+            T * p = fresh + size_now;
+            alloc_traits::construct( allocator, p, std::forward<Args>( args )... );
+            ++size_now;
+            if ( old != nullptr ){
+                try{
+                    migrate( step );
+                }catch(...){
+                    // cópia de migração falhou: desfaz o acréscimo, nada mais mudou.
+                    alloc_traits::destroy( allocator, p );
+                    --size_now;
+                    throw;
+                }
+            }
+            return *p;
+        }
+
+        void pop_back( void ){
+            --size_now;
+            alloc_traits::destroy( allocator, slot( size_now ) );
+            if ( old != nullptr && size_now < old_size ){
+                old_size = size_now;
+                if ( moved >= old_size ) drop_old();
+            }
+        }
+
+        /** @brief destroi os elementos; o bloco novo fica, o antigo é devolvido */
+        void clear( void ){
+            for ( size_t i = 0; i < size_now; ++i ) alloc_traits::destroy( allocator, slot( i ) );
+            size_now = 0;
+            if ( old != nullptr ){
+                moved = old_size = 0;
+                drop_old();
+            }
+        }
+
+        /** @brief migra agora todos os elementos que ainda estão no bloco antigo */
+        void finish( void ){
+            if ( old != nullptr ) migrate( old_size - moved );
+        }
+
+        /**
+        * @brief garante capacidade para n elementos, movendo todos de uma vez (como vector::reserve)
+        */
+        void reserve( size_t n ){
+            if ( n <= capacity_now ) return;
+            finish();
+            T * nb = alloc_traits::allocate( allocator, n );
+            relocate( fresh, nb, size_now, is_relocatable<T>(), nb, n );
+            if ( fresh != nullptr ) alloc_traits::deallocate( allocator, fresh, capacity_now );
+            fresh = nb;
+            capacity_now = n;
+        }
+
+        // fim [I.3]
+
+    private:
+        typedef std::allocator_traits<Allocator> alloc_traits; //!< acesso uniforme ao alocador.
+
+        Allocator allocator; //!< Alocador dos dois blocos.
+        T * fresh; //!< Bloco atual: [0, moved) e [old_size, size_now) durante a migração, tudo fora dela.
+        size_t capacity_now; //!< Capacidade de fresh.
+        size_t size_now; //!< Quantidade de elementos.
+        T * old; //!< Bloco anterior, com [moved, old_size) ainda por migrar, ou nullptr.
+        size_t old_capacity; //!< Capacidade de old, para devolvê-lo.
+        size_t old_size; //!< Fim dos elementos em old (0 sem migração).
+        size_t moved; //!< Começo dos elementos em old (0 sem migração).
+        size_t released; //!< Bytes do começo de old (a partir da primeira página inteira) já devolvidos ao sistema.
+        size_t step; //!< Elementos migrados por push_back.
+
+        /** @brief endereço do elemento i: o intervalo [moved, old_size) está em old, o resto em fresh */
+        T * slot( size_t i ) const{
+            // sem migração moved == old_size == 0 e a comparação é sempre falsa.
+            return ( ( i - moved < old_size - moved ) ? old : fresh ) + i;
+        }
+
+        /**
+        * @brief aloca o bloco seguinte e passa o atual a antigo. A migração anterior, se sobrou (só depois de
+        *        pop_back e push_back alternados), termina antes
+        */
+        void grow( void ){
+            finish();
+            size_t new_cap = GrowthPolicy::next_capacity( capacity_now, size_now+1, sizeof(T) );
+            T * nb = alloc_traits::allocate( allocator, new_cap );
+            if ( size_now == 0 ){
+                if ( fresh != nullptr ) alloc_traits::deallocate( allocator, fresh, capacity_now );
+            }else{
+                old = fresh;
+                old_capacity = capacity_now;
+                old_size = size_now;
+                moved = released = 0;
+                // a migração precisa acabar nos new_cap - size_now push_back até o bloco novo encher.
+                size_t room = new_cap - size_now;
+                step = ( old_size + room - 1 ) / room + 1;
+            }
+            fresh = nb;
+            capacity_now = new_cap;
+        }
+
+        /** @brief passa até k elementos de old para fresh, devolvendo old quando esvazia */
+        void migrate( size_t k ){
+            size_t n = std::min( k, old_size - moved );
+            relocate( old + moved, fresh + moved, n, is_relocatable<T>(), nullptr, 0 );
+            moved += n;
+            if ( moved == old_size ) drop_old();
+            else release_migrated();
+        }
+
+        /**
+        * @brief devolve ao sistema as páginas inteiras de old que só tinham elementos já migrados, quando somam
+        *        256KB, para que devolver o bloco no fim da migração não custe proporcional ao seu tamanho
+        */
+        void release_migrated( void ){
+#ifdef MADV_DONTNEED
+            const uintptr_t page = 4096, chunk = uintptr_t(1) << 18;
+            if ( old_capacity * sizeof(T) < ( size_t(1) << 20 ) ) return;
+            uintptr_t begin = ( reinterpret_cast<uintptr_t>( old ) + page - 1 ) & ~( page - 1 );
+            uintptr_t end = reinterpret_cast<uintptr_t>( old + moved ) & ~( page - 1 );
+            if ( end < begin + released + chunk ) return;
+            // o conteúdo dessas páginas não é mais lido; se o alocador as reusar, voltam zeradas.
+            ::madvise( reinterpret_cast<void*>( begin + released ), end - begin - released, MADV_DONTNEED );
+            released = end - begin;
+#endif
+        }
+
+        void drop_old( void ){
+            for ( size_t i = moved; i < old_size; ++i ) alloc_traits::destroy( allocator, old + i );
+            alloc_traits::deallocate( allocator, old, old_capacity );
+            old = nullptr;
+            old_capacity = old_size = moved = released = 0;
+        }
+
+        /**
+        * @brief move n elementos de from para to (memcpy para tipos relocáveis). Se uma cópia lança, os já
+        *        construidos em to são destruidos, from fica intacto e, se owned não é nullptr, o bloco owned
+        *        (de owned_cap elementos) é devolvido
+        */
+        void relocate( T * from, T * to, size_t n, std::true_type, T *, size_t ){
+            if ( n == 0 ) return;
+            std::memcpy( static_cast<void*>( to ), static_cast<const void*>( from ), n*sizeof(T) );
+        }
+
+        void relocate( T * from, T * to, size_t n, std::false_type, T * owned, size_t owned_cap ){
+            size_t i = 0;
+            try{
+                for ( ; i < n; ++i ) alloc_traits::construct( allocator, to+i, std::move_if_noexcept( from[i] ) );
+            }catch(...){
+                for ( size_t k = 0; k < i; ++k ) alloc_traits::destroy( allocator, to+k );
+                if ( owned != nullptr ) alloc_traits::deallocate( allocator, owned, owned_cap );
+                throw;
+            }
+            for ( i = 0; i < n; ++i ) alloc_traits::destroy( allocator, from+i );
+        }
+
+        /** @brief destroi os elementos e devolve os dois blocos */
+        void release( void ){
+            clear();
+            if ( fresh != nullptr ) alloc_traits::deallocate( allocator, fresh, capacity_now );
+            fresh = nullptr;
+            capacity_now = 0;
+        }
+
+        /** @brief esquece os blocos, depois de entregá-los a outro objeto */
+        void forget( void ){
+            fresh = old = nullptr;
+            capacity_now = size_now = old_capacity = old_size = moved = released = step = 0;
+        }
+
+        void copy_allocator( const Allocator& a, std::true_type ){ allocator = a; }
+        void copy_allocator( const Allocator&, std::false_type ){ /* empty */ }
+
+        void move_allocator( Allocator& a, std::true_type ){ allocator = std::move(a); }
+        void move_allocator( Allocator&, std::false_type ){ /* empty */ }
+};
+
+// fim [I]
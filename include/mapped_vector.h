@@ -0,0 +1,404 @@
+/*! @file mapped_vector.h
+    @brief vector cujos elementos moram num arquivo mapeado em memória (mmap), para dados maiores que a RAM.
+
+    O arquivo tem um cabeçalho de uma página (mapped_file_header) seguido do bloco de elementos. O reserve do
+    vector chega ao mapped_file_allocator::reallocate, que aumenta o arquivo com ftruncate e o mapeamento com
+    mremap, sem copiar nada. Reabrir um arquivo existente só mapeia: os elementos já estão lá, prontos.
+    Quem guarda as páginas é o page cache do sistema, não o heap. Só para T trivialmente copiável.
+    Usa POSIX (open/mmap/ftruncate/msync/madvise); mremap só no Linux, nos outros o arquivo é mapeado de novo.
+*/
+
+#ifndef CSTDINT
+#define CSTDINT
+#include <cstdint>
+#endif
+
+#ifndef CSTRING
+#define CSTRING
+#include <cstring>
+#endif
+
+#ifndef MEMORY
+#define MEMORY
+#include <memory>
+#endif
+
+#ifndef STRING
+#define STRING
+#include <string>
+#endif
+
+#ifndef SYSTEM_ERROR
+#define SYSTEM_ERROR
+#include <system_error>
+#endif
+
+#ifndef CERRNO
+#define CERRNO
+#include <cerrno>
+#endif
+
+#ifndef FCNTL_H
+#define FCNTL_H
+#include <fcntl.h>
+#endif
+
+#ifndef SYS_MMAN_H
+#define SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#ifndef SYS_STAT_H
+#define SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#ifndef UNISTD_H
+#define UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+// [I] Arquivo mapeado
+
+/*! @brief cabeçalho gravado no começo do arquivo */
+struct mapped_file_header {
+    char magic[8];  //!< "EDBIVEC" e um '\0'
+    uint32_t version;  //!< versão do formato, hoje 1
+    uint32_t element_size;  //!< sizeof(T) de quem gravou
+    uint64_t size;  //!< quantidade de elementos
+    uint64_t front_gap;  //!< posições livres antes do primeiro elemento (push_front/pop_front)
+};
+
+/*! @brief padrão de acesso esperado, repassado ao sistema com madvise */
+enum class mapped_access { normal, sequential, random, willneed };
+
+/*! @brief um arquivo aberto e mapeado por inteiro: cabeçalho + bloco de elementos */
+class mapped_file {
+    public:
+        static const size_t header_bytes = 4096; //!< o bloco começa alinhado à página
+
+        /**
+        * @brief abre (ou cria) o arquivo e o mapeia
+        * @param path caminho do arquivo
+        * @param element_size sizeof(T), conferido com o do cabeçalho de um arquivo existente
+        * @param truncate descarta o conteúdo de um arquivo existente
+        * @throw std::system_error se o arquivo não puder ser aberto/mapeado, ou se não for um arquivo do vector
+        */
+        mapped_file( const std::string& path, size_t element_size, bool truncate )
+            : block_in_use{ false },
+            fd{ -1 },
+            base{ nullptr },
+            length{ 0 },
+            access{ mapped_access::normal }
+        {
+            fd = ::open( path.c_str(), O_RDWR | O_CREAT | ( truncate ? O_TRUNC : 0 ), 0644 );
+            if ( fd < 0 ) fail_open( "open" );
+
+            struct stat st;
+            if ( ::fstat( fd, &st ) != 0 ) fail_open( "fstat" );
+
+            if ( st.st_size == 0 ){
+                length = header_bytes;
+                if ( ::ftruncate( fd, (off_t) length ) != 0 ) fail_open( "ftruncate" );
+                map();
+                std::memcpy( header().magic, "EDBIVEC", 8 );
+                header().version = 1;
+                header().element_size = (uint32_t) element_size;
+                return;
+            }
+
+            length = (size_t) st.st_size;
+            if ( length < header_bytes || ( length - header_bytes ) % element_size != 0 ){
+                close_fd();
+                throw std::system_error( std::make_error_code( std::errc::invalid_argument ), "mapped_file: tamanho invalido" );
+            }
+            map();
+            if ( std::memcmp( header().magic, "EDBIVEC", 8 ) != 0 || header().version != 1 || header().element_size != element_size ){
+                unmap();
+                close_fd();
+                throw std::system_error( std::make_error_code( std::errc::invalid_argument ), "mapped_file: cabecalho invalido" );
+            }
+        }
+
+        mapped_file( const mapped_file& ) = delete;
+        mapped_file& operator=( const mapped_file& ) = delete;
+
+        /** @brief desfaz o mapeamento e fecha o arquivo; o conteúdo já está no page cache */
+        ~mapped_file(){
+            unmap();
+            close_fd();
+        }
+
+        /** @brief cabeçalho, dentro do mapeamento */
+        mapped_file_header& header( void ){
+            return *reinterpret_cast<mapped_file_header*>( base );
+        }
+
+        /** @brief começo do bloco de elementos */
+        void * data( void ) const{
+            return base + header_bytes;
+        }
+
+        /** @brief bytes do bloco de elementos */
+        size_t data_bytes( void ) const{
+            return length - header_bytes;
+        }
+
+        /**
+        * @brief muda o tamanho do bloco: ftruncate no arquivo e mremap no mapeamento (que pode mudar de endereço)
+        * @param bytes novo tamanho do bloco
+        * @return começo do bloco
+        */
+        void * resize( size_t bytes ){
+            size_t new_length = header_bytes + bytes;
+            if ( new_length == length ) return data();
+            if ( ::ftruncate( fd, (off_t) new_length ) != 0 ) throw std::bad_alloc();
+#ifdef __linux__
+            void * p = ::mremap( base, length, new_length, MREMAP_MAYMOVE );
+            if ( p == MAP_FAILED ) throw std::bad_alloc();
+            base = static_cast<char*>( p );
+            length = new_length;
+#else
+            unmap();
+            length = new_length;
+            map();
+#endif
+            advise( access );
+            return data();
+        }
+
+        /**
+        * @brief grava as páginas alteradas no disco
+        * @param wait espera a gravação terminar (MS_SYNC) ou só a agenda (MS_ASYNC)
+        */
+        void sync( bool wait ){
+            if ( ::msync( base, length, wait ? MS_SYNC : MS_ASYNC ) != 0 ){
+                throw std::system_error( errno, std::generic_category(), "mapped_file: msync" );
+            }
+        }
+
+        /** @brief avisa o sistema do padrão de acesso; vale também depois que o bloco crescer */
+        void advise( mapped_access a ){
+            access = a;
+            int advice = MADV_NORMAL;
+            if ( a == mapped_access::sequential ) advice = MADV_SEQUENTIAL;
+            if ( a == mapped_access::random ) advice = MADV_RANDOM;
+            if ( a == mapped_access::willneed ) advice = MADV_WILLNEED;
+            ::madvise( base, length, advice );
+        }
+
+        bool block_in_use; //!< o bloco pertence a um vector; um segundo allocate usa memória anônima
+
+    private:
+        int fd; //!< descritor do arquivo
+        char * base; //!< começo do mapeamento (o cabeçalho)
+        size_t length; //!< tamanho do arquivo e do mapeamento
+        mapped_access access; //!< último padrão de acesso pedido
+
+        void map( void ){
+            void * p = ::mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+            if ( p == MAP_FAILED ) fail_open( "mmap" );
+            base = static_cast<char*>( p );
+        }
+
+        void unmap( void ){
+            if ( base != nullptr ) ::munmap( base, length );
+            base = nullptr;
+        }
+
+        void close_fd( void ){
+            if ( fd >= 0 ) ::close( fd );
+            fd = -1;
+        }
+
+        /** @brief erro na abertura: fecha o arquivo e lança o errno da chamada que falhou */
+        void fail_open( const char * what ){
+            int e = errno;
+            close_fd();
+            throw std::system_error( e, std::generic_category(), std::string( "mapped_file: " ) + what );
+        }
+};
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Alocador
+
+/*! @brief alocador cujo bloco mora num mapped_file. Oferece 'reallocate', então o reserve do vector cresce o
+    arquivo no lugar. Cada arquivo tem um bloco só: alocações a mais (ex: a cópia de um vector) e alocadores
+    sem arquivo usam memória comum do std::allocator.
+    @tparam T tipo de dado alocado, trivialmente copiável
+*/
+template < typename T >
+class mapped_file_allocator {
+    public:
+        typedef T value_type;  /*!< @var tipo de dado alocado */
+        typedef std::false_type propagate_on_container_copy_assignment;  //!< o vector fica sempre no seu arquivo
+        typedef std::false_type propagate_on_container_move_assignment;  //!< idem
+        typedef std::false_type propagate_on_container_swap;  //!< idem
+
+        static_assert( std::is_trivially_copyable<T>::value, "mapped_file_allocator guarda bytes: T precisa ser trivialmente copiavel" );
+        static_assert( alignof(T) <= mapped_file::header_bytes, "alinhamento de T maior que uma pagina" );
+
+        mapped_file_allocator( void ) { /* empty */ }
+
+        explicit mapped_file_allocator( std::shared_ptr<mapped_file> f ) : file( std::move(f) ) { /* empty */ }
+
+        template < typename U >
+        mapped_file_allocator( const mapped_file_allocator<U>& a ) : file( a.file ) { /* empty */ }
+
+        /** @brief cópias de um vector não vão para o arquivo */
+        mapped_file_allocator select_on_container_copy_construction( void ) const{
+            return mapped_file_allocator();
+        }
+
+        /**
+        * @brief aloca memória bruta para 'n' elementos: o bloco do arquivo, se estiver livre
+        * @param n quantidade de elementos
+        * @return ponteiro para a memória
+        */
+        T * allocate( size_t n ){
+            if ( file == nullptr || file->block_in_use ) return std::allocator<T>().allocate( n );
+            if ( n > ( size_t(-1) - mapped_file::header_bytes ) / sizeof(T) ) throw std::bad_alloc();
+            T * p = static_cast<T*>( file->resize( n*sizeof(T) ) );
+            file->block_in_use = true;
+            return p;
+        }
+
+        /**
+        * @brief devolve a memória; o bloco do arquivo fica com o conteúdo, só deixa de pertencer ao vector
+        * @param p memória obtida com allocate ou reallocate
+        * @param n quantidade de elementos
+        */
+        void deallocate( T * p, size_t n ){
+            if ( in_file( p ) ){
+                file->block_in_use = false;
+                return;
+            }
+            std::allocator<T>().deallocate( p, n );
+        }
+
+        /**
+        * @brief muda o tamanho de um bloco mantendo seu conteúdo: ftruncate + mremap no arquivo
+        * @param p bloco atual, pode ser nullptr
+        * @param old_n quantidade atual de elementos
+        * @param new_n nova quantidade de elementos
+        * @return ponteiro para o bloco, possivelmente outro endereço
+        */
+        T * reallocate( T * p, size_t old_n, size_t new_n ){
+            if ( p == nullptr ) return allocate( new_n );
+            if ( in_file( p ) ){
+                if ( new_n > ( size_t(-1) - mapped_file::header_bytes ) / sizeof(T) ) throw std::bad_alloc();
+                return static_cast<T*>( file->resize( new_n*sizeof(T) ) );
+            }
+            T * q = std::allocator<T>().allocate( new_n );
+            std::memcpy( static_cast<void*>(q), static_cast<const void*>(p), std::min( old_n, new_n )*sizeof(T) );
+            std::allocator<T>().deallocate( p, old_n );
+            return q;
+        }
+
+        /** @brief arquivo do alocador, nullptr se não tiver */
+        const std::shared_ptr<mapped_file>& mapping( void ) const{
+            return file;
+        }
+
+        template < typename U >
+        bool operator==( const mapped_file_allocator<U>& a ) const{ return file == a.file; }
+
+        template < typename U >
+        bool operator!=( const mapped_file_allocator<U>& a ) const{ return file != a.file; }
+
+    private:
+        template < typename U > friend class mapped_file_allocator;
+
+        std::shared_ptr<mapped_file> file; //!< arquivo compartilhado pelas cópias do alocador
+
+        bool in_file( const T * p ) const{
+            return file != nullptr && file->block_in_use && p == file->data();
+        }
+};
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] mapped_vector
+
+/*! @brief vector guardado num arquivo. push_back, insert, operator[], iteradores etc. são os do vector;
+    o tamanho é gravado no cabeçalho no sync() e no destrutor, e a próxima abertura do arquivo volta ao mesmo estado.
+    @tparam T tipo de dado armazenado, trivialmente copiável
+    @tparam GrowthPolicy política de crescimento da capacidade, ex: growth_page_rounded<> para crescer em páginas
+*/
+template < typename T, typename GrowthPolicy = growth_factor_2 >
+class mapped_vector : public ::vector<T, mapped_file_allocator<T>, GrowthPolicy> {
+    typedef ::vector<T, mapped_file_allocator<T>, GrowthPolicy> base;
+
+    public:
+        /**
+        * @brief abre o arquivo, criando-o se não existir; os elementos gravados nele passam a ser os do vector
+        * @param path caminho do arquivo
+        * @param truncate descarta o conteúdo atual do arquivo
+        * @throw std::system_error se o arquivo não puder ser aberto ou não for de um mapped_vector<T>
+        */
+        explicit mapped_vector( const std::string& path, bool truncate = false )
+            : base( mapped_file_allocator<T>( std::make_shared<mapped_file>( path, sizeof(T), truncate ) ) )
+        {
+            mapped_file& f = file();
+            size_t total = f.data_bytes() / sizeof(T);
+            size_t gap = f.header().front_gap, count = f.header().size;
+            if ( gap > total || count > total - gap ){
+                throw std::system_error( std::make_error_code( std::errc::invalid_argument ), "mapped_vector: cabecalho invalido" );
+            }
+            if ( total != 0 ){
+                f.block_in_use = true;
+                this->adopt( static_cast<T*>( f.data() ), total, gap, count );
+            }
+        }
+
+        mapped_vector( const mapped_vector& ) = delete;
+        mapped_vector& operator=( const mapped_vector& ) = delete;
+
+        using base::operator=;
+
+        /** @brief grava o tamanho no cabeçalho; as páginas vão para o disco quando o sistema quiser */
+        ~mapped_vector(){
+            write_header();
+        }
+
+        /**
+        * @brief grava o tamanho no cabeçalho e as páginas alteradas no disco
+        * @param wait espera a gravação terminar (MS_SYNC) ou só a agenda (MS_ASYNC)
+        */
+        void sync( bool wait = true ){
+            write_header();
+            file().sync( wait );
+        }
+
+        /**
+        * @brief avisa o sistema de como os elementos serão percorridos (madvise)
+        * @param a sequential para leituras em ordem (read-ahead maior), random para acessos espalhados
+        */
+        void advise( mapped_access a ){
+            file().advise( a );
+        }
+
+    private:
+        mapped_file& file( void ){
+            return *this->get_allocator().mapping();
+        }
+
+        void write_header( void ){
+            mapped_file& f = file();
+            bool in_file = f.block_in_use && this->size() != 0;
+            f.header().size = in_file ? this->size() : 0;
+            f.header().front_gap = in_file ? (uint64_t) ( this->data() - static_cast<T*>( f.data() ) ) : 0;
+        }
+};
+
+// fim [III]
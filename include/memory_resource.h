@@ -0,0 +1,232 @@
+/*! @file memory_resource.h
+    @brief vector com std::pmr::memory_resource: arena de uma requisição e pool por thread com classes de tamanho.
+
+    O vector já aceita qualquer alocador; com std::pmr::polymorphic_allocator a memória vem de um
+    std::pmr::memory_resource escolhido em tempo de execução (pmr_vector<T>). Recursos oferecidos aqui:
+    - arena<Bytes>: monotonic_buffer_resource com os primeiros Bytes dentro do próprio objeto; deallocate não
+      faz nada e reset() devolve tudo de uma vez, ideal para os vectors de vida curta de uma requisição
+    - size_class_pool_resource: listas livres por classe de tamanho (potências de 2 de 16B a 64KB), sem lock;
+      thread_local_pool() devolve o da thread atual
+*/
+
+#ifndef ATOMIC
+#define ATOMIC
+#include <atomic>
+#endif
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef MEMORY_RESOURCE
+#define MEMORY_RESOURCE
+#include <memory_resource>
+#endif
+
+#ifndef THREAD
+#define THREAD
+#include <thread>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+#include "small_vector.h"
+#endif
+
+// [I] Aliases
+
+/*! @brief vector cuja memória vem de um std::pmr::memory_resource, ex: pmr_vector<int> v( &arena ); */
+template < typename T, typename GrowthPolicy = growth_factor_2 >
+using pmr_vector = ::vector< T, std::pmr::polymorphic_allocator<T>, GrowthPolicy >;
+
+/*! @brief small_vector que, passado de N elementos, usa um std::pmr::memory_resource */
+template < typename T, size_t N, typename GrowthPolicy = growth_factor_2 >
+using pmr_small_vector = small_vector< T, N, std::pmr::polymorphic_allocator<T>, GrowthPolicy >;
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Arena
+
+/*! @brief guarda o buffer interno da arena; vem antes da base monotonic_buffer_resource, que o recebe pronto */
+template < size_t Bytes >
+struct arena_buffer {
+    alignas(std::max_align_t) unsigned char initial[ Bytes ];
+};
+
+/*! @brief arena monotônica: os primeiros Bytes vêm de dentro do objeto, o resto de blocos do upstream,
+    cada um maior que o anterior. Nada é liberado até reset() ou a destruição. Não é thread-safe.
+    @tparam Bytes tamanho do buffer interno
+*/
+template < size_t Bytes = 4096 >
+class arena : private arena_buffer<Bytes>, public std::pmr::monotonic_buffer_resource {
+    public:
+        /**
+        * @param upstream de onde vêm os blocos depois que o buffer interno acaba
+        */
+        explicit arena( std::pmr::memory_resource * upstream = std::pmr::get_default_resource() )
+            : std::pmr::monotonic_buffer_resource( this->initial, Bytes, upstream )
+        { /* empty */ }
+
+        arena( const arena& ) = delete;
+        arena& operator=( const arena& ) = delete;
+
+        /** @brief devolve tudo de uma vez; os vectors que usavam a arena não podem mais ser usados */
+        void reset( void ){
+            this->release();
+        }
+};
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] Pool por classe de tamanho
+
+/*! @brief pool com uma lista livre por classe de tamanho (16B, 32B, ..., 64KB). Pedidos maiores, ou com
+    alinhamento acima de alignof(max_align_t), vão direto ao upstream.
+    Só a thread dona (a que criou o pool) aloca; qualquer thread pode devolver: devoluções de outras threads
+    entram numa pilha atômica da classe e a dona as recolhe quando a lista livre esvazia.
+    Os blocos voltam ao upstream apenas em release() ou na destruição.
+*/
+class size_class_pool_resource : public std::pmr::memory_resource {
+    public:
+        static const size_t min_class_log2 = 4;  //!< menor classe: 16 bytes
+        static const size_t max_class_log2 = 16;  //!< maior classe: 64KB
+        static const size_t classes = max_class_log2 - min_class_log2 + 1;
+        static const size_t slab_bytes = size_t(1) << 18;  //!< blocos pedidos ao upstream, repartidos entre os pedidos
+
+        /**
+        * @param upstream de onde vêm os blocos grandes; precisa ser thread-safe se outras threads devolverem memória
+        */
+        explicit size_class_pool_resource( std::pmr::memory_resource * upstream = std::pmr::new_delete_resource() )
+            : upstream{ upstream },
+            slabs{ nullptr },
+            owner{ std::this_thread::get_id() }
+        {
+            for ( size_t c = 0; c < classes; ++c ){
+                free_lists[c] = nullptr;
+                remote[c].store( nullptr, std::memory_order_relaxed );
+            }
+        }
+
+        size_class_pool_resource( const size_class_pool_resource& ) = delete;
+        size_class_pool_resource& operator=( const size_class_pool_resource& ) = delete;
+
+        ~size_class_pool_resource(){
+            release();
+        }
+
+        /** @brief devolve ao upstream toda a memória das classes; nada do que foi alocado pode mais ser usado */
+        void release( void ){
+            while ( slabs != nullptr ){
+                slab * next = slabs->next;
+                upstream->deallocate( slabs, slabs->bytes, alignof(std::max_align_t) );
+                slabs = next;
+            }
+            for ( size_t c = 0; c < classes; ++c ){
+                free_lists[c] = nullptr;
+                remote[c].store( nullptr, std::memory_order_relaxed );
+            }
+        }
+
+        /** @brief recurso de onde vêm os blocos */
+        std::pmr::memory_resource * upstream_resource( void ) const{
+            return upstream;
+        }
+
+    protected:
+        void * do_allocate( size_t bytes, size_t alignment ) override{
+            if ( bytes > ( size_t(1) << max_class_log2 ) || alignment > alignof(std::max_align_t) ){
+                return upstream->allocate( bytes, alignment );
+            }
+            size_t c = class_of( bytes );
+            if ( free_lists[c] == nullptr ){
+                // primeiro as devoluções de outras threads, depois um bloco novo.
+                free_lists[c] = remote[c].exchange( nullptr, std::memory_order_acquire );
+                if ( free_lists[c] == nullptr ) refill( c );
+            }
+            free_block * b = free_lists[c];
+            free_lists[c] = b->next;
+            return b;
+        }
+
+        void do_deallocate( void * p, size_t bytes, size_t alignment ) override{
+            if ( bytes > ( size_t(1) << max_class_log2 ) || alignment > alignof(std::max_align_t) ){
+                upstream->deallocate( p, bytes, alignment );
+                return;
+            }
+            size_t c = class_of( bytes );
+            free_block * b = static_cast<free_block*>( p );
+            if ( std::this_thread::get_id() == owner ){
+                b->next = free_lists[c];
+                free_lists[c] = b;
+                return;
+            }
+            b->next = remote[c].load( std::memory_order_relaxed );
+            while ( !remote[c].compare_exchange_weak( b->next, b, std::memory_order_release, std::memory_order_relaxed ) ){ /* empty */ }
+        }
+
+        bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override{
+            return this == &other;
+        }
+
+    private:
+        /*! @brief bloco livre, a ligação mora no próprio bloco */
+        struct free_block {
+            free_block * next;
+        };
+
+        /*! @brief bloco pedido ao upstream; o cabeçalho ocupa o começo, alinhado a max_align_t */
+        struct alignas(std::max_align_t) slab {
+            slab * next;
+            size_t bytes;
+        };
+
+        std::pmr::memory_resource * upstream; //!< origem dos blocos
+        free_block * free_lists[ classes ]; //!< blocos livres de cada classe, só a dona mexe
+        std::atomic<free_block*> remote[ classes ]; //!< devoluções de outras threads
+        slab * slabs; //!< blocos pedidos ao upstream
+        std::thread::id owner; //!< thread que aloca
+
+        /** @brief classe de um pedido de 'bytes' (a menor potência de 2 que cabe) */
+        static size_t class_of( size_t bytes ){
+            if ( bytes <= ( size_t(1) << min_class_log2 ) ) return 0;
+            return ( 64 - __builtin_clzll( bytes-1 ) ) - min_class_log2;
+        }
+
+        /** @brief pede um bloco ao upstream e o reparte em blocos livres da classe c */
+        void refill( size_t c ){
+            size_t block = size_t(1) << ( c + min_class_log2 );
+            size_t bytes = sizeof(slab) + ( block*4 > slab_bytes ? block*4 : slab_bytes );
+            slab * s = static_cast<slab*>( upstream->allocate( bytes, alignof(std::max_align_t) ) );
+            s->next = slabs;
+            s->bytes = bytes;
+            slabs = s;
+
+            unsigned char * first = reinterpret_cast<unsigned char*>( s + 1 );
+            size_t count = ( bytes - sizeof(slab) ) / block;
+            free_block * head = nullptr;
+            for ( size_t i = count; i-- > 0; ){
+                free_block * b = reinterpret_cast<free_block*>( first + i*block );
+                b->next = head;
+                head = b;
+            }
+            free_lists[c] = head;
+        }
+};
+
+/** @brief pool da thread atual, destruido quando ela termina (e a memória que ainda estiver em uso com ele) */
+inline size_class_pool_resource * thread_local_pool( void ){
+    static thread_local size_class_pool_resource pool;
+    return &pool;
+}
+
+// fim [III]
@@ -0,0 +1,616 @@
+/*! @file packed_vector.h
+    @brief vector de inteiros compactados em bits: packed_vector<T> e packed_vector<T, frame_of_reference<B>>.
+
+    Cada elemento ocupa só os bits necessários, num vector<uint64_t>; operator[] lê um elemento em O(1) com
+    duas palavras e um deslocamento, e decode()/for_each() desempacotam em sequência com gathers AVX2/AVX-512
+    (ou o laço escalar), escolhidos em tempo de execução como em simd.h.
+    - bit_packed (padrão): uma largura para todos, a do maior valor; push_back/set que precisam de mais bits
+      reempacotam tudo na largura nova (no máximo 64 vezes na vida do vector). Inteiros com sinal usam zigzag,
+      então valores pequenos negativos também ocupam poucos bits
+    - frame_of_reference<B>: blocos de B elementos, cada um com sua base (o menor valor) e sua largura; guarda
+      só valor - base, o que compacta sequências ordenadas ou agrupadas (ex: timestamps, ids crescentes) tão
+      bem quanto deltas, sem perder o acesso O(1). push_back só reempacota o último bloco
+*/
+
+#ifndef ALGORITHM
+#define ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef CSTDINT
+#define CSTDINT
+#include <cstdint>
+#endif
+
+#ifndef INITIALIZER_LIST
+#define INITIALIZER_LIST
+#include <initializer_list>
+#endif
+
+#ifndef ITERATOR
+#define ITERATOR
+#include <iterator>
+#endif
+
+#ifndef STDEXCEPT
+#define STDEXCEPT
+#include <stdexcept>
+#endif
+
+#ifndef TYPE_TRAITS
+#define TYPE_TRAITS
+#include <type_traits>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+#ifndef SIMD_H
+#define SIMD_H
+#include "simd.h"
+#endif
+
+// [I] Campos de bits
+
+/*! @brief leitura e escrita de campos de w bits (0 a 64) em palavras de 64 bits. A última palavra do array é
+    folga: um campo pode ser lido com duas palavras (ou 8 bytes a partir do seu byte) sem passar do fim
+*/
+struct bit_field {
+    static uint64_t mask( unsigned w ){
+        return ( w >= 64 ) ? ~uint64_t(0) : ( ( uint64_t(1) << w ) - 1 );
+    }
+
+    /** @brief bits necessários para x (0 para x == 0) */
+    static unsigned width_of( uint64_t x ){
+        return ( x == 0 ) ? 0 : 64 - __builtin_clzll( x );
+    }
+
+    /** @brief palavras para 'bits' bits, mais a folga */
+    static size_t words_for( size_t bits ){
+        return bits / 64 + 2;
+    }
+
+    static uint64_t read( const uint64_t * words, size_t bit, unsigned w ){
+        size_t k = bit >> 6;
+        unsigned off = bit & 63;
+        // ( x << 1 ) << ( 63 - off ) vale x << ( 64 - off ) também para off == 0, sem deslocar 64.
+        uint64_t v = ( words[k] >> off ) | ( ( words[k+1] << 1 ) << ( 63 - off ) );
+        return v & mask( w );
+    }
+
+    static void write( uint64_t * words, size_t bit, unsigned w, uint64_t v ){
+        if ( w == 0 ) return;
+        size_t k = bit >> 6;
+        unsigned off = bit & 63;
+        uint64_t m = mask( w );
+        words[k] = ( words[k] & ~( m << off ) ) | ( v << off );
+        if ( off + w > 64 ){
+            unsigned done = 64 - off;
+            words[k+1] = ( words[k+1] & ~( m >> done ) ) | ( v >> done );
+        }
+    }
+};
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Desempacotamento vetorizado
+
+namespace simd {
+
+namespace scalar {
+
+    /** @brief out[i] = base + campo i de w bits, para i em [0, count), com o primeiro campo no bit 'bit' */
+    inline void unpack_bits( const uint64_t * words, size_t bit, unsigned w, size_t count, uint64_t base, uint64_t * out ){
+        for ( size_t i = 0; i < count; ++i ) out[i] = base + bit_field::read( words, bit + i*w, w );
+    }
+
+} // namespace scalar
+
+#ifdef EDBI_SIMD_X86
+
+// cada lane lê 8 bytes a partir do byte do seu campo e desloca de 0 a 7 bits: serve para w <= 57.
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2 {
+
+    inline void unpack_bits( const uint64_t * words, size_t bit, unsigned w, size_t count, uint64_t base, uint64_t * out ){
+        if ( w > 57 ) return scalar::unpack_bits( words, bit, w, count, base, out );
+        const long long * bytes = reinterpret_cast<const long long*>( words );
+        __m256i pos = _mm256_set_epi64x( (long long) ( bit + 3*w ), (long long) ( bit + 2*w ), (long long) ( bit + w ), (long long) bit );
+        __m256i step = _mm256_set1_epi64x( (long long) ( 4*w ) );
+        __m256i m = _mm256_set1_epi64x( (long long) bit_field::mask( w ) );
+        __m256i b = _mm256_set1_epi64x( (long long) base );
+        __m256i seven = _mm256_set1_epi64x( 7 );
+        size_t i = 0;
+        for ( ; i + 4 <= count; i += 4 ){
+            __m256i g = _mm256_i64gather_epi64( bytes, _mm256_srli_epi64( pos, 3 ), 1 );
+            __m256i v = _mm256_and_si256( _mm256_srlv_epi64( g, _mm256_and_si256( pos, seven ) ), m );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( out+i ), _mm256_add_epi64( v, b ) );
+            pos = _mm256_add_epi64( pos, step );
+        }
+        scalar::unpack_bits( words, bit + i*w, w, count-i, base, out+i );
+    }
+
+} // namespace avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace avx512 {
+
+    inline void unpack_bits( const uint64_t * words, size_t bit, unsigned w, size_t count, uint64_t base, uint64_t * out ){
+        if ( w > 57 ) return scalar::unpack_bits( words, bit, w, count, base, out );
+        long long s = (long long) bit, d = (long long) w;
+        __m512i pos = _mm512_set_epi64( s + 7*d, s + 6*d, s + 5*d, s + 4*d, s + 3*d, s + 2*d, s + d, s );
+        __m512i step = _mm512_set1_epi64( (long long) ( 8*w ) );
+        __m512i m = _mm512_set1_epi64( (long long) bit_field::mask( w ) );
+        __m512i b = _mm512_set1_epi64( (long long) base );
+        __m512i seven = _mm512_set1_epi64( 7 );
+        size_t i = 0;
+        for ( ; i + 8 <= count; i += 8 ){
+            __m512i g = _mm512_i64gather_epi64( _mm512_srli_epi64( pos, 3 ), words, 1 );
+            __m512i v = _mm512_and_si512( _mm512_srlv_epi64( g, _mm512_and_si512( pos, seven ) ), m );
+            _mm512_storeu_si512( out+i, _mm512_add_epi64( v, b ) );
+            pos = _mm512_add_epi64( pos, step );
+        }
+        scalar::unpack_bits( words, bit + i*w, w, count-i, base, out+i );
+    }
+
+} // namespace avx512
+#pragma GCC pop_options
+
+#endif
+
+/**
+* @brief out[i] = base + campo i de w bits, para i em [0, count), com o primeiro campo no bit 'bit' de words;
+*        words precisa da palavra de folga depois do último campo (bit_field::words_for)
+*/
+inline void unpack_bits( const uint64_t * words, size_t bit, unsigned w, size_t count, uint64_t base, uint64_t * out ){
+    switch ( active() ){
+#ifdef EDBI_SIMD_X86
+        case isa::avx512: return avx512::unpack_bits( words, bit, w, count, base, out );
+        case isa::avx2: return avx2::unpack_bits( words, bit, w, count, base, out );
+#endif
+        default: return scalar::unpack_bits( words, bit, w, count, base, out );
+    }
+}
+
+} // namespace simd
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] Codificações
+
+/*! @brief uma largura para todos os elementos; com sinal, zigzag (0, -1, 1, -2, ... viram 0, 1, 2, 3, ...) */
+struct bit_packed {
+    template < typename T >
+    static uint64_t encode( T x ){
+        if constexpr ( std::is_signed<T>::value ){
+            int64_t s = (int64_t) x;
+            return ( (uint64_t) s << 1 ) ^ (uint64_t) ( s >> 63 );
+        }else{
+            return (uint64_t) x;
+        }
+    }
+
+    template < typename T >
+    static T decode( uint64_t e ){
+        if constexpr ( std::is_signed<T>::value ){
+            return (T) (int64_t) ( ( e >> 1 ) ^ ( ~( e & 1 ) + 1 ) );
+        }else{
+            return (T) e;
+        }
+    }
+};
+
+/*! @brief blocos de B elementos com base e largura próprias; com sinal, o bit de sinal é invertido, o que mantém
+    a ordem (a base é o menor valor do bloco)
+    @tparam B elementos por bloco
+*/
+template < size_t B = 128 >
+struct frame_of_reference {
+    static constexpr size_t block = B;
+
+    template < typename T >
+    static uint64_t encode( T x ){
+        if constexpr ( std::is_signed<T>::value ) return (uint64_t) (int64_t) x ^ ( uint64_t(1) << 63 );
+        else return (uint64_t) x;
+    }
+
+    template < typename T >
+    static T decode( uint64_t e ){
+        if constexpr ( std::is_signed<T>::value ) return (T) (int64_t) ( e ^ ( uint64_t(1) << 63 ) );
+        else return (T) e;
+    }
+};
+
+// fim [III]
+
+//---------------------------------------------------------------------------------------------------
+
+// [IV] packed_vector
+
+/*! @brief iterator de leitura de um packed_vector: devolve os elementos por valor, em O(1) cada */
+template < typename Packed >
+class packed_iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;  /*!< @var devolve valores, não referências */
+#if __cplusplus > 201703L
+        typedef std::random_access_iterator_tag iterator_concept;
+#endif
+        typedef typename Packed::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef value_type reference;
+        typedef void pointer;
+
+        packed_iterator() : owner{ nullptr }, index{ 0 } { /* empty */ }
+        packed_iterator( const Packed * o, size_t i ) : owner{ o }, index{ i } { /* empty */ }
+
+        value_type operator*( ) const{ return (*owner)[index]; }
+        value_type operator[]( difference_type d ) const{ return (*owner)[index+d]; }
+
+        packed_iterator& operator++( ){ ++index; return *this; }
+        packed_iterator operator++( int ){ packed_iterator t( *this ); ++index; return t; }
+        packed_iterator& operator--( ){ --index; return *this; }
+        packed_iterator operator--( int ){ packed_iterator t( *this ); --index; return t; }
+        packed_iterator& operator+=( difference_type d ){ index += d; return *this; }
+        packed_iterator& operator-=( difference_type d ){ index -= d; return *this; }
+
+        friend packed_iterator operator+( packed_iterator m, difference_type d ){ return m += d; }
+        friend packed_iterator operator+( difference_type d, packed_iterator m ){ return m += d; }
+        friend packed_iterator operator-( packed_iterator m, difference_type d ){ return m -= d; }
+        friend difference_type operator-( packed_iterator a, packed_iterator b ){
+            return (difference_type) a.index - (difference_type) b.index;
+        }
+
+        friend bool operator==( packed_iterator a, packed_iterator b ){ return a.index == b.index; }
+        friend bool operator!=( packed_iterator a, packed_iterator b ){ return a.index != b.index; }
+        friend bool operator<( packed_iterator a, packed_iterator b ){ return a.index < b.index; }
+        friend bool operator>( packed_iterator a, packed_iterator b ){ return a.index > b.index; }
+        friend bool operator<=( packed_iterator a, packed_iterator b ){ return a.index <= b.index; }
+        friend bool operator>=( packed_iterator a, packed_iterator b ){ return a.index >= b.index; }
+
+    private:
+        const Packed * owner; //!< vector percorrido
+        size_t index; //!< posição do elemento
+};
+
+/*! @brief vector de inteiros com bit-packing
+    @tparam T tipo inteiro dos elementos
+    @tparam Encoding bit_packed ou frame_of_reference<B>
+*/
+template < typename T, typename Encoding = bit_packed >
+class packed_vector {
+    public:
+        typedef T value_type;  /*!< @var tipo dos elementos */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos e índices */
+        typedef packed_iterator<packed_vector> const_iterator;  /*!< @var só leitura: use set() para alterar */
+        typedef const_iterator iterator;
+
+        static_assert( std::is_integral<T>::value && sizeof(T) <= 8, "packed_vector guarda inteiros de até 64 bits" );
+
+        /** @brief vector vazio, largura 0 */
+        packed_vector() : size_now{ 0 }, width{ 0 } { /* empty */ }
+
+        /** @brief vector com os valores da lista, ex: {1, 2, 3} */
+        packed_vector( std::initializer_list<T> l ) : size_now{ 0 }, width{ 0 } {
+            for ( T x : l ) push_back( x );
+        }
+
+        const_iterator begin( void ) const{ return const_iterator( this, 0 ); }
+        const_iterator end( void ) const{ return const_iterator( this, size_now ); }
+        const_iterator cbegin( void ) const{ return begin(); }
+        const_iterator cend( void ) const{ return end(); }
+
+        size_t size( void ) const{ return size_now; }
+        bool empty( void ) const{ return size_now == 0; }
+
+        /** @brief bits por elemento atuais */
+        unsigned bits( void ) const{ return width; }
+
+        /** @brief bytes de memória ocupados pelos elementos */
+        size_t memory_bytes( void ) const{ return words.capacity() * sizeof(uint64_t); }
+
+        /** @brief reserva palavras para n elementos na largura atual */
+        void reserve( size_t n ){ words.reserve( bit_field::words_for( n*width ) ); }
+
+        void clear( void ){
+            words.clear();
+            size_now = 0;
+            width = 0;
+        }
+
+        /** @brief devolve as palavras não usadas */
+        void shrink_to_fit( void ){
+            size_t need = bit_field::words_for( size_now*width );
+            while ( words.size() > need ) words.pop_back();
+            words.shrink_to_fit();
+        }
+
+        /** @brief elemento i, em O(1) */
+        T operator[]( size_t i ) const{
+            return Encoding::template decode<T>( bit_field::read( words.data(), i*width, width ) );
+        }
+
+        /**
+        * @brief elemento i
+        * @throw std::out_of_range se i >= size()
+        */
+        T at( size_t i ) const{
+            if ( i >= size_now ) throw std::out_of_range( "packed_vector::at" );
+            return (*this)[i];
+        }
+
+        T front( void ) const{ return (*this)[0]; }
+        T back( void ) const{ return (*this)[ size_now-1 ]; }
+
+        /** @brief acrescenta x; se x precisa de mais bits, todos são reempacotados na largura nova */
+        void push_back( T x ){
+            uint64_t e = Encoding::template encode<T>( x );
+            unsigned need = bit_field::width_of( e );
+            if ( need > width ) repack( need );
+            ensure_bits( ( size_now+1 ) * width );
+            bit_field::write( words.data(), size_now*width, width, e );
+            ++size_now;
+        }
+
+        void pop_back( void ){
+            --size_now;
+        }
+
+        /** @brief troca o elemento i por x, reempacotando tudo se x precisa de mais bits */
+        void set( size_t i, T x ){
+            uint64_t e = Encoding::template encode<T>( x );
+            unsigned need = bit_field::width_of( e );
+            if ( need > width ) repack( need );
+            bit_field::write( words.data(), i*width, width, e );
+        }
+
+        /**
+        * @brief desempacota os elementos de [first, first+count) em out, com os kernels de simd
+        */
+        void decode( size_t first, size_t count, T * out ) const{
+            uint64_t buffer[ chunk ];
+            for ( size_t done = 0; done < count; ){
+                size_t c = std::min( chunk, count - done );
+                simd::unpack_bits( words.data(), ( first+done ) * width, width, c, 0, buffer );
+                for ( size_t k = 0; k < c; ++k ) out[done+k] = Encoding::template decode<T>( buffer[k] );
+                done += c;
+            }
+        }
+
+        /** @brief chama f( elemento ) para todos, em ordem, desempacotando em blocos */
+        template < typename F >
+        void for_each( F f ) const{
+            uint64_t buffer[ chunk ];
+            for ( size_t i = 0; i < size_now; i += chunk ){
+                size_t c = std::min( chunk, size_now - i );
+                simd::unpack_bits( words.data(), i*width, width, c, 0, buffer );
+                for ( size_t k = 0; k < c; ++k ) f( Encoding::template decode<T>( buffer[k] ) );
+            }
+        }
+
+    private:
+        static constexpr size_t chunk = 256; //!< elementos desempacotados por vez
+
+        ::vector<uint64_t> words; //!< campos de 'width' bits, mais a palavra de folga
+        size_t size_now; //!< quantidade de elementos
+        unsigned width; //!< bits por elemento
+
+        void ensure_bits( size_t bits ){
+            size_t need = bit_field::words_for( bits );
+            while ( words.size() < need ) words.push_back( 0 );
+        }
+
+        /** @brief regrava todos os elementos com 'new_width' bits */
+        void repack( unsigned new_width ){
+            ::vector<uint64_t> wider;
+            size_t need = bit_field::words_for( size_now*new_width );
+            wider.reserve( need );
+            for ( size_t k = 0; k < need; ++k ) wider.push_back( 0 );
+            for ( size_t i = 0; i < size_now; ++i ){
+                bit_field::write( wider.data(), i*new_width, new_width, bit_field::read( words.data(), i*width, width ) );
+            }
+            words = std::move( wider );
+            width = new_width;
+        }
+};
+
+/*! @brief packed_vector com frame of reference: blocos de B elementos, cada um com base e largura próprias */
+template < typename T, size_t B >
+class packed_vector< T, frame_of_reference<B> > {
+        typedef frame_of_reference<B> Encoding;
+
+    public:
+        typedef T value_type;  /*!< @var tipo dos elementos */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos e índices */
+        typedef packed_iterator<packed_vector> const_iterator;  /*!< @var só leitura: use set() para alterar */
+        typedef const_iterator iterator;
+
+        static_assert( std::is_integral<T>::value && sizeof(T) <= 8, "packed_vector guarda inteiros de até 64 bits" );
+        static_assert( B > 0, "frame_of_reference precisa de blocos com B > 0" );
+
+        packed_vector() : size_now{ 0 } { /* empty */ }
+
+        packed_vector( std::initializer_list<T> l ) : size_now{ 0 } {
+            for ( T x : l ) push_back( x );
+        }
+
+        const_iterator begin( void ) const{ return const_iterator( this, 0 ); }
+        const_iterator end( void ) const{ return const_iterator( this, size_now ); }
+        const_iterator cbegin( void ) const{ return begin(); }
+        const_iterator cend( void ) const{ return end(); }
+
+        size_t size( void ) const{ return size_now; }
+        bool empty( void ) const{ return size_now == 0; }
+
+        /** @brief bits por elemento do bloco do elemento i */
+        unsigned bits( size_t i ) const{ return blocks[ i / B ].width; }
+
+        /** @brief bytes de memória ocupados pelos elementos e pelos cabeçalhos dos blocos */
+        size_t memory_bytes( void ) const{
+            return words.capacity() * sizeof(uint64_t) + blocks.capacity() * sizeof(header);
+        }
+
+        void clear( void ){
+            words.clear();
+            blocks.clear();
+            size_now = 0;
+        }
+
+        /** @brief devolve as palavras e cabeçalhos não usados */
+        void shrink_to_fit( void ){
+            size_t need = bit_field::words_for( used_bits() );
+            while ( words.size() > need ) words.pop_back();
+            words.shrink_to_fit();
+            blocks.shrink_to_fit();
+        }
+
+        /** @brief elemento i, em O(1): base do bloco mais o campo */
+        T operator[]( size_t i ) const{
+            const header& h = blocks[ i / B ];
+            return Encoding::template decode<T>( h.base + bit_field::read( words.data(), h.bit + ( i % B ) * h.width, h.width ) );
+        }
+
+        /**
+        * @brief elemento i
+        * @throw std::out_of_range se i >= size()
+        */
+        T at( size_t i ) const{
+            if ( i >= size_now ) throw std::out_of_range( "packed_vector::at" );
+            return (*this)[i];
+        }
+
+        T front( void ) const{ return (*this)[0]; }
+        T back( void ) const{ return (*this)[ size_now-1 ]; }
+
+        /** @brief acrescenta x; se x fica fora da base e largura do último bloco, só esse bloco é reempacotado */
+        void push_back( T x ){
+            uint64_t e = Encoding::template encode<T>( x );
+            size_t j = size_now % B;
+            if ( j == 0 ) blocks.push_back( header{ e, used_bits(), 0 } );
+            header& h = blocks.back();
+            if ( e < h.base || bit_field::width_of( e - h.base ) > h.width ){
+                repack_last( j, j, e );
+            }else{
+                ensure_bits( h.bit + ( j+1 ) * h.width );
+                bit_field::write( words.data(), h.bit + j*h.width, h.width, e - h.base );
+            }
+            ++size_now;
+        }
+
+        void pop_back( void ){
+            --size_now;
+            if ( size_now % B == 0 ) blocks.pop_back();
+        }
+
+        /**
+        * @brief troca o elemento i por x. Se x não cabe na base e largura do seu bloco: O(B) se é o último
+        *        bloco, O(n) (tudo é regravado) se não
+        */
+        void set( size_t i, T x ){
+            uint64_t e = Encoding::template encode<T>( x );
+            header& h = blocks[ i / B ];
+            if ( e >= h.base && bit_field::width_of( e - h.base ) <= h.width ){
+                bit_field::write( words.data(), h.bit + ( i % B ) * h.width, h.width, e - h.base );
+                return;
+            }
+            if ( i / B == blocks.size()-1 ){
+                repack_last( size_now - ( i / B ) * B, i % B, e );
+                return;
+            }
+            ::vector<T> all;
+            all.reserve( size_now );
+            for ( size_t k = 0; k < size_now; ++k ) all.push_back( k == i ? x : (*this)[k] );
+            clear();
+            for ( T v : all ) push_back( v );
+        }
+
+        /**
+        * @brief desempacota os elementos de [first, first+count) em out, bloco a bloco, com os kernels de simd
+        */
+        void decode( size_t first, size_t count, T * out ) const{
+            uint64_t buffer[ B ];
+            size_t i = first, last = first + count;
+            while ( i < last ){
+                const header& h = blocks[ i / B ];
+                size_t j = i % B;
+                size_t c = std::min( B - j, last - i );
+                simd::unpack_bits( words.data(), h.bit + j*h.width, h.width, c, h.base, buffer );
+                for ( size_t k = 0; k < c; ++k ) out[ i - first + k ] = Encoding::template decode<T>( buffer[k] );
+                i += c;
+            }
+        }
+
+        /** @brief chama f( elemento ) para todos, em ordem, desempacotando um bloco por vez */
+        template < typename F >
+        void for_each( F f ) const{
+            uint64_t buffer[ B ];
+            for ( size_t b = 0; b < blocks.size(); ++b ){
+                const header& h = blocks[b];
+                size_t c = std::min( B, size_now - b*B );
+                simd::unpack_bits( words.data(), h.bit, h.width, c, h.base, buffer );
+                for ( size_t k = 0; k < c; ++k ) f( Encoding::template decode<T>( buffer[k] ) );
+            }
+        }
+
+    private:
+        /*! @brief um bloco: base, primeiro bit e largura dos campos */
+        struct header {
+            uint64_t base;
+            size_t bit;
+            unsigned width;
+        };
+
+        ::vector<uint64_t> words; //!< campos de todos os blocos, em sequência, mais a palavra de folga
+        ::vector<header> blocks; //!< um cabeçalho por bloco
+        size_t size_now; //!< quantidade de elementos
+
+        /** @brief bits usados até o fim do último bloco */
+        size_t used_bits( void ) const{
+            if ( blocks.empty() ) return 0;
+            const header& h = blocks.back();
+            size_t in_last = size_now - ( blocks.size()-1 ) * B;
+            return h.bit + in_last * h.width;
+        }
+
+        void ensure_bits( size_t bits ){
+            size_t need = bit_field::words_for( bits );
+            while ( words.size() < need ) words.push_back( 0 );
+        }
+
+        /**
+        * @brief regrava o último bloco, com c elementos, com e na posição j (j == c acrescenta e): nova base e
+        *        nova largura
+        */
+        void repack_last( size_t c, size_t j, uint64_t e ){
+            header& h = blocks.back();
+            uint64_t values[ B ];
+            for ( size_t k = 0; k < c; ++k ) values[k] = h.base + bit_field::read( words.data(), h.bit + k*h.width, h.width );
+            values[j] = e;
+            size_t n = std::max( c, j+1 );
+            uint64_t low = e, high = e;
+            for ( size_t k = 0; k < n; ++k ){
+                low = std::min( low, values[k] );
+                high = std::max( high, values[k] );
+            }
+            h.base = low;
+            h.width = bit_field::width_of( high - low );
+            ensure_bits( h.bit + n * h.width );
+            for ( size_t k = 0; k < n; ++k ) bit_field::write( words.data(), h.bit + k*h.width, h.width, values[k] - low );
+        }
+};
+
+// fim [IV]
@@ -0,0 +1,486 @@
+/*! @file parallel.h
+    @brief algoritmos paralelos sobre o vector, executados num pool de threads com roubo de tarefas.
+
+    parallel_for_each, parallel_transform, parallel_reduce e parallel_sort dividem [0, size()) em blocos
+    alinhados à linha de cache e os entregam ao pool padrão (default_pool()), criado uma vez e reaproveitado.
+    Cada thread do pool tem a sua fila: empilha e desempilha pelo fim, e quando fica sem trabalho rouba do
+    começo da fila das outras. A thread que chama também executa tarefas enquanto espera.
+
+    A divisão em blocos depende do tamanho, do tipo e do alinhamento do endereço dos dados (as fronteiras caem
+    em linhas de cache), nunca da quantidade de threads: parallel_reduce combina os blocos sempre na mesma ordem
+    e dá o mesmo resultado para os mesmos dados com qualquer quantidade de threads, igual ao sequencial quando a
+    operação é associativa. Compile com -pthread.
+*/
+
+#ifndef ATOMIC
+#define ATOMIC
+#include <atomic>
+#endif
+
+#ifndef CONDITION_VARIABLE
+#define CONDITION_VARIABLE
+#include <condition_variable>
+#endif
+
+#ifndef CSTDINT
+#define CSTDINT
+#include <cstdint>
+#endif
+
+#ifndef DEQUE
+#define DEQUE
+#include <deque>
+#endif
+
+#ifndef EXCEPTION
+#define EXCEPTION
+#include <exception>
+#endif
+
+#ifndef FUNCTIONAL
+#define FUNCTIONAL
+#include <functional>
+#endif
+
+#ifndef MUTEX
+#define MUTEX
+#include <mutex>
+#endif
+
+#ifndef THREAD
+#define THREAD
+#include <thread>
+#endif
+
+#ifndef STD_VECTOR
+#define STD_VECTOR
+#include <vector>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+// [I] Pool de threads
+
+/*! @brief conjunto de tarefas que pode ser esperado; guarda a primeira exceção lançada por elas */
+class task_group {
+    public:
+        task_group() : pending{ 0 } { /* empty */ }
+
+        task_group( const task_group& ) = delete;
+        task_group& operator=( const task_group& ) = delete;
+
+    private:
+        friend class thread_pool;
+
+        std::atomic<size_t> pending; //!< tarefas ainda não terminadas
+        std::mutex error_mutex; //!< protege error
+        std::exception_ptr error; //!< primeira exceção lançada por uma tarefa
+};
+
+/*! @brief pool de threads com uma fila por thread e roubo de tarefas */
+class thread_pool {
+    public:
+        /**
+        * @brief cria o pool
+        * @param workers quantidade de threads auxiliares; a thread que espera (wait) também trabalha
+        */
+        explicit thread_pool( size_t workers = default_workers() )
+            : queues( workers+1 ),
+            queued{ 0 },
+            stop{ false }
+        {
+            for ( size_t i = 0; i < workers; ++i ){
+                threads.emplace_back( [this, i]{ work( i ); } );
+            }
+        }
+
+        thread_pool( const thread_pool& ) = delete;
+        thread_pool& operator=( const thread_pool& ) = delete;
+
+        /** @brief termina as threads; as tarefas já entregues precisam ter sido esperadas */
+        ~thread_pool(){
+            {
+                std::lock_guard<std::mutex> lock( sleep_mutex );
+                stop = true;
+            }
+            wake.notify_all();
+            for ( std::thread& t : threads ) t.join();
+        }
+
+        /** @brief quantidade de threads que executam tarefas, contando a que espera */
+        size_t concurrency( void ) const{
+            return threads.size() + 1;
+        }
+
+        /**
+        * @brief entrega uma tarefa ao pool
+        * @param group grupo ao qual a tarefa pertence
+        * @param task tarefa
+        */
+        void submit( task_group& group, std::function<void()> task ){
+            group.pending.fetch_add( 1, std::memory_order_relaxed );
+            queue& q = queues[ own_queue() ];
+            {
+                std::lock_guard<std::mutex> lock( q.mutex );
+                q.tasks.push_back( job{ &group, std::move(task) } );
+            }
+            queued.fetch_add( 1, std::memory_order_release );
+            {
+                // sincroniza com o teste do predicado em work(), para o aviso não se perder.
+                std::lock_guard<std::mutex> lock( sleep_mutex );
+            }
+            wake.notify_one();
+        }
+
+        /**
+        * @brief espera o grupo terminar, executando tarefas (de qualquer grupo) enquanto isso
+        * @param group grupo esperado
+        * @throw relança a primeira exceção lançada por uma tarefa do grupo
+        */
+        void wait( task_group& group ){
+            while ( group.pending.load( std::memory_order_acquire ) != 0 ){
+                if ( !run_one( own_queue() ) ) std::this_thread::yield();
+            }
+            if ( group.error ){
+                std::exception_ptr e = group.error;
+                group.error = nullptr;
+                std::rethrow_exception( e );
+            }
+        }
+
+        /** @brief threads auxiliares padrão: uma a menos que os núcleos, a thread que chama é a que falta */
+        static size_t default_workers( void ){
+            size_t cores = std::thread::hardware_concurrency();
+            return cores > 1 ? cores-1 : 0;
+        }
+
+    private:
+        /*! @brief tarefa e o grupo a avisar quando terminar */
+        struct job {
+            task_group * group;
+            std::function<void()> run;
+        };
+
+        /*! @brief fila de uma thread: a dona usa o fim, quem rouba usa o começo */
+        struct queue {
+            std::mutex mutex;
+            std::deque<job> tasks;
+        };
+
+        std::vector<queue> queues; //!< uma por thread auxiliar, a última é das threads de fora do pool
+        std::vector<std::thread> threads; //!< threads auxiliares
+        std::atomic<size_t> queued; //!< tarefas nas filas
+        std::mutex sleep_mutex; //!< protege o sono das threads ociosas
+        std::condition_variable wake; //!< acorda threads ociosas
+        bool stop; //!< pedido de término, protegido por sleep_mutex
+
+        /** @brief pool e fila da thread atual; threads de fora do pool usam a última fila */
+        static thread_pool *& current_pool( void ){
+            static thread_local thread_pool * pool = nullptr;
+            return pool;
+        }
+
+        static size_t& current_queue( void ){
+            static thread_local size_t index = 0;
+            return index;
+        }
+
+        size_t own_queue( void ) const{
+            return current_pool() == this ? current_queue() : queues.size()-1;
+        }
+
+        /**
+        * @brief tira uma tarefa da própria fila (pelo fim) ou rouba de outra (pelo começo)
+        * @return true se alguma tarefa foi executada
+        */
+        bool run_one( size_t self ){
+            job j;
+            if ( !take( self, j ) ) return false;
+            try{
+                j.run();
+            }catch ( ... ){
+                std::lock_guard<std::mutex> lock( j.group->error_mutex );
+                if ( !j.group->error ) j.group->error = std::current_exception();
+            }
+            j.group->pending.fetch_sub( 1, std::memory_order_release );
+            return true;
+        }
+
+        bool take( size_t self, job& j ){
+            if ( queued.load( std::memory_order_acquire ) == 0 ) return false;
+            {
+                queue& q = queues[ self ];
+                std::lock_guard<std::mutex> lock( q.mutex );
+                if ( !q.tasks.empty() ){
+                    j = std::move( q.tasks.back() );
+                    q.tasks.pop_back();
+                    queued.fetch_sub( 1, std::memory_order_relaxed );
+                    return true;
+                }
+            }
+            for ( size_t k = 1; k < queues.size(); ++k ){
+                queue& q = queues[ (self+k) % queues.size() ];
+                std::lock_guard<std::mutex> lock( q.mutex );
+                if ( !q.tasks.empty() ){
+                    j = std::move( q.tasks.front() );
+                    q.tasks.pop_front();
+                    queued.fetch_sub( 1, std::memory_order_relaxed );
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /** @brief laço de uma thread auxiliar: executa, rouba ou dorme até haver tarefa */
+        void work( size_t self ){
+            current_pool() = this;
+            current_queue() = self;
+            for (;;){
+                if ( run_one( self ) ) continue;
+                std::unique_lock<std::mutex> lock( sleep_mutex );
+                wake.wait( lock, [this]{ return stop || queued.load( std::memory_order_acquire ) != 0; } );
+                if ( stop ) return;
+            }
+        }
+};
+
+/** @brief pool usado pelos algoritmos paralelos, criado no primeiro uso */
+inline thread_pool& default_pool( void ){
+    static thread_pool pool;
+    return pool;
+}
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Divisão em blocos
+
+/**
+* @brief tamanho dos blocos para n elementos de 'elem_size' bytes: múltiplo da linha de cache (64 bytes),
+* com pelo menos ~16KB de dados e no máximo 256 blocos. Não depende da quantidade de threads.
+*/
+inline size_t parallel_chunk( size_t n, size_t elem_size ){
+    const size_t line = 64;
+    size_t per_line = ( elem_size >= line ) ? 1 : line / elem_size;
+    size_t chunk = ( 16384 / elem_size > per_line ) ? 16384 / elem_size : per_line;
+    if ( n / chunk > 256 ) chunk = ( n + 255 ) / 256;
+    return ( chunk + per_line - 1 ) / per_line * per_line;
+}
+
+/**
+* @brief começo de cada bloco de [p, p+n), mais n no fim. As fronteiras internas caem em endereços
+* alinhados a 64 bytes, para que dois blocos nunca escrevam na mesma linha de cache.
+*/
+template < typename T >
+std::vector<size_t> parallel_bounds( const T * p, size_t n ){
+    std::vector<size_t> bounds( 1, 0 );
+    size_t chunk = parallel_chunk( n, sizeof(T) );
+    size_t first = chunk;
+    if ( sizeof(T) < 64 && 64 % sizeof(T) == 0 ){
+        size_t misalign = ( reinterpret_cast<uintptr_t>( p ) % 64 ) / sizeof(T);
+        if ( misalign != 0 && misalign < chunk ) first = chunk - misalign;
+    }
+    for ( size_t b = first; b < n; b += chunk ) bounds.push_back( b );
+    bounds.push_back( n );
+    return bounds;
+}
+
+/**
+* @brief executa f(begin, end) para cada bloco de [p, p+n) no pool; blocos únicos rodam na própria thread
+* @param p começo dos dados, só usado para alinhar os blocos
+*/
+template < typename T, typename F >
+void parallel_blocks( const T * p, size_t n, F f, thread_pool& pool = default_pool() ){
+    std::vector<size_t> bounds = parallel_bounds( p, n );
+    if ( bounds.size() <= 2 || pool.concurrency() == 1 ){
+        for ( size_t k = 0; k+1 < bounds.size(); ++k ) f( bounds[k], bounds[k+1] );
+        return;
+    }
+    task_group group;
+    for ( size_t k = 0; k+1 < bounds.size(); ++k ){
+        size_t b = bounds[k], e = bounds[k+1];
+        pool.submit( group, [&f, b, e]{ f( b, e ); } );
+    }
+    pool.wait( group );
+}
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] Algoritmos
+
+/**
+* @brief aplica f a cada elemento
+* @param v vector
+* @param f função chamada com T&, de várias threads ao mesmo tempo
+*/
+template < typename T, typename A, typename G, typename F >
+void parallel_for_each( ::vector<T, A, G>& v, F f, thread_pool& pool = default_pool() ){
+    T * p = v.data();
+    parallel_blocks( p, v.size(), [p, &f]( size_t b, size_t e ){
+        for ( size_t i = b; i < e; ++i ) f( p[i] );
+    }, pool );
+}
+
+/**
+* @brief out[i] = f(in[i]) para i em [0, n)
+* @param in entrada
+* @param out saída, com espaço para n elementos já construídos
+* @param n quantidade de elementos
+* @param f função chamada com const T&
+*/
+template < typename T, typename U, typename F >
+void parallel_transform( const T * in, U * out, size_t n, F f, thread_pool& pool = default_pool() ){
+    // os blocos são alinhados pela saída, que é onde as threads escrevem.
+    parallel_blocks( static_cast<const U*>( out ), n, [in, out, &f]( size_t b, size_t e ){
+        for ( size_t i = b; i < e; ++i ) out[i] = f( in[i] );
+    }, pool );
+}
+
+/**
+* @brief out[i] = f(in[i]); out passa a ter o tamanho de in (com resize: novos elementos são U() antes de receber f)
+* @param in entrada
+* @param out saída
+* @param f função chamada com const T&
+*/
+template < typename T, typename A, typename G, typename U, typename A2, typename G2, typename F >
+void parallel_transform( const ::vector<T, A, G>& in, ::vector<U, A2, G2>& out, F f, thread_pool& pool = default_pool() ){
+    out.resize( in.size() );
+    parallel_transform( in.data(), out.data(), in.size(), f, pool );
+}
+
+/**
+* @brief v[i] = f(v[i])
+* @param v vector
+* @param f função chamada com const T&
+*/
+template < typename T, typename A, typename G, typename F >
+void parallel_transform( ::vector<T, A, G>& v, F f, thread_pool& pool = default_pool() ){
+    parallel_transform( v.data(), v.data(), v.size(), f, pool );
+}
+
+/**
+* @brief reduz [p, p+n) em blocos: partial[k] = block( começo, fim ) no pool e os resultados combinados em
+* ordem a partir de init. O resultado não depende das threads
+*/
+template < typename T, typename R, typename Block, typename Combine >
+R parallel_reduce_blocks( const T * p, size_t n, R init, Block block, Combine& combine, thread_pool& pool ){
+    if ( n == 0 ) return init;
+    std::vector<size_t> bounds = parallel_bounds( p, n );
+    size_t blocks = bounds.size()-1;
+    std::vector<R> partial( blocks, init );
+    auto reduce_block = [&bounds, &partial, &block]( size_t k ){ partial[k] = block( bounds[k], bounds[k+1] ); };
+    if ( blocks == 1 || pool.concurrency() == 1 ){
+        for ( size_t k = 0; k < blocks; ++k ) reduce_block( k );
+    }else{
+        task_group group;
+        for ( size_t k = 0; k < blocks; ++k ) pool.submit( group, [&reduce_block, k]{ reduce_block( k ); } );
+        pool.wait( group );
+    }
+    R acc = init;
+    for ( size_t k = 0; k < blocks; ++k ) acc = combine( acc, partial[k] );
+    return acc;
+}
+
+/**
+* @brief reduz os elementos com uma operação T op T (R == T): cada bloco é reduzido em ordem a partir do seu
+* primeiro elemento e os resultados dos blocos são combinados em ordem a partir de init, com a mesma op.
+* Para acumular T num R diferente (ex: soma dos quadrados em long long), use a forma com identity e combine
+* @param v vector
+* @param init valor inicial
+* @param op operação binária sobre T, associativa para o resultado ser igual ao std::accumulate
+* @return init op v[0] op ... op v[n-1]
+*/
+template < typename T, typename A, typename G, typename R, typename Op >
+R parallel_reduce( const ::vector<T, A, G>& v, R init, Op op, thread_pool& pool = default_pool() ){
+    static_assert( std::is_same<T, R>::value, "parallel_reduce(v, init, op): op também combina os blocos, precisa ser T op T; "
+                                              "use parallel_reduce(v, identity, op, combine)" );
+    const T * p = v.data();
+    auto block = [p, &op]( size_t b, size_t e ){
+        R acc = p[b];
+        for ( size_t i = b+1; i < e; ++i ) acc = op( acc, p[i] );
+        return acc;
+    };
+    return parallel_reduce_blocks( p, v.size(), init, block, op, pool );
+}
+
+/**
+* @brief acumula os elementos com op(R, const T&) e junta os blocos com combine(R, R): cada bloco parte de
+* identity e os resultados dos blocos são combinados em ordem a partir de identity. O resultado não depende
+* das threads
+* @param v vector
+* @param identity elemento neutro de combine (ex: 0 para soma), ponto de partida de cada bloco
+* @param op acumulação, ex: []( long long a, int x ){ return a + (long long) x*x; }
+* @param combine junção associativa de dois resultados parciais, ex: std::plus<long long>()
+* @return o mesmo que std::accumulate( v, identity, op ) quando op(a, x) == combine(a, op(identity, x))
+*/
+template < typename T, typename A, typename G, typename R, typename Op, typename Combine,
+           typename = typename std::enable_if< !std::is_same< typename std::decay<Combine>::type, thread_pool >::value >::type >
+R parallel_reduce( const ::vector<T, A, G>& v, R identity, Op op, Combine combine, thread_pool& pool = default_pool() ){
+    const T * p = v.data();
+    auto block = [p, &identity, &op]( size_t b, size_t e ){
+        R acc = identity;
+        for ( size_t i = b; i < e; ++i ) acc = op( acc, p[i] );
+        return acc;
+    };
+    return parallel_reduce_blocks( p, v.size(), identity, block, combine, pool );
+}
+
+/**
+* @brief soma dos elementos em R, a partir de init, ver parallel_reduce
+*/
+template < typename T, typename A, typename G, typename R >
+R parallel_reduce( const ::vector<T, A, G>& v, R init, thread_pool& pool = default_pool() ){
+    return init + parallel_reduce( v, R(), std::plus<R>(), std::plus<R>(), pool );
+}
+
+/**
+* @brief ordena o vector: os blocos são ordenados em paralelo e depois intercalados aos pares, nível a nível
+* @param v vector
+* @param comp comparação, como no std::sort
+*/
+template < typename T, typename A, typename G, typename Compare >
+void parallel_sort( ::vector<T, A, G>& v, Compare comp, thread_pool& pool = default_pool() ){
+    T * p = v.data();
+    std::vector<size_t> bounds = parallel_bounds( static_cast<const T*>( p ), v.size() );
+    if ( bounds.size() <= 2 || pool.concurrency() == 1 ){
+        std::sort( p, p+v.size(), comp );
+        return;
+    }
+
+    task_group group;
+    for ( size_t k = 0; k+1 < bounds.size(); ++k ){
+        size_t b = bounds[k], e = bounds[k+1];
+        pool.submit( group, [p, b, e, &comp]{ std::sort( p+b, p+e, comp ); } );
+    }
+    pool.wait( group );
+
+    // cada nível intercala pares de trechos vizinhos já ordenados, até sobrar um só.
+    while ( bounds.size() > 2 ){
+        std::vector<size_t> next( 1, 0 );
+        for ( size_t k = 0; k+1 < bounds.size(); k += 2 ){
+            if ( k+2 < bounds.size() ){
+                size_t b = bounds[k], m = bounds[k+1], e = bounds[k+2];
+                pool.submit( group, [p, b, m, e, &comp]{ std::inplace_merge( p+b, p+m, p+e, comp ); } );
+                next.push_back( e );
+            }else{
+                next.push_back( bounds[k+1] );
+            }
+        }
+        pool.wait( group );
+        bounds.swap( next );
+    }
+}
+
+/** @brief ordena o vector com operator<, ver parallel_sort */
+template < typename T, typename A, typename G >
+void parallel_sort( ::vector<T, A, G>& v, thread_pool& pool = default_pool() ){
+    parallel_sort( v, std::less<T>(), pool );
+}
+
+// fim [III]
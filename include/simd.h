@@ -0,0 +1,558 @@
+/*! @file simd.h
+    @brief busca e redução vetorizadas (SSE2/AVX2/AVX-512) sobre a memória contígua do vector.
+
+    find, count, contains, min_element, max_element, sum e dot para vector<int>, vector<float> e vector<double>
+    (ou ponteiro + tamanho). O conjunto de instruções é escolhido em tempo de execução pelo CPUID; outros tipos,
+    ou CPUs fora do x86, usam os laços de simd::scalar. Os resultados são idênticos aos de simd::scalar.
+    - find/min_element/max_element devolvem o índice, ou size() se não houver
+    - sum/dot de int acumulam em long long; de float/double usam 16 lanes (i % 16) somadas aos pares no fim,
+      a mesma ordem em todos os caminhos
+    - min_element/max_element de float/double supõem que não há NaN
+*/
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef TYPE_TRAITS
+#define TYPE_TRAITS
+#include <type_traits>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define EDBI_SIMD_X86
+// o GCC 12 acusa '__Y' não inicializado dentro dos _mm512_undefined_* ao inlinar com '#pragma GCC target';
+// o aviso é do próprio cabeçalho, então é silenciado só nele.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#ifndef IMMINTRIN_H
+#define IMMINTRIN_H
+#include <immintrin.h>
+#endif
+#pragma GCC diagnostic pop
+#endif
+
+namespace simd {
+
+/*! @brief conjuntos de instruções, do menor para o maior */
+enum class isa { scalar, sse2, avx2, avx512 };
+
+/*! @brief tipos com kernels vetorizados */
+template < typename T > struct supported : std::false_type {};
+template <> struct supported<int> : std::true_type {};
+template <> struct supported<float> : std::true_type {};
+template <> struct supported<double> : std::true_type {};
+
+// [I] Versões escalares, referência dos resultados
+
+namespace scalar {
+
+    /*! @brief tipo do resultado de sum/dot: long long para int, o próprio T para os demais */
+    template < typename T > struct sum_type { typedef T type; };
+    template <> struct sum_type<int> { typedef long long type; };
+
+    /** @brief soma as 16 lanes aos pares: 8 em 8, 4 em 4, 2 em 2, 1 em 1 */
+    template < typename S >
+    S fold16( S * lanes ){
+        for ( size_t w = 8; w > 0; w /= 2 ){
+            for ( size_t j = 0; j < w; ++j ) lanes[j] += lanes[j+w];
+        }
+        return lanes[0];
+    }
+
+    /** @brief índice do primeiro elemento igual a v, ou n */
+    template < typename T >
+    size_t find( const T * p, size_t n, const T& v ){
+        for ( size_t i = 0; i < n; ++i ) if ( p[i] == v ) return i;
+        return n;
+    }
+
+    /** @brief quantidade de elementos iguais a v */
+    template < typename T >
+    size_t count( const T * p, size_t n, const T& v ){
+        size_t c = 0;
+        for ( size_t i = 0; i < n; ++i ) c += ( p[i] == v );
+        return c;
+    }
+
+    /** @brief índice do primeiro menor elemento, ou n se vazio */
+    template < typename T >
+    size_t min_element( const T * p, size_t n ){
+        if ( n == 0 ) return 0;
+        size_t best = 0;
+        for ( size_t i = 1; i < n; ++i ) if ( p[i] < p[best] ) best = i;
+        return best;
+    }
+
+    /** @brief índice do primeiro maior elemento, ou n se vazio */
+    template < typename T >
+    size_t max_element( const T * p, size_t n ){
+        if ( n == 0 ) return 0;
+        size_t best = 0;
+        for ( size_t i = 1; i < n; ++i ) if ( p[best] < p[i] ) best = i;
+        return best;
+    }
+
+    /** @brief soma dos elementos, em 16 lanes */
+    template < typename T >
+    typename sum_type<T>::type sum( const T * p, size_t n ){
+        typedef typename sum_type<T>::type S;
+        S lanes[16];
+        for ( size_t k = 0; k < 16; ++k ) lanes[k] = S();
+        for ( size_t i = 0; i < n; ++i ) lanes[i%16] += S( p[i] );
+        return fold16( lanes );
+    }
+
+    /** @brief produto interno, em 16 lanes */
+    template < typename T >
+    typename sum_type<T>::type dot( const T * a, const T * b, size_t n ){
+        typedef typename sum_type<T>::type S;
+        S lanes[16];
+        for ( size_t k = 0; k < 16; ++k ) lanes[k] = S();
+        for ( size_t i = 0; i < n; ++i ) lanes[i%16] += S( a[i] ) * S( b[i] );
+        return fold16( lanes );
+    }
+
+} // namespace scalar
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Kernels por conjunto de instruções
+
+#ifdef EDBI_SIMD_X86
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+namespace sse2 {
+
+    template < typename T > struct traits;
+
+    template <> struct traits<int> {
+        typedef __m128i reg;
+        typedef __m128i wide;
+        static const size_t W = 4;
+        static reg load( const int * p ){ return _mm_loadu_si128( (const __m128i*) p ); }
+        static reg set1( int v ){ return _mm_set1_epi32( v ); }
+        static void store( int * p, reg r ){ _mm_storeu_si128( (__m128i*) p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( a, b ) ) ); }
+        static reg min( reg a, reg b ){ reg m = _mm_cmplt_epi32( a, b ); return _mm_or_si128( _mm_and_si128( m, a ), _mm_andnot_si128( m, b ) ); }
+        static reg max( reg a, reg b ){ reg m = _mm_cmpgt_epi32( a, b ); return _mm_or_si128( _mm_and_si128( m, a ), _mm_andnot_si128( m, b ) ); }
+        static wide wzero( void ){ return _mm_setzero_si128(); }
+        static wide widen_add( wide acc, reg x ){
+            reg sign = _mm_srai_epi32( x, 31 );
+            acc = _mm_add_epi64( acc, _mm_unpacklo_epi32( x, sign ) );
+            return _mm_add_epi64( acc, _mm_unpackhi_epi32( x, sign ) );
+        }
+        /** @brief produto com sinal das lanes 0 e 2 em 64 bits: SSE2 só multiplica sem sinal, corrige com os sinais */
+        static wide mul_even( reg a, reg b ){
+            reg prod = _mm_mul_epu32( a, b );
+            reg corr = _mm_add_epi32( _mm_and_si128( _mm_srai_epi32( a, 31 ), b ), _mm_and_si128( _mm_srai_epi32( b, 31 ), a ) );
+            return _mm_sub_epi64( prod, _mm_slli_epi64( corr, 32 ) );
+        }
+        static wide widen_mul_add( wide acc, reg a, reg b ){
+            acc = _mm_add_epi64( acc, mul_even( a, b ) );
+            return _mm_add_epi64( acc, mul_even( _mm_srli_epi64( a, 32 ), _mm_srli_epi64( b, 32 ) ) );
+        }
+        static long long wsum( wide acc ){ long long l[2]; _mm_storeu_si128( (__m128i*) l, acc ); return l[0] + l[1]; }
+    };
+
+    template <> struct traits<float> {
+        typedef __m128 reg;
+        static const size_t W = 4;
+        static reg load( const float * p ){ return _mm_loadu_ps( p ); }
+        static reg set1( float v ){ return _mm_set1_ps( v ); }
+        static void store( float * p, reg r ){ _mm_storeu_ps( p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return _mm_movemask_ps( _mm_cmpeq_ps( a, b ) ); }
+        static reg min( reg a, reg b ){ return _mm_min_ps( a, b ); }
+        static reg max( reg a, reg b ){ return _mm_max_ps( a, b ); }
+        static reg add( reg a, reg b ){ return _mm_add_ps( a, b ); }
+        static reg mul( reg a, reg b ){ return _mm_mul_ps( a, b ); }
+    };
+
+    template <> struct traits<double> {
+        typedef __m128d reg;
+        static const size_t W = 2;
+        static reg load( const double * p ){ return _mm_loadu_pd( p ); }
+        static reg set1( double v ){ return _mm_set1_pd( v ); }
+        static void store( double * p, reg r ){ _mm_storeu_pd( p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return _mm_movemask_pd( _mm_cmpeq_pd( a, b ) ); }
+        static reg min( reg a, reg b ){ return _mm_min_pd( a, b ); }
+        static reg max( reg a, reg b ){ return _mm_max_pd( a, b ); }
+        static reg add( reg a, reg b ){ return _mm_add_pd( a, b ); }
+        static reg mul( reg a, reg b ){ return _mm_mul_pd( a, b ); }
+    };
+
+#include "simd_kernels.h"
+
+} // namespace sse2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2 {
+
+    template < typename T > struct traits;
+
+    template <> struct traits<int> {
+        typedef __m256i reg;
+        typedef __m256i wide;
+        static const size_t W = 8;
+        static reg load( const int * p ){ return _mm256_loadu_si256( (const __m256i*) p ); }
+        static reg set1( int v ){ return _mm256_set1_epi32( v ); }
+        static void store( int * p, reg r ){ _mm256_storeu_si256( (__m256i*) p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return (unsigned) _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( a, b ) ) ); }
+        static reg min( reg a, reg b ){ return _mm256_min_epi32( a, b ); }
+        static reg max( reg a, reg b ){ return _mm256_max_epi32( a, b ); }
+        static wide wzero( void ){ return _mm256_setzero_si256(); }
+        static wide lo( reg x ){ return _mm256_cvtepi32_epi64( _mm256_castsi256_si128( x ) ); }
+        static wide hi( reg x ){ return _mm256_cvtepi32_epi64( _mm256_extracti128_si256( x, 1 ) ); }
+        static wide widen_add( wide acc, reg x ){
+            return _mm256_add_epi64( _mm256_add_epi64( acc, lo( x ) ), hi( x ) );
+        }
+        static wide widen_mul_add( wide acc, reg a, reg b ){
+            acc = _mm256_add_epi64( acc, _mm256_mul_epi32( lo( a ), lo( b ) ) );
+            return _mm256_add_epi64( acc, _mm256_mul_epi32( hi( a ), hi( b ) ) );
+        }
+        static long long wsum( wide acc ){ long long l[4]; _mm256_storeu_si256( (__m256i*) l, acc ); return l[0] + l[1] + l[2] + l[3]; }
+    };
+
+    template <> struct traits<float> {
+        typedef __m256 reg;
+        static const size_t W = 8;
+        static reg load( const float * p ){ return _mm256_loadu_ps( p ); }
+        static reg set1( float v ){ return _mm256_set1_ps( v ); }
+        static void store( float * p, reg r ){ _mm256_storeu_ps( p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return (unsigned) _mm256_movemask_ps( _mm256_cmp_ps( a, b, _CMP_EQ_OQ ) ); }
+        static reg min( reg a, reg b ){ return _mm256_min_ps( a, b ); }
+        static reg max( reg a, reg b ){ return _mm256_max_ps( a, b ); }
+        static reg add( reg a, reg b ){ return _mm256_add_ps( a, b ); }
+        static reg mul( reg a, reg b ){ return _mm256_mul_ps( a, b ); }
+    };
+
+    template <> struct traits<double> {
+        typedef __m256d reg;
+        static const size_t W = 4;
+        static reg load( const double * p ){ return _mm256_loadu_pd( p ); }
+        static reg set1( double v ){ return _mm256_set1_pd( v ); }
+        static void store( double * p, reg r ){ _mm256_storeu_pd( p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return (unsigned) _mm256_movemask_pd( _mm256_cmp_pd( a, b, _CMP_EQ_OQ ) ); }
+        static reg min( reg a, reg b ){ return _mm256_min_pd( a, b ); }
+        static reg max( reg a, reg b ){ return _mm256_max_pd( a, b ); }
+        static reg add( reg a, reg b ){ return _mm256_add_pd( a, b ); }
+        static reg mul( reg a, reg b ){ return _mm256_mul_pd( a, b ); }
+    };
+
+#include "simd_kernels.h"
+
+} // namespace avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace avx512 {
+
+    template < typename T > struct traits;
+
+    template <> struct traits<int> {
+        typedef __m512i reg;
+        typedef __m512i wide;
+        static const size_t W = 16;
+        static reg load( const int * p ){ return _mm512_loadu_si512( p ); }
+        static reg set1( int v ){ return _mm512_set1_epi32( v ); }
+        static void store( int * p, reg r ){ _mm512_storeu_si512( p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return _mm512_cmpeq_epi32_mask( a, b ); }
+        static reg min( reg a, reg b ){ return _mm512_min_epi32( a, b ); }
+        static reg max( reg a, reg b ){ return _mm512_max_epi32( a, b ); }
+        static wide wzero( void ){ return _mm512_setzero_si512(); }
+        static wide lo( reg x ){ return _mm512_cvtepi32_epi64( _mm512_extracti64x4_epi64( x, 0 ) ); }
+        static wide hi( reg x ){ return _mm512_cvtepi32_epi64( _mm512_extracti64x4_epi64( x, 1 ) ); }
+        static wide widen_add( wide acc, reg x ){
+            return _mm512_add_epi64( _mm512_add_epi64( acc, lo( x ) ), hi( x ) );
+        }
+        static wide widen_mul_add( wide acc, reg a, reg b ){
+            acc = _mm512_add_epi64( acc, _mm512_mul_epi32( lo( a ), lo( b ) ) );
+            return _mm512_add_epi64( acc, _mm512_mul_epi32( hi( a ), hi( b ) ) );
+        }
+        static long long wsum( wide acc ){ return _mm512_reduce_add_epi64( acc ); }
+    };
+
+    template <> struct traits<float> {
+        typedef __m512 reg;
+        static const size_t W = 16;
+        static reg load( const float * p ){ return _mm512_loadu_ps( p ); }
+        static reg set1( float v ){ return _mm512_set1_ps( v ); }
+        static void store( float * p, reg r ){ _mm512_storeu_ps( p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return _mm512_cmp_ps_mask( a, b, _CMP_EQ_OQ ); }
+        static reg min( reg a, reg b ){ return _mm512_min_ps( a, b ); }
+        static reg max( reg a, reg b ){ return _mm512_max_ps( a, b ); }
+        static reg add( reg a, reg b ){ return _mm512_add_ps( a, b ); }
+        static reg mul( reg a, reg b ){ return _mm512_mul_ps( a, b ); }
+    };
+
+    template <> struct traits<double> {
+        typedef __m512d reg;
+        static const size_t W = 8;
+        static reg load( const double * p ){ return _mm512_loadu_pd( p ); }
+        static reg set1( double v ){ return _mm512_set1_pd( v ); }
+        static void store( double * p, reg r ){ _mm512_storeu_pd( p, r ); }
+        static unsigned long long eq( reg a, reg b ){ return _mm512_cmp_pd_mask( a, b, _CMP_EQ_OQ ); }
+        static reg min( reg a, reg b ){ return _mm512_min_pd( a, b ); }
+        static reg max( reg a, reg b ){ return _mm512_max_pd( a, b ); }
+        static reg add( reg a, reg b ){ return _mm512_add_pd( a, b ); }
+        static reg mul( reg a, reg b ){ return _mm512_mul_pd( a, b ); }
+    };
+
+#include "simd_kernels.h"
+
+} // namespace avx512
+#pragma GCC pop_options
+
+#endif
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] Escolha do conjunto de instruções
+
+/** @brief maior conjunto de instruções suportado pela CPU (CPUID) */
+inline isa detected( void ){
+#ifdef EDBI_SIMD_X86
+    static const isa level = []{
+        __builtin_cpu_init();
+        if ( __builtin_cpu_supports( "avx512f" ) ) return isa::avx512;
+        if ( __builtin_cpu_supports( "avx2" ) ) return isa::avx2;
+        if ( __builtin_cpu_supports( "sse2" ) ) return isa::sse2;
+        return isa::scalar;
+    }();
+    return level;
+#else
+    return isa::scalar;
+#endif
+}
+
+/** @brief conjunto de instruções em uso, por padrão o detectado */
+inline isa& active_ref( void ){
+    static isa level = detected();
+    return level;
+}
+
+inline isa active( void ){
+    return active_ref();
+}
+
+/**
+* @brief limita o conjunto de instruções usado (ex: para comparar caminhos); nunca passa do detectado
+* @param level conjunto desejado
+*/
+inline void force( isa level ){
+    active_ref() = ( level < detected() ) ? level : detected();
+}
+
+// fim [III]
+
+//---------------------------------------------------------------------------------------------------
+
+// [IV] Interface: ponteiro + tamanho
+
+// Os tipos sem kernel (supported<T> falso) vão direto para simd::scalar; a escolha é feita por tag
+// (std::true_type/std::false_type) para que os kernels só sejam instanciados para int, float e double.
+
+template < typename T >
+size_t find( const T * p, size_t n, const T& value, std::false_type ){
+    return scalar::find( p, n, value );
+}
+
+template < typename T >
+size_t find( const T * p, size_t n, const T& value, std::true_type ){
+    switch ( active() ){
+#ifdef EDBI_SIMD_X86
+        case isa::avx512: return avx512::find( p, n, value );
+        case isa::avx2: return avx2::find( p, n, value );
+        case isa::sse2: return sse2::find( p, n, value );
+#endif
+        default: return scalar::find( p, n, value );
+    }
+}
+
+/** @brief índice do primeiro elemento igual a value, ou n */
+template < typename T >
+size_t find( const T * p, size_t n, const T& value ){
+    return find( p, n, value, supported<T>() );
+}
+
+template < typename T >
+size_t count( const T * p, size_t n, const T& value, std::false_type ){
+    return scalar::count( p, n, value );
+}
+
+template < typename T >
+size_t count( const T * p, size_t n, const T& value, std::true_type ){
+    switch ( active() ){
+#ifdef EDBI_SIMD_X86
+        case isa::avx512: return avx512::count( p, n, value );
+        case isa::avx2: return avx2::count( p, n, value );
+        case isa::sse2: return sse2::count( p, n, value );
+#endif
+        default: return scalar::count( p, n, value );
+    }
+}
+
+/** @brief quantidade de elementos iguais a value */
+template < typename T >
+size_t count( const T * p, size_t n, const T& value ){
+    return count( p, n, value, supported<T>() );
+}
+
+/** @brief true se algum elemento é igual a value */
+template < typename T >
+bool contains( const T * p, size_t n, const T& value ){
+    return find( p, n, value ) != n;
+}
+
+template < typename T >
+size_t min_element( const T * p, size_t n, std::false_type ){
+    return scalar::min_element( p, n );
+}
+
+template < typename T >
+size_t min_element( const T * p, size_t n, std::true_type ){
+    switch ( active() ){
+#ifdef EDBI_SIMD_X86
+        case isa::avx512: return avx512::min_element( p, n );
+        case isa::avx2: return avx2::min_element( p, n );
+        case isa::sse2: return sse2::min_element( p, n );
+#endif
+        default: return scalar::min_element( p, n );
+    }
+}
+
+/** @brief índice do primeiro menor elemento, ou n se vazio */
+template < typename T >
+size_t min_element( const T * p, size_t n ){
+    return min_element( p, n, supported<T>() );
+}
+
+template < typename T >
+size_t max_element( const T * p, size_t n, std::false_type ){
+    return scalar::max_element( p, n );
+}
+
+template < typename T >
+size_t max_element( const T * p, size_t n, std::true_type ){
+    switch ( active() ){
+#ifdef EDBI_SIMD_X86
+        case isa::avx512: return avx512::max_element( p, n );
+        case isa::avx2: return avx2::max_element( p, n );
+        case isa::sse2: return sse2::max_element( p, n );
+#endif
+        default: return scalar::max_element( p, n );
+    }
+}
+
+/** @brief índice do primeiro maior elemento, ou n se vazio */
+template < typename T >
+size_t max_element( const T * p, size_t n ){
+    return max_element( p, n, supported<T>() );
+}
+
+template < typename T >
+typename scalar::sum_type<T>::type sum( const T * p, size_t n, std::false_type ){
+    return scalar::sum( p, n );
+}
+
+template < typename T >
+typename scalar::sum_type<T>::type sum( const T * p, size_t n, std::true_type ){
+    switch ( active() ){
+#ifdef EDBI_SIMD_X86
+        case isa::avx512: return avx512::sum( p, n );
+        case isa::avx2: return avx2::sum( p, n );
+        case isa::sse2: return sse2::sum( p, n );
+#endif
+        default: return scalar::sum( p, n );
+    }
+}
+
+/** @brief soma dos elementos (long long para int) */
+template < typename T >
+typename scalar::sum_type<T>::type sum( const T * p, size_t n ){
+    return sum( p, n, supported<T>() );
+}
+
+template < typename T >
+typename scalar::sum_type<T>::type dot( const T * a, const T * b, size_t n, std::false_type ){
+    return scalar::dot( a, b, n );
+}
+
+template < typename T >
+typename scalar::sum_type<T>::type dot( const T * a, const T * b, size_t n, std::true_type ){
+    switch ( active() ){
+#ifdef EDBI_SIMD_X86
+        case isa::avx512: return avx512::dot( a, b, n );
+        case isa::avx2: return avx2::dot( a, b, n );
+        case isa::sse2: return sse2::dot( a, b, n );
+#endif
+        default: return scalar::dot( a, b, n );
+    }
+}
+
+/** @brief produto interno de a e b, ambos com n elementos (long long para int) */
+template < typename T >
+typename scalar::sum_type<T>::type dot( const T * a, const T * b, size_t n ){
+    return dot( a, b, n, supported<T>() );
+}
+
+// fim [IV]
+
+//---------------------------------------------------------------------------------------------------
+
+// [V] Interface: vector
+
+template < typename T, typename A, typename G >
+size_t find( const ::vector<T, A, G>& v, const typename ::vector<T, A, G>::value_type& value ){
+    return find( v.data(), v.size(), value );
+}
+
+template < typename T, typename A, typename G >
+size_t count( const ::vector<T, A, G>& v, const typename ::vector<T, A, G>::value_type& value ){
+    return count( v.data(), v.size(), value );
+}
+
+template < typename T, typename A, typename G >
+bool contains( const ::vector<T, A, G>& v, const typename ::vector<T, A, G>::value_type& value ){
+    return contains( v.data(), v.size(), value );
+}
+
+template < typename T, typename A, typename G >
+size_t min_element( const ::vector<T, A, G>& v ){
+    return min_element( v.data(), v.size() );
+}
+
+template < typename T, typename A, typename G >
+size_t max_element( const ::vector<T, A, G>& v ){
+    return max_element( v.data(), v.size() );
+}
+
+template < typename T, typename A, typename G >
+typename scalar::sum_type<T>::type sum( const ::vector<T, A, G>& v ){
+    return sum( v.data(), v.size() );
+}
+
+/** @brief produto interno; usa o menor dos dois tamanhos */
+template < typename T, typename A, typename G, typename A2, typename G2 >
+typename scalar::sum_type<T>::type dot( const ::vector<T, A, G>& a, const ::vector<T, A2, G2>& b ){
+    return dot( a.data(), b.data(), std::min( a.size(), b.size() ) );
+}
+
+// fim [V]
+
+} // namespace simd
@@ -0,0 +1,153 @@
+/*! @file simd_kernels.h
+    @brief kernels de busca e redução escritos uma vez sobre um traits de registrador.
+
+    Este arquivo NÃO tem guarda de inclusão: simd.h o inclui uma vez dentro de cada namespace de conjunto de
+    instruções (sse2, avx2, avx512), com o '#pragma GCC target' correspondente ativo. Em cada namespace deve
+    existir 'traits<T>' para int, float e double com:
+    - reg e W (elementos por registrador)
+    - load, set1, store, eq (máscara de bits das lanes iguais), min, max
+    - float/double: add, mul
+    - int: wide, wzero, widen_add, widen_mul_add e wsum (acumuladores de 64 bits)
+    Os resultados são idênticos aos de simd::scalar: as somas de ponto flutuante usam as mesmas 16 lanes.
+*/
+
+/** @brief índice do primeiro elemento igual a v, ou n */
+template < typename T >
+size_t find( const T * p, size_t n, T v ){
+    typedef traits<T> R;
+    typename R::reg needle = R::set1( v );
+    size_t i = 0;
+    for ( ; i + R::W <= n; i += R::W ){
+        unsigned long long m = R::eq( R::load( p+i ), needle );
+        if ( m != 0 ) return i + __builtin_ctzll( m );
+    }
+    for ( ; i < n; ++i ){
+        if ( p[i] == v ) return i;
+    }
+    return n;
+}
+
+/** @brief quantidade de elementos iguais a v */
+template < typename T >
+size_t count( const T * p, size_t n, T v ){
+    typedef traits<T> R;
+    typename R::reg needle = R::set1( v );
+    size_t c = 0, i = 0;
+    for ( ; i + R::W <= n; i += R::W ){
+        c += __builtin_popcountll( R::eq( R::load( p+i ), needle ) );
+    }
+    for ( ; i < n; ++i ){
+        c += ( p[i] == v );
+    }
+    return c;
+}
+
+/** @brief índice do primeiro menor elemento, ou n se vazio */
+template < typename T >
+size_t min_element( const T * p, size_t n ){
+    typedef traits<T> R;
+    if ( n < R::W ) return scalar::min_element( p, n );
+    typename R::reg r = R::load( p );
+    size_t i = R::W;
+    for ( ; i + R::W <= n; i += R::W ){
+        r = R::min( r, R::load( p+i ) );
+    }
+    T lanes[ R::W ];
+    R::store( lanes, r );
+    T best = lanes[0];
+    for ( size_t k = 1; k < R::W; ++k ) if ( lanes[k] < best ) best = lanes[k];
+    for ( ; i < n; ++i ) if ( p[i] < best ) best = p[i];
+    return find( p, n, best );
+}
+
+/** @brief índice do primeiro maior elemento, ou n se vazio */
+template < typename T >
+size_t max_element( const T * p, size_t n ){
+    typedef traits<T> R;
+    if ( n < R::W ) return scalar::max_element( p, n );
+    typename R::reg r = R::load( p );
+    size_t i = R::W;
+    for ( ; i + R::W <= n; i += R::W ){
+        r = R::max( r, R::load( p+i ) );
+    }
+    T lanes[ R::W ];
+    R::store( lanes, r );
+    T best = lanes[0];
+    for ( size_t k = 1; k < R::W; ++k ) if ( best < lanes[k] ) best = lanes[k];
+    for ( ; i < n; ++i ) if ( best < p[i] ) best = p[i];
+    return find( p, n, best );
+}
+
+/** @brief soma em ponto flutuante: 16 lanes, a lane k recebe os elementos de índice i % 16 == k */
+template < typename T >
+T sum( const T * p, size_t n, std::false_type ){
+    typedef traits<T> R;
+    const size_t regs = 16 / R::W;
+    typename R::reg acc[ 16 / R::W ];
+    for ( size_t k = 0; k < regs; ++k ) acc[k] = R::set1( T(0) );
+    size_t i = 0;
+    for ( ; i + 16 <= n; i += 16 ){
+        for ( size_t k = 0; k < regs; ++k ) acc[k] = R::add( acc[k], R::load( p+i+k*R::W ) );
+    }
+    T lanes[16];
+    for ( size_t k = 0; k < regs; ++k ) R::store( lanes+k*R::W, acc[k] );
+    for ( ; i < n; ++i ) lanes[i%16] += p[i];
+    return scalar::fold16( lanes );
+}
+
+/** @brief soma de inteiros, acumulada em 64 bits */
+template < typename T >
+long long sum( const T * p, size_t n, std::true_type ){
+    typedef traits<T> R;
+    typename R::wide acc = R::wzero();
+    size_t i = 0;
+    for ( ; i + R::W <= n; i += R::W ){
+        acc = R::widen_add( acc, R::load( p+i ) );
+    }
+    long long s = R::wsum( acc );
+    for ( ; i < n; ++i ) s += p[i];
+    return s;
+}
+
+template < typename T >
+typename scalar::sum_type<T>::type sum( const T * p, size_t n ){
+    return sum( p, n, std::is_integral<T>() );
+}
+
+/** @brief produto interno em ponto flutuante, nas mesmas 16 lanes da soma */
+template < typename T >
+T dot( const T * a, const T * b, size_t n, std::false_type ){
+    typedef traits<T> R;
+    const size_t regs = 16 / R::W;
+    typename R::reg acc[ 16 / R::W ];
+    for ( size_t k = 0; k < regs; ++k ) acc[k] = R::set1( T(0) );
+    size_t i = 0;
+    for ( ; i + 16 <= n; i += 16 ){
+        for ( size_t k = 0; k < regs; ++k ){
+            acc[k] = R::add( acc[k], R::mul( R::load( a+i+k*R::W ), R::load( b+i+k*R::W ) ) );
+        }
+    }
+    T lanes[16];
+    for ( size_t k = 0; k < regs; ++k ) R::store( lanes+k*R::W, acc[k] );
+    for ( ; i < n; ++i ) lanes[i%16] += a[i]*b[i];
+    return scalar::fold16( lanes );
+}
+
+/** @brief produto interno de inteiros, acumulado em 64 bits */
+template < typename T >
+long long dot( const T * a, const T * b, size_t n, std::true_type ){
+    typedef traits<T> R;
+    typename R::wide acc = R::wzero();
+    size_t i = 0;
+    for ( ; i + R::W <= n; i += R::W ){
+        acc = R::widen_mul_add( acc, R::load( a+i ), R::load( b+i ) );
+    }
+    long long s = R::wsum( acc );
+    for ( ; i < n; ++i ) s += (long long) a[i] * b[i];
+    return s;
+}
+
+template < typename T >
+typename scalar::sum_type<T>::type dot( const T * a, const T * b, size_t n ){
+    return dot( a, b, n, std::is_integral<T>() );
+}
@@ -0,0 +1,177 @@
+/*! @file small_vector.h
+    @brief vector que guarda os primeiros elementos dentro do próprio objeto.
+*/
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+/*! @brief espaço interno do small_vector: memória bruta para N elementos. Fica numa base anterior ao vector, então
+    é criado antes dele e some depois dele; o ~vector destrói os elementos guardados aqui enquanto a memória existe
+*/
+template < typename T, size_t N >
+struct small_vector_buffer {
+    alignas(T) unsigned char buffer[ N*sizeof(T) ]; //!< Espaço interno, memória bruta para N elementos.
+};
+
+/*! @brief vector com espaço interno para N elementos: enquanto size() <= N nenhuma memória é alocada,
+    ao passar disso os elementos vão para a memória do alocador como num vector normal.
+    Oferece a mesma interface do vector (iterators, insert/erase/assign, operator<<) e pode ser passado
+    onde um vector& é esperado.
+    @tparam T tipo de dado armazenado
+    @tparam N quantidade de elementos guardados sem alocação
+    @tparam Allocator alocador usado quando N não é suficiente
+    @tparam GrowthPolicy política de crescimento depois que N não é suficiente
+*/
+template < typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = growth_factor_2 >
+class small_vector : private small_vector_buffer<T, N>, public ::vector<T, Allocator, GrowthPolicy> {
+        typedef ::vector<T, Allocator, GrowthPolicy> base; //!< vector que faz todo o trabalho.
+        using small_vector_buffer<T, N>::buffer;
+
+    public:
+        typedef typename base::size_type size_type;  /*!< @var usado por exemplo como um indice (int) */
+        typedef typename base::value_type value_type;  /*!< @var tipo de dado armazenado */
+        typedef typename base::pointer pointer;  /*!< @var ponteiro para o tipo de dado */
+
+        static_assert( N > 0, "small_vector precisa de N > 0" );
+
+        // [I] membros especiais
+
+        /**
+        * @brief construtor de um small_vector vazio, usando o espaço interno
+        * @param alloc alocador a ser usado quando o espaço interno acabar
+        */
+        explicit small_vector( const Allocator& alloc = Allocator() )
+            : base( reinterpret_cast<pointer>(buffer), N, alloc )
+        { /* empty */ }
+
+        /**
+        * @brief construtor iniciando com 'count' elementos construidos com o construtor padrão
+        * @param count quantidade de elementos
+        * @param alloc alocador a ser usado quando o espaço interno acabar
+        */
+        explicit small_vector( size_t count, const Allocator& alloc = Allocator() )
+            : base( reinterpret_cast<pointer>(buffer), N, alloc )
+        {
+            this->reserve( count );
+            for ( size_t i = 0; i < count; ++i ){
+                this->emplace_back();
+            }
+        }
+
+        /**
+        * @brief construtor que iguala o small_vector a uma lista, ex: {1, 2, 3}
+        * @param l lista a ser copiada
+        * @param alloc alocador a ser usado quando o espaço interno acabar
+        */
+        small_vector( std::initializer_list<T> l, const Allocator& alloc = Allocator() )
+            : base( reinterpret_cast<pointer>(buffer), N, alloc )
+        {
+            this->assign( l );
+        }
+
+        /**
+        * @brief construtor iniciando com os mesmos valores de outro vector
+        * @param source vector (ou small_vector) a ser copiado
+        */
+        small_vector( const base& source )
+            : base( reinterpret_cast<pointer>(buffer), N, std::allocator_traits<Allocator>::select_on_container_copy_construction( source.get_allocator() ) )
+        {
+            base::operator=( source );
+        }
+
+        /**
+        * @brief construtor iniciando com os mesmos valores de outro small_vector
+        * @param source small_vector a ser copiado
+        */
+        small_vector( const small_vector& source )
+            : small_vector( static_cast<const base&>(source) )
+        { /* empty */ }
+
+        /**
+        * @brief construtor que move os elementos de outro vector; a memória de 's' é tomada se estiver no alocador
+        * @param s vector a ser movido
+        */
+        small_vector( base && s )
+            : base( reinterpret_cast<pointer>(buffer), N, s.get_allocator() )
+        {
+            base::operator=( std::move(s) );
+        }
+
+        /**
+        * @brief construtor que move os elementos de outro small_vector
+        * @param s small_vector a ser movido, volta a usar seu espaço interno
+        */
+        small_vector( small_vector && s )
+            : base( reinterpret_cast<pointer>(buffer), N, s.get_allocator() )
+        {
+            base::operator=( std::move(s) );
+            s.use_buffer( s.buffer_begin(), N );
+        }
+
+        /**
+        * @brief iguala o small_vector a outro vector
+        * @param rhs vector a ser copiado
+        * @return uma referencia para small_vector
+        */
+        small_vector& operator=( const base& rhs ){
+            base::operator=( rhs );
+            return *this;
+        }
+
+        small_vector& operator=( const small_vector& rhs ){
+            base::operator=( rhs );
+            return *this;
+        }
+
+        /**
+        * @brief iguala o small_vector a outro small_vector, movendo os elementos
+        * @param s small_vector a ser movido, volta a usar seu espaço interno
+        * @return uma referencia para small_vector
+        */
+        small_vector& operator=( small_vector && s ){
+            base::operator=( std::move(s) );
+            s.use_buffer( s.buffer_begin(), N );
+            return *this;
+        }
+
+        // fim [I]
+
+        //---------------------------------------------------------------------------------------------------
+
+        // [III] Capacity
+
+        /**
+        * @brief verifica se os elementos ainda estão no espaço interno
+        * @return true se nenhuma memória do alocador está em uso
+        */
+        bool is_inline( void ) const{
+            return this->data() >= buffer_begin() && this->data() <= buffer_begin() + N;
+        }
+
+        /** @brief quantidade de elementos que cabem no espaço interno */
+        static constexpr size_type inline_capacity( void ){
+            return N;
+        }
+
+        /**
+        * @brief devolve a memória que sobra; se os elementos cabem no espaço interno, voltam para ele
+        *        e o bloco do alocador é liberado
+        */
+        void shrink_to_fit( void ){
+            if ( !is_inline() && this->size() <= N ){
+                this->move_to_buffer( buffer_begin(), N );
+                return;
+            }
+            base::shrink_to_fit();
+        }
+
+        // fim [III]
+
+    private:
+        /** @brief começo do espaço interno, como ponteiro para T */
+        pointer buffer_begin( void ) const{
+            return reinterpret_cast<pointer>( const_cast<unsigned char*>( buffer ) );
+        }
+};
@@ -0,0 +1,665 @@
+/*! @file soa_vector.h
+    @brief vector de registros guardados por coluna (structure of arrays): soa_vector<Ts...>.
+
+    Cada campo do registro mora num array contíguo próprio, então uma varredura que lê um só campo traz para o
+    cache apenas aquele campo, e column<K>() entrega o array como std::span (ex: para simd::sum).
+    - todos os arrays ficam num único bloco do alocador, um depois do outro, cada um alinhado a 64 bytes:
+      crescer é uma alocação só
+    - operator[] e os iterators devolvem uma referência-proxy std::tuple<Ts&...>, e get<K>(i) o campo K
+    - crescimento (GrowthPolicy), insert e erase seguem o vector: colunas relocáveis (is_relocatable) são
+      movidas com memcpy/memmove, as outras elemento a elemento
+    Precisa de C++20 (std::span).
+*/
+
+#ifndef ALGORITHM
+#define ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef CSTRING
+#define CSTRING
+#include <cstring>
+#endif
+
+#ifndef ITERATOR
+#define ITERATOR
+#include <iterator>
+#endif
+
+#ifndef MEMORY
+#define MEMORY
+#include <memory>
+#endif
+
+#ifndef SPAN
+#define SPAN
+#include <span>
+#endif
+
+#ifndef STDEXCEPT
+#define STDEXCEPT
+#include <stdexcept>
+#endif
+
+#ifndef TUPLE
+#define TUPLE
+#include <tuple>
+#endif
+
+#ifndef UTILITY
+#define UTILITY
+#include <utility>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+/*! @brief registros de campos Ts..., guardados numa coluna contígua por campo
+    @tparam Allocator alocador do bloco (é reassociado a linhas de 64 bytes)
+    @tparam GrowthPolicy política de crescimento da capacidade, como no vector
+    @tparam Ts tipos dos campos, na ordem das colunas
+*/
+template < typename Allocator, typename GrowthPolicy, typename... Ts >
+class basic_soa_vector {
+    public:
+        typedef std::tuple<Ts...> value_type;  /*!< @var um registro inteiro, por valor */
+        typedef std::tuple<Ts&...> reference;  /*!< @var referência-proxy para os campos de um registro */
+        typedef std::tuple<const Ts&...> const_reference;  /*!< @var referência-proxy constante */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos e índices */
+        typedef std::ptrdiff_t difference_type;  /*!< @var diferença entre dois índices */
+        typedef Allocator allocator_type;  /*!< @var alocador usado pelo soa_vector */
+
+        static const size_t columns = sizeof...(Ts);  //!< quantidade de campos
+        static const size_t column_alignment = 64;  //!< cada coluna começa numa linha de cache
+
+        /*! @brief tipo do campo K */
+        template < size_t K >
+        using column_type = typename std::tuple_element<K, value_type>::type;
+
+        static_assert( columns > 0, "soa_vector precisa de pelo menos um campo" );
+
+        /*! @brief iterator de acesso aleatório por índice; operator* devolve a referência-proxy
+            @tparam Const true para só ler os registros
+        */
+        template < bool Const >
+        class basic_iterator {
+                typedef typename std::conditional< Const, const basic_soa_vector, basic_soa_vector >::type owner_type;
+
+            public:
+                typedef std::random_access_iterator_tag iterator_category;  /*!< @var categoria do iterator */
+                typedef typename basic_soa_vector::value_type value_type;  /*!< @var registro por valor */
+                typedef std::ptrdiff_t difference_type;  /*!< @var distância entre dois iterators */
+                typedef typename std::conditional< Const, typename basic_soa_vector::const_reference,
+                                                   typename basic_soa_vector::reference >::type reference;  /*!< @var proxy */
+                typedef void pointer;  /*!< @var não há um objeto registro para apontar */
+
+                basic_iterator() : owner{ nullptr }, index{ 0 } { /* empty */ }
+
+                basic_iterator( owner_type * o, size_t i ) : owner{ o }, index{ i } { /* empty */ }
+
+                /** @brief um iterator que pode escrever se converte num que só lê */
+                template < bool C = Const, typename = typename std::enable_if<C>::type >
+                basic_iterator( const basic_iterator<false>& m ) : owner{ m.owner }, index{ m.index } { /* empty */ }
+
+                reference operator*( ) const{ return (*owner)[index]; }
+                reference operator[]( difference_type d ) const{ return (*owner)[index+d]; }
+
+                basic_iterator& operator++( ){ ++index; return *this; }
+                basic_iterator operator++( int ){ basic_iterator t( *this ); ++index; return t; }
+                basic_iterator& operator--( ){ --index; return *this; }
+                basic_iterator operator--( int ){ basic_iterator t( *this ); --index; return t; }
+                basic_iterator& operator+=( difference_type d ){ index += d; return *this; }
+                basic_iterator& operator-=( difference_type d ){ index -= d; return *this; }
+
+                friend basic_iterator operator+( basic_iterator m, difference_type d ){ return m += d; }
+                friend basic_iterator operator+( difference_type d, basic_iterator m ){ return m += d; }
+                friend basic_iterator operator-( basic_iterator m, difference_type d ){ return m -= d; }
+                friend difference_type operator-( basic_iterator a, basic_iterator b ){
+                    return (difference_type) a.index - (difference_type) b.index;
+                }
+
+                friend bool operator==( basic_iterator a, basic_iterator b ){ return a.index == b.index; }
+                friend bool operator!=( basic_iterator a, basic_iterator b ){ return a.index != b.index; }
+                friend bool operator<( basic_iterator a, basic_iterator b ){ return a.index < b.index; }
+                friend bool operator>( basic_iterator a, basic_iterator b ){ return a.index > b.index; }
+                friend bool operator<=( basic_iterator a, basic_iterator b ){ return a.index <= b.index; }
+                friend bool operator>=( basic_iterator a, basic_iterator b ){ return a.index >= b.index; }
+
+            private:
+                friend class basic_soa_vector;
+                friend class basic_iterator<!Const>;
+
+                owner_type * owner; //!< soa_vector percorrido
+                size_t index; //!< posição do registro
+        };
+
+        typedef basic_iterator<false> iterator;  /*!< @var iterator que pode escrever */
+        typedef basic_iterator<true> const_iterator;  /*!< @var iterator que só lê */
+
+        // [I] membros especiais
+
+        /**
+        * @brief construtor de um soa_vector vazio, sem alocar memória
+        * @param alloc alocador a ser usado
+        */
+        explicit basic_soa_vector( const Allocator& alloc = Allocator() )
+            : allocator{ alloc },
+            block{ nullptr },
+            block_lines{ 0 },
+            size_now{ 0 },
+            capacity_now{ 0 },
+            cols{}
+        { /* empty */ }
+
+        /**
+        * @brief construtor iniciando com os mesmos registros de outro soa_vector
+        * @param source soa_vector a ser copiado
+        */
+        basic_soa_vector( const basic_soa_vector& source )
+            : allocator{ line_traits::select_on_container_copy_construction( source.allocator ) },
+            block{ nullptr },
+            block_lines{ 0 },
+            size_now{ 0 },
+            capacity_now{ 0 },
+            cols{}
+        {
+            try{
+                append_copy( source );
+            }catch(...){
+                destroy_all();
+                free_block();
+                throw;
+            }
+        }
+
+        /**
+        * @brief construtor que toma para si o bloco de outro soa_vector, em O(1)
+        * @param s soa_vector a ser movido, fica vazio e sem capacidade
+        */
+        basic_soa_vector( basic_soa_vector && s ) noexcept
+            : allocator{ std::move( s.allocator ) },
+            block{ s.block },
+            block_lines{ s.block_lines },
+            size_now{ s.size_now },
+            capacity_now{ s.capacity_now },
+            cols{ s.cols }
+        {
+            s.forget_block();
+        }
+
+        /**
+        * @brief iguala a outro soa_vector, reaproveitando o bloco atual quando cabe
+        * @param rhs soa_vector a ser copiado
+        * @return uma referencia para o soa_vector
+        */
+        basic_soa_vector& operator=( const basic_soa_vector& rhs ){
+            if ( this == &rhs ) return *this;
+            clear();
+            append_copy( rhs );
+            return *this;
+        }
+
+        /**
+        * @brief iguala a outro soa_vector, tomando seu bloco quando os alocadores permitem
+        * @param s soa_vector a ser movido
+        * @return uma referencia para o soa_vector
+        */
+        basic_soa_vector& operator=( basic_soa_vector && s ){
+            if ( this == &s ) return *this;
+            if ( line_traits::propagate_on_container_move_assignment::value || allocator == s.allocator ){
+                destroy_all();
+                free_block();
+                move_allocator( s.allocator, typename line_traits::propagate_on_container_move_assignment() );
+                block = s.block;
+                block_lines = s.block_lines;
+                size_now = s.size_now;
+                capacity_now = s.capacity_now;
+                cols = s.cols;
+                s.forget_block();
+            }else{
+                // o bloco de 's' não pode ser liberado pelo nosso alocador, move registro a registro.
+                clear();
+                reserve( s.size_now );
+                for ( size_t i = 0; i < s.size_now; ++i ) construct_back( s.row_rvalue( i, indices() ) );
+                s.clear();
+            }
+            return *this;
+        }
+
+        /** @brief destroi os registros e devolve o bloco ao alocador */
+        ~basic_soa_vector(){
+            destroy_all();
+            free_block();
+        }
+
+        // fim [I]
+
+        //---------------------------------------------------------------------------------------------------
+
+        // [II] Iterators
+
+        iterator begin( void ){ return iterator( this, 0 ); }
+        iterator end( void ){ return iterator( this, size_now ); }
+        const_iterator begin( void ) const{ return const_iterator( this, 0 ); }
+        const_iterator end( void ) const{ return const_iterator( this, size_now ); }
+        const_iterator cbegin( void ) const{ return const_iterator( this, 0 ); }
+        const_iterator cend( void ) const{ return const_iterator( this, size_now ); }
+
+        // fim [II]
+
+        //---------------------------------------------------------------------------------------------------
+
+        // [III] Capacity
+
+        /** @brief quantidade de registros */
+        size_t size( void ) const{ return size_now; }
+
+        /** @brief registros que cabem no bloco atual */
+        size_t capacity( void ) const{ return capacity_now; }
+
+        /** @brief true se não há registros */
+        bool empty( void ) const{ return size_now == 0; }
+
+        /**
+        * @brief garante espaço para 'new_cap' registros, numa única alocação para todas as colunas
+        * @param new_cap capacidade desejada
+        */
+        void reserve( size_t new_cap ){
+            if ( new_cap <= capacity_now ) return;
+            reallocate_block( new_cap );
+        }
+
+        /** @brief troca o bloco por um de exatamente size() registros */
+        void shrink_to_fit( void ){
+            if ( capacity_now != size_now ) reallocate_block( size_now );
+        }
+
+        // fim [III]
+
+        //---------------------------------------------------------------------------------------------------
+
+        // [IV] Modifiers
+
+        /** @brief destroi todos os registros, a capacidade é mantida */
+        void clear( void ){
+            destroy_all();
+            size_now = 0;
+        }
+
+        /**
+        * @brief acrescenta um registro no fim
+        * @param value registro, um campo por coluna (pode ser um registro do próprio soa_vector)
+        */
+        void push_back( const value_type& value ){
+            if ( size_now == capacity_now ){
+                value_type temp( value ); // value pode ser um registro deste soa_vector
+                grow( size_now+1 );
+                construct_back( std::move( temp ) );
+                return;
+            }
+            construct_back( value );
+        }
+
+        void push_back( value_type && value ){
+            if ( size_now == capacity_now ){
+                value_type temp( std::move( value ) );
+                grow( size_now+1 );
+                construct_back( std::move( temp ) );
+                return;
+            }
+            construct_back( std::move( value ) );
+        }
+
+        /**
+        * @brief constroi um registro no fim, um argumento por campo
+        * @param values valores dos campos, na ordem das colunas
+        */
+        template < typename... Us >
+        void emplace_back( Us&&... values ){
+            static_assert( sizeof...(Us) == columns, "emplace_back precisa de um valor por coluna" );
+            if ( size_now == capacity_now ){
+                value_type temp( std::forward<Us>(values)... );
+                grow( size_now+1 );
+                construct_back( std::move( temp ) );
+                return;
+            }
+            construct_back( std::forward_as_tuple( std::forward<Us>(values)... ) );
+        }
+
+        /** @brief remove o último registro */
+        void pop_back( void ){
+            --size_now;
+            each_column( [&]( auto k ){ destroy_range<k>( size_now, size_now+1 ); } );
+        }
+
+        /**
+        * @brief insere um registro antes de pos, deslocando os seguintes em cada coluna
+        * @return iterator para o registro inserido
+        */
+        iterator insert( const_iterator pos, const value_type& value ){
+            size_t i = pos.index;
+            push_back( value );
+            rotate_back_to( i );
+            return iterator( this, i );
+        }
+
+        iterator insert( const_iterator pos, value_type && value ){
+            size_t i = pos.index;
+            push_back( std::move( value ) );
+            rotate_back_to( i );
+            return iterator( this, i );
+        }
+
+        /**
+        * @brief apaga um registro
+        * @return iterator para o registro que ocupou seu lugar
+        */
+        iterator erase( const_iterator pos ){
+            return erase( pos, pos+1 );
+        }
+
+        /**
+        * @brief apaga os registros de [first, last), deslocando o final uma única vez em cada coluna
+        * @return iterator para o registro que ocupou o lugar de first
+        */
+        iterator erase( const_iterator first, const_iterator last ){
+            size_t pos = first.index, n = last.index - first.index;
+            if ( n != 0 ){
+                each_column( [&]( auto k ){ erase_column<k>( pos, n, is_relocatable< column_type<k> >() ); } );
+                size_now -= n;
+            }
+            return iterator( this, pos );
+        }
+
+        // fim [IV]
+
+        //---------------------------------------------------------------------------------------------------
+
+        // [V] Element access
+
+        /** @brief campos do registro i, como referência-proxy (ex: std::get<1>( v[i] ) = 3;) */
+        reference operator[]( size_t i ){ return row( i, indices() ); }
+        const_reference operator[]( size_t i ) const{ return row( i, indices() ); }
+
+        /**
+        * @brief campos do registro i
+        * @throw std::out_of_range se i >= size()
+        */
+        reference at( size_t i ){
+            if ( i >= size_now ) throw std::out_of_range( "soa_vector::at" );
+            return (*this)[i];
+        }
+
+        const_reference at( size_t i ) const{
+            if ( i >= size_now ) throw std::out_of_range( "soa_vector::at" );
+            return (*this)[i];
+        }
+
+        /** @brief campo K do registro i */
+        template < size_t K >
+        column_type<K>& get( size_t i ){ return std::get<K>( cols )[i]; }
+
+        template < size_t K >
+        const column_type<K>& get( size_t i ) const{ return std::get<K>( cols )[i]; }
+
+        /** @brief coluna K inteira, contígua e alinhada a 64 bytes (ex: simd::sum( c.data(), c.size() )) */
+        template < size_t K >
+        std::span< column_type<K> > column( void ){
+            return std::span< column_type<K> >( std::get<K>( cols ), size_now );
+        }
+
+        template < size_t K >
+        std::span< const column_type<K> > column( void ) const{
+            return std::span< const column_type<K> >( std::get<K>( cols ), size_now );
+        }
+
+        /** @brief ponteiro para o começo da coluna K */
+        template < size_t K >
+        column_type<K> * data( void ){ return std::get<K>( cols ); }
+
+        template < size_t K >
+        const column_type<K> * data( void ) const{ return std::get<K>( cols ); }
+
+        /** @brief alocador usado pelo soa_vector */
+        allocator_type get_allocator( void ) const{ return allocator_type( allocator ); }
+
+        // fim [V]
+
+    private:
+        /*! @brief unidade de alocação: com ela o bloco, e cada coluna, começa alinhado a 64 bytes */
+        struct alignas(64) line {
+            unsigned char bytes[ 64 ];
+        };
+
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<line> line_allocator;
+        typedef std::allocator_traits<line_allocator> line_traits; //!< acesso uniforme ao alocador.
+        typedef std::index_sequence_for<Ts...> indices;
+
+        /*! @brief se todas as colunas movem sem lançar, a realocação move; se não, copia e o original fica
+            intacto até o fim (uma exceção no meio de uma coluna não deixa outra coluna já movida)
+        */
+        static const bool nothrow_relocation = ( std::is_nothrow_move_constructible<Ts>::value && ... );
+
+        line_allocator allocator; //!< Alocador do bloco.
+        line * block; //!< Bloco com todas as colunas, ou nullptr.
+        size_t block_lines; //!< Tamanho do bloco em linhas de 64 bytes.
+        size_t size_now; //!< Quantidade de registros.
+        size_t capacity_now; //!< Registros que cabem em cada coluna.
+        std::tuple<Ts*...> cols; //!< Começo de cada coluna dentro do bloco.
+
+        // [VI] Bloco e colunas
+
+        /** @brief bytes de uma coluna de 'cap' elementos de 'element' bytes, arredondado para linhas inteiras */
+        static size_t column_bytes( size_t cap, size_t element ){
+            return ( cap*element + column_alignment - 1 ) / column_alignment * column_alignment;
+        }
+
+        /** @brief linhas de um bloco com 'cap' registros */
+        static size_t lines_for( size_t cap ){
+            const size_t sizes[] = { sizeof(Ts)... };
+            size_t bytes = 0;
+            for ( size_t s : sizes ){
+                if ( cap > ( size_t(-1) / 2 ) / s ) throw std::bad_alloc();
+                bytes += column_bytes( cap, s );
+            }
+            return bytes / column_alignment;
+        }
+
+        /** @brief começo de cada coluna num bloco de 'cap' registros */
+        template < size_t... K >
+        static std::tuple<Ts*...> carve( line * b, size_t cap, std::index_sequence<K...> ){
+            const size_t sizes[] = { sizeof(Ts)... };
+            size_t offsets[ columns ];
+            size_t off = 0;
+            for ( size_t k = 0; k < columns; ++k ){
+                offsets[k] = off;
+                off += column_bytes( cap, sizes[k] );
+            }
+            unsigned char * base = reinterpret_cast<unsigned char*>( b );
+            return std::tuple<Ts*...>( reinterpret_cast<Ts*>( base + offsets[K] )... );
+        }
+
+        /** @brief chama f( std::integral_constant<size_t, K>() ) para cada coluna K, em ordem */
+        template < typename F >
+        static void each_column( F&& f ){
+            each_column( f, indices() );
+        }
+
+        template < typename F, size_t... K >
+        static void each_column( F& f, std::index_sequence<K...> ){
+            ( f( std::integral_constant<size_t, K>() ), ... );
+        }
+
+        /** @brief esquece o bloco, que passou para outro soa_vector */
+        void forget_block( void ){
+            block = nullptr;
+            block_lines = 0;
+            size_now = 0;
+            capacity_now = 0;
+            cols = std::tuple<Ts*...>();
+        }
+
+        void move_allocator( line_allocator& a, std::true_type ){ allocator = std::move(a); }
+        void move_allocator( line_allocator&, std::false_type ){ /* empty */ }
+
+        void free_block( void ){
+            if ( block != nullptr ) line_traits::deallocate( allocator, block, block_lines );
+        }
+
+        /** @brief destroi os campos K de [first, last) */
+        template < size_t K >
+        void destroy_range( size_t first, size_t last ){
+            column_type<K> * c = std::get<K>( cols );
+            for ( size_t i = first; i < last; ++i ) line_traits::destroy( allocator, c+i );
+        }
+
+        template < size_t K >
+        void destroy_range( std::tuple<Ts*...>& other, size_t first, size_t last ){
+            column_type<K> * c = std::get<K>( other );
+            for ( size_t i = first; i < last; ++i ) line_traits::destroy( allocator, c+i );
+        }
+
+        void destroy_all( void ){
+            each_column( [&]( auto k ){ destroy_range<k>( 0, size_now ); } );
+        }
+
+        /** @brief nova capacidade pela política de crescimento, no mínimo 'required' */
+        void grow( size_t required ){
+            size_t record = 0;
+            for ( size_t s : { sizeof(Ts)... } ) record += s;
+            reallocate_block( GrowthPolicy::next_capacity( capacity_now, required, record ) );
+        }
+
+        /**
+        * @brief troca o bloco por um de exatamente 'new_cap' registros, levando as colunas
+        * @param new_cap nova capacidade, no mínimo size()
+        */
+        void reallocate_block( size_t new_cap ){
+            size_t lines = ( new_cap == 0 ) ? 0 : lines_for( new_cap );
+            line * nb = ( lines == 0 ) ? nullptr : line_traits::allocate( allocator, lines );
+            std::tuple<Ts*...> nc = carve( nb, new_cap, indices() );
+
+            // colunas já construidas em nc, para desfazer se uma cópia lançar.
+            size_t done = 0;
+            try{
+                each_column( [&]( auto k ){ relocate_column<k>( nc, is_relocatable< column_type<k> >() ); ++done; } );
+            }catch(...){
+                each_column( [&]( auto k ){
+                    if ( k < done && !is_relocatable< column_type<k> >::value ) destroy_range<k>( nc, 0, size_now );
+                } );
+                if ( nb != nullptr ) line_traits::deallocate( allocator, nb, lines );
+                throw;
+            }
+            // os originais que não foram copiados bit a bit ainda precisam ser destruidos.
+            each_column( [&]( auto k ){
+                if ( !is_relocatable< column_type<k> >::value ) destroy_range<k>( 0, size_now );
+            } );
+
+            free_block();
+            block = nb;
+            block_lines = lines;
+            capacity_now = new_cap;
+            cols = nc;
+        }
+
+        template < size_t K >
+        void relocate_column( std::tuple<Ts*...>& nc, std::true_type ){
+            if ( size_now != 0 ){
+                std::memcpy( static_cast<void*>( std::get<K>( nc ) ), static_cast<const void*>( std::get<K>( cols ) ),
+                             size_now*sizeof( column_type<K> ) );
+            }
+        }
+
+        template < size_t K >
+        void relocate_column( std::tuple<Ts*...>& nc, std::false_type ){
+            column_type<K> * from = std::get<K>( cols );
+            column_type<K> * to = std::get<K>( nc );
+            size_t i = 0;
+            try{
+                for ( ; i < size_now; ++i ){
+                    if constexpr ( nothrow_relocation ) line_traits::construct( allocator, to+i, std::move( from[i] ) );
+                    else line_traits::construct( allocator, to+i, static_cast<const column_type<K>&>( from[i] ) );
+                }
+            }catch(...){
+                destroy_range<K>( nc, 0, i );
+                throw;
+            }
+        }
+
+        /**
+        * @brief constroi o registro size() a partir dos campos de 't' (tuple de valores ou referências);
+        *        a capacidade deve ser suficiente. Se um campo lançar, os já construidos são destruidos
+        */
+        template < typename Tuple >
+        void construct_back( Tuple&& t ){
+            size_t built = 0;
+            try{
+                each_column( [&]( auto k ){
+                    line_traits::construct( allocator, std::get<k>( cols ) + size_now, std::get<k>( std::forward<Tuple>(t) ) );
+                    ++built;
+                } );
+            }catch(...){
+                each_column( [&]( auto k ){ if ( k < built ) destroy_range<k>( size_now, size_now+1 ); } );
+                throw;
+            }
+            ++size_now;
+        }
+
+        /** @brief acrescenta cópias de todos os registros de 'source' */
+        void append_copy( const basic_soa_vector& source ){
+            reserve( size_now + source.size_now );
+            for ( size_t i = 0; i < source.size_now; ++i ) construct_back( source[i] );
+        }
+
+        template < size_t... K >
+        reference row( size_t i, std::index_sequence<K...> ){
+            return reference( std::get<K>( cols )[i]... );
+        }
+
+        template < size_t... K >
+        const_reference row( size_t i, std::index_sequence<K...> ) const{
+            return const_reference( std::get<K>( cols )[i]... );
+        }
+
+        /** @brief campos do registro i como referências rvalue, para mover o registro inteiro */
+        template < size_t... K >
+        std::tuple<Ts&&...> row_rvalue( size_t i, std::index_sequence<K...> ){
+            return std::tuple<Ts&&...>( std::move( std::get<K>( cols )[i] )... );
+        }
+
+        /** @brief leva o último registro para a posição i, deslocando [i, size()-1) uma posição em cada coluna */
+        void rotate_back_to( size_t i ){
+            each_column( [&]( auto k ){
+                column_type<k> * c = std::get<k>( cols );
+                std::rotate( c+i, c+size_now-1, c+size_now );
+            } );
+        }
+
+        /** @brief remove os 'n' campos a partir de 'pos' na coluna K, trazendo o final para trás */
+        template < size_t K >
+        void erase_column( size_t pos, size_t n, std::true_type ){
+            column_type<K> * c = std::get<K>( cols );
+            destroy_range<K>( pos, pos+n );
+            std::memmove( static_cast<void*>( c+pos ), static_cast<void*>( c+pos+n ), ( size_now-pos-n )*sizeof( column_type<K> ) );
+        }
+
+        template < size_t K >
+        void erase_column( size_t pos, size_t n, std::false_type ){
+            column_type<K> * c = std::get<K>( cols );
+            std::move( c+pos+n, c+size_now, c+pos );
+            destroy_range<K>( size_now-n, size_now );
+        }
+
+        // fim [VI]
+};
+
+/*! @brief soa_vector com o alocador e a política de crescimento padrão, ex: soa_vector<double, int, int> */
+template < typename... Ts >
+using soa_vector = basic_soa_vector< std::allocator<unsigned char>, growth_factor_2, Ts... >;
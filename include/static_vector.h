@@ -0,0 +1,455 @@
+/*! @file static_vector.h
+    @brief vector de capacidade fixa N, com os elementos dentro do próprio objeto: static_vector<T, N>.
+
+    Nunca aloca: os N lugares são memória não inicializada do objeto e os elementos são construidos nela sob
+    demanda. A interface segue a do vector (push_back, emplace, insert, erase, assign, iterators).
+    - passar de N elementos segue a política OverflowPolicy: overflow_throws (padrão, std::length_error),
+      overflow_terminates (std::terminate) ou overflow_unchecked (sem verificação, o chamador garante)
+    - todas as operações são constexpr, então tabelas podem ser montadas em tempo de compilação
+    - para T trivialmente copiável o static_vector também é, e pode ser copiado com memcpy
+    Precisa de C++20 (construct_at e membros especiais condicionais).
+*/
+
+#ifndef ALGORITHM
+#define ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef CSTDDEF
+#define CSTDDEF
+#include <cstddef>
+#endif
+
+#ifndef EXCEPTION
+#define EXCEPTION
+#include <exception>
+#endif
+
+#ifndef ITERATOR
+#define ITERATOR
+#include <iterator>
+#endif
+
+#ifndef MEMORY
+#define MEMORY
+#include <memory>
+#endif
+
+#ifndef STDEXCEPT
+#define STDEXCEPT
+#include <stdexcept>
+#endif
+
+#ifndef TYPE_TRAITS
+#define TYPE_TRAITS
+#include <type_traits>
+#endif
+
+#ifndef UTILITY
+#define UTILITY
+#include <utility>
+#endif
+
+// [I] Políticas de estouro
+
+/*! @brief passar da capacidade lança std::length_error (em constexpr, vira erro de compilação) */
+struct overflow_throws {
+    static constexpr bool checked = true;
+    [[noreturn]] static void overflow( void ){ throw std::length_error( "static_vector" ); }
+};
+
+/*! @brief passar da capacidade termina o programa, para código compilado sem exceções */
+struct overflow_terminates {
+    static constexpr bool checked = true;
+    [[noreturn]] static void overflow( void ){ std::terminate(); }
+};
+
+/*! @brief sem verificação: o chamador garante que size() nunca passa de N */
+struct overflow_unchecked {
+    static constexpr bool checked = false;
+    static void overflow( void ){ /* empty */ }
+};
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Armazenamento
+
+/*! @brief N lugares para T dentro do objeto. Para T trivial (inclusive na construção padrão) é um array comum,
+    que em tempo de execução não é inicializado; em constexpr é zerado, porque uma constante não pode ter partes
+    sem valor
+*/
+template < typename T, size_t N, bool PlainArray >
+struct static_vector_storage {
+    T elements[ N ];
+
+    constexpr static_vector_storage(){
+        if ( std::is_constant_evaluated() ){
+            for ( size_t i = 0; i < N; ++i ) elements[i] = T();
+        }
+    }
+};
+
+/*! @brief para os demais T: união sem membro ativo, os elementos são construidos um a um com construct_at. Cópias
+    e destrutor ficam os do compilador, então para T trivialmente copiável e destrutível (ex: com inicializador
+    de membro, struct { int x = 0; }) o armazenamento continua trivialmente copiável
+*/
+template < typename T, size_t N >
+struct static_vector_storage< T, N, false > {
+    union {
+        T elements[ N ];
+    };
+
+    constexpr static_vector_storage(){ /* empty */ }
+    constexpr ~static_vector_storage() requires std::is_trivially_destructible<T>::value = default;
+    constexpr ~static_vector_storage() requires ( !std::is_trivially_destructible<T>::value ){ /* empty */ }
+};
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] static_vector
+
+/*! @brief vector com até N elementos guardados no próprio objeto, sem alocação
+    @tparam T tipo de dado armazenado
+    @tparam N capacidade fixa
+    @tparam OverflowPolicy o que fazer ao passar de N elementos
+*/
+template < typename T, size_t N, typename OverflowPolicy = overflow_throws >
+class static_vector {
+        // cópias, moves e destrutor do compilador; a construção padrão de T não importa, os lugares livres
+        // não são construidos.
+        static constexpr bool trivial = std::is_trivially_copyable<T>::value
+                                        && std::is_trivially_destructible<T>::value;
+        static constexpr bool plain_array = trivial && std::is_trivially_default_constructible<T>::value;
+
+    public:
+        typedef T value_type;  /*!< @var tipo de dado armazenado */
+        typedef size_t size_type;  /*!< @var tipo dos tamanhos e índices */
+        typedef std::ptrdiff_t difference_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T * pointer;
+        typedef const T * const_pointer;
+        typedef T * iterator;  /*!< @var os elementos são contíguos */
+        typedef const T * const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+        static_assert( N > 0, "static_vector precisa de N > 0" );
+
+        // [III.1] membros especiais
+
+        /** @brief construtor vazio */
+        constexpr static_vector() : size_now{ 0 } { /* empty */ }
+
+        /**
+        * @brief construtor com 'count' elementos construidos com o construtor padrão
+        */
+        constexpr explicit static_vector( size_t count ) : size_now{ 0 } {
+            reserve_for( count );
+            for ( size_t i = 0; i < count; ++i ) emplace_back();
+        }
+
+        /**
+        * @brief construtor com 'count' cópias de value
+        */
+        constexpr static_vector( size_t count, const T& value ) : size_now{ 0 } {
+            assign( count, value );
+        }
+
+        /**
+        * @brief construtor que iguala o static_vector a uma lista, ex: {1, 2, 3}
+        */
+        constexpr static_vector( std::initializer_list<T> l ) : size_now{ 0 } {
+            assign( l.begin(), l.end() );
+        }
+
+        /**
+        * @brief construtor com os elementos de [first, last)
+        */
+        template < typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category >
+        constexpr static_vector( InputIterator first, InputIterator last ) : size_now{ 0 } {
+            assign( first, last );
+        }
+
+        // para T trivial as cópias, moves e o destrutor são os do compilador: o objeto é trivialmente copiável.
+        constexpr static_vector( const static_vector& ) requires trivial = default;
+        constexpr static_vector( static_vector && ) requires trivial = default;
+        constexpr static_vector& operator=( const static_vector& ) requires trivial = default;
+        constexpr static_vector& operator=( static_vector && ) requires trivial = default;
+        constexpr ~static_vector() requires trivial = default;
+
+        constexpr static_vector( const static_vector& source ) requires ( !trivial ) : size_now{ 0 } {
+            for ( const T& x : source ) construct_back( x );
+        }
+
+        /** @brief move elemento a elemento: os elementos de s ficam movidos, mas s mantém o tamanho */
+        constexpr static_vector( static_vector && s ) noexcept( std::is_nothrow_move_constructible<T>::value ) requires ( !trivial )
+            : size_now{ 0 }
+        {
+            for ( T& x : s ) construct_back( std::move( x ) );
+        }
+
+        constexpr static_vector& operator=( const static_vector& rhs ) requires ( !trivial ) {
+            if ( this != &rhs ) assign( rhs.begin(), rhs.end() );
+            return *this;
+        }
+
+        constexpr static_vector& operator=( static_vector && s ) requires ( !trivial ) {
+            if ( this != &s ) assign( std::make_move_iterator( s.begin() ), std::make_move_iterator( s.end() ) );
+            return *this;
+        }
+
+        constexpr ~static_vector() requires ( !trivial ) {
+            clear();
+        }
+
+        /** @brief iguala o static_vector a uma lista */
+        constexpr static_vector& operator=( std::initializer_list<T> l ){
+            assign( l.begin(), l.end() );
+            return *this;
+        }
+
+        // fim [III.1]
+
+        // [III.2] Iterators
+
+        constexpr iterator begin( void ){ return storage.elements; }
+        constexpr iterator end( void ){ return storage.elements + size_now; }
+        constexpr const_iterator begin( void ) const{ return storage.elements; }
+        constexpr const_iterator end( void ) const{ return storage.elements + size_now; }
+        constexpr const_iterator cbegin( void ) const{ return begin(); }
+        constexpr const_iterator cend( void ) const{ return end(); }
+        constexpr reverse_iterator rbegin( void ){ return reverse_iterator( end() ); }
+        constexpr reverse_iterator rend( void ){ return reverse_iterator( begin() ); }
+        constexpr const_reverse_iterator rbegin( void ) const{ return const_reverse_iterator( end() ); }
+        constexpr const_reverse_iterator rend( void ) const{ return const_reverse_iterator( begin() ); }
+        constexpr const_reverse_iterator crbegin( void ) const{ return rbegin(); }
+        constexpr const_reverse_iterator crend( void ) const{ return rend(); }
+
+        // fim [III.2]
+
+        // [III.3] Capacity
+
+        constexpr size_t size( void ) const{ return size_now; }
+        static constexpr size_t capacity( void ){ return N; }
+        static constexpr size_t max_size( void ){ return N; }
+        constexpr bool empty( void ) const{ return size_now == 0; }
+        constexpr bool full( void ) const{ return size_now == N; }
+
+        // fim [III.3]
+
+        // [III.4] Modifiers
+
+        /** @brief destroi todos os elementos */
+        constexpr void clear( void ){
+            destroy_from( 0 );
+            size_now = 0;
+        }
+
+        constexpr void push_back( const T& value ){ emplace_back( value ); }
+        constexpr void push_back( T && value ){ emplace_back( std::move( value ) ); }
+
+        /**
+        * @brief constroi um elemento no fim
+        * @return referência para o novo elemento
+        */
+        template < typename... Args >
+        constexpr T& emplace_back( Args&&... args ){
+            reserve_for( 1 );
+            return construct_back( std::forward<Args>(args)... );
+        }
+
+        /** @brief remove o último elemento */
+        constexpr void pop_back( void ){
+            --size_now;
+            std::destroy_at( storage.elements + size_now );
+        }
+
+        /** @brief insere no começo, deslocando todos, em O(n) */
+        constexpr void push_front( const T& value ){ insert( cbegin(), value ); }
+        constexpr void push_front( T && value ){ insert( cbegin(), std::move( value ) ); }
+
+        /** @brief remove o primeiro, deslocando todos, em O(n) */
+        constexpr void pop_front( void ){ erase( cbegin() ); }
+
+        /**
+        * @brief insere value antes de pos
+        * @return iterator para o elemento inserido
+        */
+        constexpr iterator insert( const_iterator pos, const T& value ){
+            return emplace( pos, value );
+        }
+
+        constexpr iterator insert( const_iterator pos, T && value ){
+            return emplace( pos, std::move( value ) );
+        }
+
+        /**
+        * @brief constroi um elemento antes de pos
+        * @return iterator para o elemento construido
+        */
+        template < typename... Args >
+        constexpr iterator emplace( const_iterator pos, Args&&... args ){
+            size_t i = pos - cbegin();
+            reserve_for( 1 );
+            if ( i == size_now ){
+                construct_back( std::forward<Args>(args)... );
+            }else{
+                T temp( std::forward<Args>(args)... ); // os argumentos podem ser elementos do próprio static_vector
+                construct_back( std::move( storage.elements[ size_now-1 ] ) );
+                std::move_backward( begin() + i, end() - 2, end() - 1 );
+                storage.elements[i] = std::move( temp );
+            }
+            return begin() + i;
+        }
+
+        /**
+        * @brief insere os elementos de [first, last) antes de pos: acrescenta no fim e gira para o lugar
+        * @return iterator para o primeiro inserido
+        */
+        template < typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category >
+        constexpr iterator insert( const_iterator pos, InputIterator first, InputIterator last ){
+            size_t i = pos - cbegin();
+            size_t old = size_now;
+            typedef typename std::iterator_traits<InputIterator>::iterator_category category;
+            if constexpr ( std::is_base_of<std::forward_iterator_tag, category>::value ){
+                reserve_for( (size_t) std::distance( first, last ) );
+                for ( ; first != last; ++first ) construct_back( *first );
+            }else{
+                for ( ; first != last; ++first ) emplace_back( *first );
+            }
+            std::rotate( begin() + i, begin() + old, end() );
+            return begin() + i;
+        }
+
+        constexpr iterator insert( const_iterator pos, std::initializer_list<T> l ){
+            return insert( pos, l.begin(), l.end() );
+        }
+
+        /**
+        * @brief apaga o elemento em pos
+        * @return iterator para o elemento que ocupou seu lugar
+        */
+        constexpr iterator erase( const_iterator pos ){
+            return erase( pos, pos+1 );
+        }
+
+        /**
+        * @brief apaga os elementos de [first, last), deslocando o final uma única vez
+        * @return iterator para o elemento que ocupou o lugar de first
+        */
+        constexpr iterator erase( const_iterator first, const_iterator last ){
+            size_t i = first - cbegin(), n = last - first;
+            if ( n != 0 ){
+                std::move( begin() + i + n, end(), begin() + i );
+                destroy_from( size_now - n );
+                size_now -= n;
+            }
+            return begin() + i;
+        }
+
+        /**
+        * @brief apaga os elementos em que pred(elemento) é true, mantendo a ordem dos demais
+        * @return quantidade de elementos apagados
+        */
+        template < typename Predicate >
+        constexpr size_t erase_if( Predicate pred ){
+            iterator last = std::remove_if( begin(), end(), pred );
+            size_t removed = end() - last;
+            erase( last, end() );
+            return removed;
+        }
+
+        /**
+        * @brief troca o conteúdo por 'count' cópias de value
+        */
+        constexpr void assign( size_t count, const T& value ){
+            clear();
+            reserve_for( count );
+            for ( size_t i = 0; i < count; ++i ) construct_back( value );
+        }
+
+        constexpr void assign( std::initializer_list<T> l ){
+            assign( l.begin(), l.end() );
+        }
+
+        /**
+        * @brief troca o conteúdo pelos elementos de [first, last)
+        */
+        template < typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category >
+        constexpr void assign( InputIterator first, InputIterator last ){
+            clear();
+            insert( cend(), first, last );
+        }
+
+        // fim [III.4]
+
+        // [III.5] Element access
+
+        constexpr T& operator[]( size_t i ){ return storage.elements[i]; }
+        constexpr const T& operator[]( size_t i ) const{ return storage.elements[i]; }
+
+        /**
+        * @brief elemento i
+        * @throw std::out_of_range se i >= size()
+        */
+        constexpr T& at( size_t i ){
+            if ( i >= size_now ) throw std::out_of_range( "static_vector::at" );
+            return storage.elements[i];
+        }
+
+        constexpr const T& at( size_t i ) const{
+            if ( i >= size_now ) throw std::out_of_range( "static_vector::at" );
+            return storage.elements[i];
+        }
+
+        constexpr T& front( void ){ return storage.elements[0]; }
+        constexpr const T& front( void ) const{ return storage.elements[0]; }
+        constexpr T& back( void ){ return storage.elements[ size_now-1 ]; }
+        constexpr const T& back( void ) const{ return storage.elements[ size_now-1 ]; }
+
+        constexpr T * data( void ){ return storage.elements; }
+        constexpr const T * data( void ) const{ return storage.elements; }
+
+        // fim [III.5]
+
+        friend constexpr bool operator==( const static_vector& a, const static_vector& b ){
+            return a.size() == b.size() && std::equal( a.begin(), a.end(), b.begin() );
+        }
+
+        friend constexpr bool operator!=( const static_vector& a, const static_vector& b ){
+            return !( a == b );
+        }
+
+    private:
+        static_vector_storage< T, N, plain_array > storage; //!< Os N lugares.
+        size_t size_now; //!< Número de elementos construidos no começo de storage.
+
+        /** @brief aplica a política de estouro se não couberem mais 'n' elementos */
+        constexpr void reserve_for( size_t n ) const{
+            if constexpr ( OverflowPolicy::checked ){
+                if ( n > N - size_now ) OverflowPolicy::overflow();
+            }
+        }
+
+        /** @brief constroi no fim sem verificar a capacidade */
+        template < typename... Args >
+        constexpr T& construct_back( Args&&... args ){
+            T * p = std::construct_at( storage.elements + size_now, std::forward<Args>(args)... );
+            ++size_now;
+            return *p;
+        }
+
+        /** @brief destroi os elementos de [first, size()), sem mudar o tamanho */
+        constexpr void destroy_from( size_t first ){
+            if constexpr ( !std::is_trivially_destructible<T>::value ){
+                for ( size_t i = first; i < size_now; ++i ) std::destroy_at( storage.elements + i );
+            }
+        }
+};
+
+// fim [III]
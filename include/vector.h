@@ -12,11 +12,165 @@
 #include <cstdlib>
 #endif
 
+#ifndef MEMORY
+#define MEMORY
+#include <memory>
+#endif
+
+#ifndef ALGORITHM
+#define ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef CSTRING
+#define CSTRING
+#include <cstring>
+#endif
+
+#ifndef TYPE_TRAITS
+#define TYPE_TRAITS
+#include <type_traits>
+#endif
+
+#ifndef ITERATOR
+#define ITERATOR
+#include <iterator>
+#endif
+
+#ifndef STDEXCEPT
+#define STDEXCEPT
+#include <stdexcept>
+#endif
+
+#ifdef EDBI_VECTOR_STATS
+#ifndef VECTOR_STATS_H
+#define VECTOR_STATS_H
+#include "vector_stats.h"
+#endif
+#define EDBI_STATS( ... ) __VA_ARGS__
+#else
+#define EDBI_STATS( ... )
+#endif
+
 using namespace std;
 
+/*! @brief indica se T pode ser movido de um endereço para outro com memcpy/memmove, sem chamar construtor nem
+    destrutor. Por padrão vale para tipos trivialmente copiáveis; especialize para tipos que também podem, ex:
+    @code template <> struct is_relocatable<MeuTipo> : std::true_type {}; @endcode
+*/
 template < typename T >
+struct is_relocatable : std::integral_constant< bool, std::is_trivially_copyable<T>::value > {};
+
+/*! @brief indica se o alocador A oferece 'reallocate(p, n_antigo, n_novo)' (ex: malloc_allocator),
+    que pode aumentar um bloco no lugar em vez de alocar outro e copiar
+*/
+template < typename A >
+class allocator_can_reallocate {
+        template < typename U >
+        static auto test( int ) -> decltype( std::declval<U&>().reallocate( std::declval<typename U::value_type*>(), size_t(), size_t() ), std::true_type() );
+
+        template < typename U >
+        static std::false_type test( ... );
+
+    public:
+        static const bool value = decltype( test<A>(0) )::value;
+};
+
+// [Políticas de crescimento]
+// Uma política diz qual a nova capacidade quando o vector precisa crescer:
+//     static size_t next_capacity( size_t capacity, size_t required, size_t element_size );
+// 'capacity' é a capacidade atual, 'required' o mínimo necessário (sempre > capacity) e 'element_size' o sizeof(T).
+// O vector nunca usa menos que 'required', então uma inserção de muitos elementos realoca uma única vez.
+
+/*! @brief dobra a capacidade (padrão) */
+struct growth_factor_2 {
+    static size_t next_capacity( size_t capacity, size_t required, size_t ){
+        return std::max( required, ( capacity == 0 ) ? size_t(1) : 2*capacity );
+    }
+};
+
+/*! @brief aumenta a capacidade em 50%: menos memória sobrando, mais realocações */
+struct growth_factor_1_5 {
+    static size_t next_capacity( size_t capacity, size_t required, size_t ){
+        return std::max( required, ( capacity < 2 ) ? capacity+1 : capacity + capacity/2 );
+    }
+};
+
+/*! @brief dobra a capacidade e, a partir de uma página, arredonda o bloco para um número inteiro de páginas
+    @tparam PageBytes tamanho da página em bytes
+*/
+template < size_t PageBytes = 4096 >
+struct growth_page_rounded {
+    static size_t next_capacity( size_t capacity, size_t required, size_t element_size ){
+        size_t cap = growth_factor_2::next_capacity( capacity, required, element_size );
+        size_t bytes = cap*element_size;
+        if ( bytes < PageBytes ) return cap;
+        bytes = ( bytes + PageBytes - 1 ) / PageBytes * PageBytes;
+        return bytes / element_size;
+    }
+};
+
+/*! @brief usa uma função do usuário como política
+    @tparam F função com a mesma assinatura de next_capacity; o resultado é limitado por baixo por 'required'
+*/
+template < size_t (*F)( size_t, size_t, size_t ) >
+struct growth_callback {
+    static size_t next_capacity( size_t capacity, size_t required, size_t element_size ){
+        return std::max( required, F( capacity, required, element_size ) );
+    }
+};
+
+/*! @brief indica se a política G também devolve memória, oferecendo
+    static size_t shrink_capacity( size_t capacity, size_t size, size_t element_size );
+    chamada depois de cada remoção; um resultado menor que 'capacity' faz o vector realocar para ele (nunca
+    abaixo de 'size'). Políticas sem shrink_capacity nunca diminuem a capacidade
+*/
+template < typename G >
+class growth_policy_shrinks {
+        template < typename U >
+        static auto test( int ) -> decltype( U::shrink_capacity( size_t(), size_t(), size_t() ), std::true_type() );
+
+        template < typename U >
+        static std::false_type test( ... );
+
+    public:
+        static const bool value = decltype( test<G>(0) )::value;
+};
+
+/*! @brief cresce como Growth e devolve memória quando o vector fica vazio demais: se o tamanho cai abaixo de
+    Percent% da capacidade, a capacidade vira 2x o tamanho. Isso dá histerese: logo depois de diminuir o vector
+    está com metade da capacidade em uso, então é preciso dobrar o tamanho (crescer) ou cair de novo para
+    Percent% (diminuir) antes da próxima realocação, e push/pop alternados não realocam a cada chamada.
+    Blocos de até MinBytes nunca diminuem.
+    @tparam Growth política de crescimento
+    @tparam Percent ocupação mínima antes de devolver memória, no máximo 50
+    @tparam MinBytes tamanho de bloco abaixo do qual nada é devolvido
+*/
+template < typename Growth = growth_factor_2, size_t Percent = 25, size_t MinBytes = 4096 >
+struct shrink_on_low_use {
+    static_assert( Percent > 0 && Percent <= 50, "Percent precisa estar em (0, 50] para haver histerese" );
+
+    static size_t next_capacity( size_t capacity, size_t required, size_t element_size ){
+        return Growth::next_capacity( capacity, required, element_size );
+    }
+
+    static size_t shrink_capacity( size_t capacity, size_t size, size_t element_size ){
+        if ( capacity*element_size <= MinBytes || size*100 >= capacity*Percent ) return capacity;
+        return std::max( 2*size, MinBytes / element_size );
+    }
+};
+
+// fim [Políticas de crescimento]
+
+/*! @brief vector de elementos do tipo T
+    @tparam T tipo de dado armazenado
+    @tparam Allocator alocador da memória bruta; os elementos só são construídos em [0, size)
+    @tparam GrowthPolicy política de crescimento da capacidade (ex: growth_factor_2, growth_factor_1_5)
+*/
+template < typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = growth_factor_2 >
 class vector {
     public:
+        typedef Allocator allocator_type;  /*!< @var alocador usado pelo vector */
         using size_type = unsigned long;  /*!< @var usado por exemplo como um indice (int) */
         typedef std::ptrdiff_t difference_type;  /*!< @var diferença entre dois ponteiros */
         typedef T value_type;  /*!< @var tipo de dado armazenado */
@@ -24,42 +178,31 @@ class vector {
         typedef T& reference; /*!< @var referência para o tipo de dado */
         typedef const T& const_reference;  /*!< @varreferência constante para o tipo de dado */
        
+        /*! @brief iterator de acesso aleatório e contíguo (std::contiguous_iterator_tag): os dados ficam lado a
+            lado na memória, então std::copy, std::sort, std::lower_bound e o ranges usam seus caminhos rápidos
+            (ex: memmove para tipos trivialmente copiáveis)
+        */
         class MyIterator{
             public:
-                
+                typedef std::random_access_iterator_tag iterator_category;  /*!< @var categoria do C++17 */
+#if __cplusplus > 201703L
+                typedef std::contiguous_iterator_tag iterator_concept;  /*!< @var conceito do C++20 */
+#endif
+                typedef T value_type;  /*!< @var tipo de dado apontado */
+                typedef std::ptrdiff_t difference_type;  /*!< @var distância entre dois iterators, com sinal */
+                typedef T* pointer;  /*!< @var ponteiro para o dado */
+                typedef T& reference;  /*!< @var referência para o dado */
+
                 /**
                 * @brief Contruttor sem argumentos, data = nullptr
                 */
-                MyIterator(){
-                    this->current = nullptr;
-                }
+                MyIterator() : current{ nullptr } { /* empty */ }
 
                 /**
                 * @brief Contruttor com ponteiro
                 * @param  p ponteiro a ser atribuido a current
                 */
-                MyIterator(pointer p){
-                    this->current = p;
-                }
-                
-                /**
-                * @brief atribuição a um iterator
-                * @param  m iterator que seu current será igual ao current da classe
-                */
-                MyIterator& operator=(const MyIterator& m){
-                    this->current = m.current;
-                    return *this;
-                }
-
-
-                /**
-                * @brief atribuição a um iterator
-                * @param  m const iterator que seu current será igual ao current da classe
-                */
-                MyIterator(const MyIterator& m){
-                    this->current = m.current;
-                }
-
+                MyIterator(pointer p) : current{ p } { /* empty */ }
 
                 /**
                 * @brief valor do iterator atual
@@ -70,25 +213,34 @@ class vector {
                 }
 
                 /**
-                * @brief ponteiro do current
+                * @brief ponteiro do current (também é o que o std::to_address usa)
                 * @return um ponteiro para a variavel current
                 */
                 pointer operator ->(void) const {
-                    assert( current != nullptr );
-                    return current; 
+                    return current;
+                }
+
+                /**
+                * @brief dado a 'd' posições do current
+                * @param  d deslocamento, pode ser negativo
+                * @return referencia para o dado
+                */
+                reference operator[]( difference_type d ) const{
+                    return current[d];
                 }
 
                 /**
                 * @brief current aumenta uma vez o tamanho do seu tipo
-                * @return referencia para um proximo iterator
+                * @return referencia para este iterator, já avançado
                 */
                 MyIterator& operator++( ){
-                    return MyIterator(++current);
-                } 
+                    ++current;
+                    return *this;
+                }
 
                 /**
                 * @brief current aumenta uma vez o tamanho do seu tipo, após a execução da linha atual
-                * @return referencia para um proximo iterator
+                * @return o iterator de antes do avanço
                 */
                 MyIterator operator++ (int){
                     return MyIterator(current++);
@@ -96,265 +248,461 @@ class vector {
 
                 /**
                 * @brief current diminui uma vez o tamanho do seu tipo
-                * @return referencia para iterator anterior
+                * @return referencia para este iterator, já recuado
                 */
                 MyIterator& operator-- (){
-                    return MyIterator(--current);
+                    --current;
+                    return *this;
                 }
 
                 /**
                 * @brief current diminui uma vez o tamanho do seu tipo, após a execução da linha atual
-                * @return referencia para iterator anterior
+                * @return o iterator de antes do recuo
                 */
-                MyIterator& operator-- (int){
+                MyIterator operator-- (int){
                     return MyIterator(current--);
                 }
 
                 /**
-                * @brief concatena dois iterators
-                * @param  d iterator
-                * @param  m iterator
-                * @return retorna um iterador com o current igual a soma de dois iterators
+                * @brief avança 'd' posições
+                * @return referencia para este iterator
                 */
-                friend MyIterator operator+( difference_type d, MyIterator m){
-                    return MyIterator(m.current+d);
+                MyIterator& operator+=( difference_type d ){
+                    current += d;
+                    return *this;
                 }
 
                 /**
-                * @brief concatena dois iterators
-                * @param  m iterator
-                * @param  d iterator
-                * @return retorna um iterador com o current igual a soma de dois iterators
+                * @brief recua 'd' posições
+                * @return referencia para este iterator
                 */
-                friend MyIterator operator+(MyIterator m, difference_type d){
-                    return MyIterator(m.current+d);
+                MyIterator& operator-=( difference_type d ){
+                    current -= d;
+                    return *this;
                 }
 
                 /**
-                * @brief a diferença entre dois interators
-                * @param  d iterator
-                * @param  m iterator
-                * @return retorna um iterador com o current igual a diferença de dois iterators
+                * @brief iterator 'd' posições depois de m
                 */
-                friend MyIterator operator-( difference_type d, MyIterator m){
-                    return MyIterator(m.current-d);
+                friend MyIterator operator+( difference_type d, MyIterator m){
+                    return MyIterator(m.current+d);
                 }
 
                 /**
-                * @brief a diferença entre dois interators
-                * @param  d iterator
-                * @param  m iterator
-                * @return retorna um iterador com o current igual a diferença de dois iterators
+                * @brief iterator 'd' posições depois de m
                 */
-                friend MyIterator operator-(MyIterator m, difference_type d){
-                    return MyIterator(m.current-d);
+                friend MyIterator operator+(MyIterator m, difference_type d){
+                    return MyIterator(m.current+d);
                 }
 
                 /**
-                * @brief a diferença entre dois interators (int)
-                * @return um inteiro que é a diferença entres os currents
+                * @brief iterator 'd' posições antes de m
                 */
-                friend int operator-(MyIterator m1, MyIterator m2){
-                    return abs(m2.current-m1.current);
+                friend MyIterator operator-(MyIterator m, difference_type d){
+                    return MyIterator(m.current-d);
                 }
 
                 /**
-                * @brief compara os dois current, verifica se são iguais
-                * @param  m iterator
-                * @return a senteça da igualdade de dois currents
+                * @brief a distância de m2 até m1, negativa se m1 vem antes
                 */
-                bool operator== ( const MyIterator& m) const{
-                    return m.current == current;
+                friend difference_type operator-(MyIterator m1, MyIterator m2){
+                    return m1.current-m2.current;
                 }
 
-                /**
-                * @brief compara os dois current, verifica se são diferentes
-                * @param  m iterator
-                * @return a senteça da diferença de dois currents
-                */
-                bool operator!= ( const MyIterator& m) const{
-                    return m.current != current;
-                }
+                friend bool operator==( MyIterator a, MyIterator b ){ return a.current == b.current; }
+                friend bool operator!=( MyIterator a, MyIterator b ){ return a.current != b.current; }
+                friend bool operator<( MyIterator a, MyIterator b ){ return a.current < b.current; }
+                friend bool operator>( MyIterator a, MyIterator b ){ return a.current > b.current; }
+                friend bool operator<=( MyIterator a, MyIterator b ){ return a.current <= b.current; }
+                friend bool operator>=( MyIterator a, MyIterator b ){ return a.current >= b.current; }
 
             private:
                 T * current; // current é o valor que o interator tenta esconder do usuário finas
 
         };
 
+        /*! @brief como MyIterator, mas só lê os dados; um MyIterator se converte em ConstMyIterator */
         class ConstMyIterator{
-                
+            public:
+                typedef std::random_access_iterator_tag iterator_category;  /*!< @var categoria do C++17 */
+#if __cplusplus > 201703L
+                typedef std::contiguous_iterator_tag iterator_concept;  /*!< @var conceito do C++20 */
+#endif
+                typedef T value_type;  /*!< @var tipo de dado apontado */
+                typedef std::ptrdiff_t difference_type;  /*!< @var distância entre dois iterators, com sinal */
+                typedef const T* pointer;  /*!< @var ponteiro constante para o dado */
+                typedef const T& reference;  /*!< @var referência constante para o dado */
+
                 /**
                 * @brief Contruttor sem argumentos, data = nullptr
                 */
-                ConstMyIterator(){
-                    this->current = nullptr;
-                }
+                ConstMyIterator() : current{ nullptr } { /* empty */ }
 
                 /**
                 * @brief Contruttor com ponteiro
                 * @param  p ponteiro a ser atribuido a current
                 */
-                ConstMyIterator(pointer p){
-                    this->current = p;
-                }
+                ConstMyIterator(pointer p) : current{ p } { /* empty */ }
 
                 /**
-                * @brief atribuição a um iterator
-                * @param  m const iterator que seu current será igual ao current da classe
+                * @brief Contruttor a partir de um iterator que pode escrever
+                * @param  m iterator com a mesma posição
                 */
-                ConstMyIterator(const ConstMyIterator& m){
-                    this->current = m.current;
-                }
+                ConstMyIterator(MyIterator m) : current{ m.operator->() } { /* empty */ }
 
                 /**
                 * @brief valor do iterator atual
-                * @return referencia para o valor do current
+                * @return referencia constante para o valor do current
                 */
                 reference operator* ( ) const{
                     return *current;
                 }
 
                 /**
-                * @brief ponteiro do current
-                * @return um ponteiro para a variavel current
+                * @brief ponteiro do current (também é o que o std::to_address usa)
+                * @return um ponteiro constante para a variavel current
                 */
                 pointer operator ->(void) const {
-                    assert( current != nullptr );
-                    return current; 
+                    return current;
+                }
+
+                /**
+                * @brief dado a 'd' posições do current
+                * @param  d deslocamento, pode ser negativo
+                * @return referencia constante para o dado
+                */
+                reference operator[]( difference_type d ) const{
+                    return current[d];
+                }
+
+                /**
+                * @brief current aumenta uma vez o tamanho do seu tipo
+                * @return referencia para este iterator, já avançado
+                */
+                ConstMyIterator& operator++( ){
+                    ++current;
+                    return *this;
+                }
+
+                /**
+                * @brief current aumenta uma vez o tamanho do seu tipo, após a execução da linha atual
+                * @return o iterator de antes do avanço
+                */
+                ConstMyIterator operator++ (int){
+                    return ConstMyIterator(current++);
+                }
+
+                /**
+                * @brief current diminui uma vez o tamanho do seu tipo
+                * @return referencia para este iterator, já recuado
+                */
+                ConstMyIterator& operator-- (){
+                    --current;
+                    return *this;
+                }
+
+                /**
+                * @brief current diminui uma vez o tamanho do seu tipo, após a execução da linha atual
+                * @return o iterator de antes do recuo
+                */
+                ConstMyIterator operator-- (int){
+                    return ConstMyIterator(current--);
+                }
+
+                /**
+                * @brief avança 'd' posições
+                * @return referencia para este iterator
+                */
+                ConstMyIterator& operator+=( difference_type d ){
+                    current += d;
+                    return *this;
+                }
+
+                /**
+                * @brief recua 'd' posições
+                * @return referencia para este iterator
+                */
+                ConstMyIterator& operator-=( difference_type d ){
+                    current -= d;
+                    return *this;
+                }
+
+                /**
+                * @brief iterator 'd' posições depois de m
+                */
+                friend ConstMyIterator operator+( difference_type d, ConstMyIterator m){
+                    return ConstMyIterator(m.current+d);
                 }
 
                 /**
-                * @brief compara os dois const current, verifica se são iguais
-                * @param  m const iterator
-                * @return a senteça da igualdade de dois currents
+                * @brief iterator 'd' posições depois de m
                 */
-                bool operator== ( const ConstMyIterator& m) const{
-                    return m.current == current;
+                friend ConstMyIterator operator+(ConstMyIterator m, difference_type d){
+                    return ConstMyIterator(m.current+d);
                 }
 
                 /**
-                * @brief compara os dois const current, verifica se são diferentes
-                * @param  m const iterator
-                * @return a senteça da diferença de dois currents
+                * @brief iterator 'd' posições antes de m
                 */
-                bool operator!= ( const ConstMyIterator& m) const{
-                    return m.current != current;
+                friend ConstMyIterator operator-(ConstMyIterator m, difference_type d){
+                    return ConstMyIterator(m.current-d);
                 }
 
-                friend int operator-(MyIterator m1, MyIterator m2){
-                    return abs(m2.current-m1.current);
+                /**
+                * @brief a distância de m2 até m1, negativa se m1 vem antes
+                */
+                friend difference_type operator-(ConstMyIterator m1, ConstMyIterator m2){
+                    return m1.current-m2.current;
                 }
 
+                friend bool operator==( ConstMyIterator a, ConstMyIterator b ){ return a.current == b.current; }
+                friend bool operator!=( ConstMyIterator a, ConstMyIterator b ){ return a.current != b.current; }
+                friend bool operator<( ConstMyIterator a, ConstMyIterator b ){ return a.current < b.current; }
+                friend bool operator>( ConstMyIterator a, ConstMyIterator b ){ return a.current > b.current; }
+                friend bool operator<=( ConstMyIterator a, ConstMyIterator b ){ return a.current <= b.current; }
+                friend bool operator>=( ConstMyIterator a, ConstMyIterator b ){ return a.current >= b.current; }
+
             private:
-                T * current;
-        }; 
+                const T * current;
+        };
+
+        typedef MyIterator iterator;  /*!< @var nome padrão do iterator */
+        typedef ConstMyIterator const_iterator;  /*!< @var nome padrão do iterator constante */
+        typedef std::reverse_iterator<iterator> reverse_iterator;  /*!< @var percorre do fim para o começo */
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;  /*!< @var percorre do fim para o começo, só lendo */
 
         /** @brief verifica se a o tamanho atual do vector é igual a capacidade, se sim aloca mais memória */
         void isCheia(){
-        	if ( size_now == capacity_now ){
-                reserve( ( capacity_now == 0 ) ? 1 : (2 * capacity_now) );
-            }
+        	isCheia( 1 );
         }
 
         /**
-        * @brief verifica se a o tamanho atual do vector é igual a capacidade, se sim aloca mais memória 
+        * @brief verifica se cabem mais 't' elementos no vector, se não aloca mais memória, uma única vez
         * @param t valor que na verificação será soma ao tamanho do vector
         */
-        void isCheia(int t){
-        	if ( size_now == capacity_now || size_now+t >= capacity_now){
-                reserve( ( capacity_now == 0 ) ? 1 : (2 * capacity_now) );
+        void isCheia(size_t t){
+        	if ( size_now+t > capacity_now ){
+                if ( front_gap >= size_now && front_gap+capacity_now >= size_now+t ){
+                    // sobra espaço no começo (pop_front): traz os elementos para o início do bloco, sem alocar.
+                    shift_left( front_gap );
+                    return;
+                }
+                EDBI_STATS( stats_growth( stats_now ); )
+                reserve( next_capacity( size_now+t ) );
             }
         }
 
         // [I] membros especiais
 
         /**
-        * @brief construtor iniciando com um tamanho informado 
-        * @param count tamanho da capacidade do vector
+        * @brief construtor de um vector vazio, sem alocar memória
+        * @param alloc alocador a ser usado
         */
-        explicit vector( size_t count=0 ) :
-            storage{ new T[ 2*count ] },
-            size_now { count },
-            capacity_now { 2*count }
+        explicit vector( const Allocator& alloc = Allocator() ) :
+            allocator{ alloc },
+            storage{ nullptr },
+            size_now { 0 },
+            capacity_now { 0 },
+            front_gap{ 0 },
+            inline_storage{ nullptr }
         { /* empty */ }
 
+        /**
+        * @brief construtor iniciando com um tamanho informado, apenas os 'count' primeiros elementos são construídos
+        * @param count quantidade de elementos do vector
+        * @param alloc alocador a ser usado
+        */
+        explicit vector( size_t count, const Allocator& alloc = Allocator() ) :
+            allocator{ alloc },
+            storage{ nullptr },
+            size_now { 0 },
+            capacity_now { 2*count },
+            front_gap{ 0 },
+            inline_storage{ nullptr }
+        {
+            storage = allocate( capacity_now );
+            for ( ; size_now < count; ++size_now ){
+                alloc_traits::construct( allocator, storage+size_now );
+            }
+        }
+
 
         /**
         * @brief construtor iniciando com os mesmos valores de outro vector
         * @param source vector a ser copiado
         */
         vector( const vector& source )
-            : size_now { source.size },
-            capacity_now { source.capacity }
+            : allocator{ alloc_traits::select_on_container_copy_construction( source.allocator ) },
+            storage{ nullptr },
+            size_now { 0 },
+            capacity_now { source.capacity_now },
+            front_gap{ 0 },
+            inline_storage{ nullptr }
         {
              // [1] Alocar o espaço de dados.
-             storage = new T[ capacity ];
+             storage = allocate( capacity_now );
              // [2] Copiar os elementos do source para o atual (this).
-             std::copy( &source.storage[0], &source.storage[size], storage );
+             construct_copy( source.storage, source.storage+source.size_now );
         }
 
         /**
-        * @brief construtor iniciando com os mesmos valores de outro vector
+        * @brief construtor iniciando com os mesmos valores de outro vector, na memória de outro alocador
+        *        (ex: copiar para a arena de uma requisição com polymorphic_allocator)
         * @param source vector a ser copiado
+        * @param alloc alocador a ser usado
         */
-        vector( vector && s)
-            : size_now { s.size_now },
-            capacity_now { s.capacity_now }
+        vector( const vector& source, const Allocator& alloc )
+            : allocator{ alloc },
+            storage{ nullptr },
+            size_now { 0 },
+            capacity_now { source.size_now },
+            front_gap{ 0 },
+            inline_storage{ nullptr }
         {
-             // [1] Alocar o espaço de dados.
-             storage = new T[ capacity ];
-             // [2] Copiar os elementos do source para o atual (this).
-             std::copy( &s.storage[0], &s.storage[size_now], storage );
+            storage = allocate( capacity_now );
+            construct_copy( source.storage, source.storage+source.size_now );
+        }
+
+        /**
+        * @brief construtor que move outro vector para a memória de 'alloc': a memória de 's' é tomada se os
+        *        alocadores forem iguais, se não os elementos são movidos um a um
+        * @param s vector a ser movido
+        * @param alloc alocador a ser usado
+        */
+        vector( vector && s, const Allocator& alloc )
+            : allocator{ alloc },
+            storage{ nullptr },
+            size_now { 0 },
+            capacity_now { 0 },
+            front_gap{ 0 },
+            inline_storage{ nullptr }
+        {
+            if ( allocator == s.allocator && s.block() != s.inline_storage ){
+                storage = s.storage;
+                size_now = s.size_now;
+                capacity_now = s.capacity_now;
+                front_gap = s.front_gap;
+                s.storage = nullptr;
+                s.size_now = 0;
+                s.capacity_now = 0;
+                s.front_gap = 0;
+                return;
+            }
+            capacity_now = s.size_now;
+            storage = allocate( capacity_now );
+            construct_copy( std::make_move_iterator(s.storage), std::make_move_iterator(s.storage+s.size_now) );
+            s.clear();
         }
 
+        /**
+        * @brief construtor que toma para si a memória de outro vector, em O(1)
+        * @param s vector a ser movido, fica vazio e sem capacidade. Um small_vector é movido pelo construtor
+        *        abaixo, porque o seu espaço interno não pode ser tomado
+        */
+        vector( vector && s) noexcept
+            : allocator{ std::move(s.allocator) },
+            storage{ s.storage },
+            size_now { s.size_now },
+            capacity_now { s.capacity_now },
+            front_gap{ s.front_gap },
+            inline_storage{ nullptr }
+        {
+            s.storage = nullptr;
+            s.size_now = 0;
+            s.capacity_now = 0;
+            s.front_gap = 0;
+        }
+
+        /**
+        * @brief construtor que move um tipo derivado do vector (ex: small_vector): a memória de 's' é tomada se
+        *        estiver no alocador; se os dados estão no espaço interno, são movidos um a um para memória nova
+        * @param s vector derivado a ser movido
+        */
+        template < typename Derived, typename = typename std::enable_if< std::is_base_of<vector, Derived>::value
+                                                                         && !std::is_same<vector, Derived>::value
+                                                                         && !std::is_const<Derived>::value >::type >
+        vector( Derived && s )
+            : vector( static_cast<vector&&>( s ), s.get_allocator() )
+        { /* empty */ }
+
         /**
         * @brief construtor que iguala o vector a uma lista, ex: {1, 2, 3}
-        * @param l lista a ser copiada 
+        * @param l lista a ser copiada
+        * @param alloc alocador a ser usado
         */
-        vector( std::initializer_list<T> l)
-            : size_now { l.size() },
-            capacity_now { l.size() }
+        vector( std::initializer_list<T> l, const Allocator& alloc = Allocator() )
+            : allocator{ alloc },
+            storage{ nullptr },
+            size_now { 0 },
+            capacity_now { l.size() },
+            front_gap{ 0 },
+            inline_storage{ nullptr }
         {
-            storage = new T[capacity_now];
-            std::copy( l.begin(), l.end(), storage);
+            storage = allocate( capacity_now );
+            construct_copy( l.begin(), l.end() );
         }
 
         /**
-        * @brief iguala um vector a outro vector
-        * @param s vector a ser copiado
+        * @brief iguala um vector a outro vector, tomando para si a memória de 's' quando os alocadores permitem
+        * @param s vector a ser movido
         * @return uma referencia para vector
         */
         vector& operator=( vector && s) {
-             capacity = s.capacity;
-             size_now = s.size_now;
-             // [1] Alocar o espaço de dados.
-             storage = new T[ capacity ];
-             // [2] Copiar os elementos do source para o atual (this).
-             std::copy( &s.storage[0], &s.storage[size_now], storage );
+            if ( this == &s ) return *this;
+
+            bool steal = alloc_traits::propagate_on_container_move_assignment::value || allocator == s.allocator;
+            if ( steal && s.block() != s.inline_storage ){
+                clear();
+                deallocate( block(), block_capacity() );
+                move_allocator( s.allocator, typename alloc_traits::propagate_on_container_move_assignment() );
+
+                storage = s.storage;
+                size_now = s.size_now;
+                capacity_now = s.capacity_now;
+                front_gap = s.front_gap;
+
+                s.storage = nullptr;
+                s.size_now = 0;
+                s.capacity_now = 0;
+                s.front_gap = 0;
+            }else{
+                // a memória de 's' não pode ser liberada pelo nosso alocador (ou é o buffer interno de um small_vector),
+                // move elemento a elemento.
+                assign_copy( std::make_move_iterator(s.storage), s.size_now );
+                s.clear();
+            }
+            return *this;
         }
 
         /**
-        * @brief iguala um vector a um const vector
+        * @brief iguala um vector a um const vector, reaproveitando a memória atual quando possível
         * @param s vector constante a ser copiado
         * @return uma referencia para vector
         */
         vector& operator=( const vector& rhs ){
-            size_now = rhs.size_now;
-            capacity = rhs.capacity;
+            if ( this == &rhs ) return *this;
+
+            if ( alloc_traits::propagate_on_container_copy_assignment::value && allocator != rhs.allocator ){
+                // a memória atual pertence a outro alocador, precisa ser devolvida antes da troca.
+                clear();
+                deallocate( block(), block_capacity() );
+                storage = nullptr;
+                capacity_now = 0;
+                front_gap = 0;
+            }
+            copy_allocator( rhs.allocator, typename alloc_traits::propagate_on_container_copy_assignment() );
 
-            // [1] Alocar o espaço de dados.
-            storage = new T[ capacity ];
-            // [2] Copiar os elementos do source para o atual (this).
-            std::copy( &rhs.storage[0], &rhs.storage[size_now], storage );
+            assign_copy( rhs.storage, rhs.size_now );
 
             return *this;
         }
 
         /**
-        * @brief destrutor do vector, apaga o ponteiro que guarda os dados
+        * @brief destrutor do vector, destroi os elementos e devolve a memória ao alocador
         */
         ~vector(){
-            delete [] storage;
+            destroy( storage, storage+size_now );
+            deallocate( block(), block_capacity() );
         }
 
         // fim [I]
@@ -362,7 +710,7 @@ class vector {
         //---------------------------------------------------------------------------------------------------
 
         //=== [II] ITERATORS
-       
+
         /**
         * @brief iterator do começo do vector
         * @return um iterator para o começo do vector
@@ -379,11 +727,27 @@ class vector {
             return MyIterator(storage+size_now);
         }
 
+        /**
+        * @brief const iterator do começo de um vector constante
+        * @return um const iterator para o começo do vector
+        */
+        ConstMyIterator begin(void) const{
+            return ConstMyIterator(storage);
+        }
+
+        /**
+        * @brief const iterator do fim de um vector constante
+        * @return um const iterator para o fim do vector
+        */
+        ConstMyIterator end(void) const{
+            return ConstMyIterator(storage+size_now);
+        }
+
         /**
         * @brief const iterator do começo do vector
         * @return um const iterator para o começo do vector
         */
-        ConstMyIterator cbegin(void){
+        ConstMyIterator cbegin(void) const{
             return ConstMyIterator(storage);
         }
 
@@ -391,10 +755,38 @@ class vector {
         * @brief const iterator do fim do vector
         * @return um const iterator para o fim do vector
         */
-        ConstMyIterator cend(void){
+        ConstMyIterator cend(void) const{
             return ConstMyIterator(storage+size_now);
         }
-        
+
+        /** @brief iterator reverso, começa no último dado */
+        reverse_iterator rbegin(void){
+            return reverse_iterator( end() );
+        }
+
+        /** @brief iterator reverso, sucessor do primeiro dado */
+        reverse_iterator rend(void){
+            return reverse_iterator( begin() );
+        }
+
+        const_reverse_iterator rbegin(void) const{
+            return const_reverse_iterator( end() );
+        }
+
+        const_reverse_iterator rend(void) const{
+            return const_reverse_iterator( begin() );
+        }
+
+        /** @brief const iterator reverso, começa no último dado */
+        const_reverse_iterator crbegin(void) const{
+            return const_reverse_iterator( end() );
+        }
+
+        /** @brief const iterator reverso, sucessor do primeiro dado */
+        const_reverse_iterator crend(void) const{
+            return const_reverse_iterator( begin() );
+        }
+
         // fim [II]
 
         //---------------------------------------------------------------------------------------------------
@@ -424,6 +816,24 @@ class vector {
         bool empty( void ) const{
             return (size_now == 0);
         }
+
+        /**
+        * @brief alocador usado pelo vector
+        * @return uma cópia do alocador
+        */
+        allocator_type get_allocator( void ) const{
+            return allocator;
+        }
+
+#ifdef EDBI_VECTOR_STATS
+        /**
+        * @brief contadores deste vector (só com EDBI_VECTOR_STATS)
+        * @return alocações, realocações, cópias, moves e picos de tamanho/capacidade
+        */
+        const vector_stats& stats( void ) const{
+            return stats_now;
+        }
+#endif
         //fim [III]
 
         //---------------------------------------------------------------------------------------------------
@@ -431,24 +841,53 @@ class vector {
         // [IV] Modifiers
 
         /**
-        * @brief o vector está com seu número de elementos vazio, ou seja não possui elementos
+        * @brief destroi todos os elementos, a capacidade é mantida (e o espaço livre do começo volta para o fim),
+        *        a não ser que a política de crescimento devolva memória (ex: shrink_on_low_use)
         */
         void clear(void){
+            destroy( storage, storage+size_now );
             this->size_now = 0;
+            recenter_empty();
+            shrink_if_underused( shrinks() );
         }
 
         /**
-        * @brief adiociona um elemento do começo do vector
+        * @brief adiociona um elemento do começo do vector, em O(1) amortizado
         * @param value valor a ser inserido
         */
         void push_front( const T & value ){
-            isCheia();
-            //copiando os elmentos uma posição a frente
-            std::copy( &storage[0], &storage[size_now], storage  );
+            emplace_front( value );
+        }
+
+        /**
+        * @brief adiociona um elemento do começo do vector, movendo o valor
+        * @param value valor a ser inserido
+        */
+        void push_front( T && value ){
+            emplace_front( std::move(value) );
+        }
 
-            // Inserir normalmente.
-            *begin() = value;
-            size_now++;
+        /**
+        * @brief constroi um elemento no começo do vector a partir dos argumentos, em O(1) amortizado:
+        *        o vector guarda espaço livre antes do primeiro elemento, os dados continuam contíguos
+        * @param args argumentos repassados ao construtor de T
+        * @return uma referencia para o elemento construido
+        */
+        template <typename... Args>
+        reference emplace_front( Args&&... args ){
+            if ( front_gap == 0 ){
+                T temp( std::forward<Args>(args)... ); // os argumentos podem ser elementos do próprio vector
+                make_front_room();
+                alloc_traits::construct( allocator, storage-1, std::move(temp) );
+            }else{
+                alloc_traits::construct( allocator, storage-1, std::forward<Args>(args)... );
+            }
+            --storage;
+            --front_gap;
+            ++capacity_now;
+            ++size_now;
+            EDBI_STATS( stats_size( stats_now, size_now ); )
+            return storage[0];
         }
 
 
@@ -457,28 +896,59 @@ class vector {
         * @param value valor a ser inserido
         */
         void push_back( const T & value ){
-            isCheia();
-            // Inserir normalmente.
-            storage[size_now++] = value;
-            //*begin() = value;
+            emplace_back( value );
+        }
+
+        /**
+        * @brief adiociona um elemento do fim do vector, movendo o valor
+        * @param value valor a ser inserido
+        */
+        void push_back( T && value ){
+            emplace_back( std::move(value) );
+        }
+
+        /**
+        * @brief constroi um elemento no fim do vector a partir dos argumentos
+        * @param args argumentos repassados ao construtor de T
+        * @return uma referencia para o elemento construido
+        */
+        template <typename... Args>
+        reference emplace_back( Args&&... args ){
+            if ( size_now == capacity_now && front_gap >= size_now && front_gap > 0 ){
+                T temp( std::forward<Args>(args)... ); // os argumentos podem ser elementos do próprio vector
+                shift_left( front_gap );
+                alloc_traits::construct( allocator, storage+size_now, std::move(temp) );
+            }else if ( size_now == capacity_now ){
+                EDBI_STATS( stats_growth( stats_now ); )
+                grow_and_emplace( can_reallocate(), std::forward<Args>(args)... );
+            }else{
+                alloc_traits::construct( allocator, storage+size_now, std::forward<Args>(args)... );
+            }
+            EDBI_STATS( stats_size( stats_now, size_now+1 ); )
+            return storage[size_now++];
         }
 
         /**
         * @brief remove um elemento do fim do vector
-        * @param value valor a ser removido
         */
         void pop_back(void){
             size_now--;
+            alloc_traits::destroy( allocator, storage+size_now );
+            shrink_if_underused( shrinks() );
         }
 
         /**
         * @brief remove um elemento do começo do vector
-        * @param value valor a ser removido
         */
         void pop_front(void){
-            //copiando os elmentos uma posição para trás
-            std::copy( &storage[1], &storage[size_now], storage );
-            size_now--;
+            // o primeiro elemento vira espaço livre do começo, nada é deslocado.
+            alloc_traits::destroy( allocator, storage );
+            ++storage;
+            ++front_gap;
+            --capacity_now;
+            --size_now;
+            recenter_empty();
+            shrink_if_underused( shrinks() );
         }
 
         /**
@@ -488,22 +958,75 @@ class vector {
         void reserve( size_t new_cap ){
             // Se a capacidade nova < capacidade atual, não faço nada.
             if ( new_cap <= capacity_now ) return;
+            EDBI_STATS( stats_realloc_timer timer( stats_now, new_cap*sizeof(T) ); )
+            reallocate_block( new_cap );
+        }
 
-            // Passo 1: alocar nova memória com tamanho solicitado.
-            T * temp = new T[ new_cap ];
+        /**
+        * @brief muda o tamanho para 'n': apaga os dados do fim ou acrescenta dados inicializados com valor (T(),
+        *        zero para tipos numéricos). Se um construtor lança, o vector fica como estava
+        * @param n novo tamanho
+        */
+        void resize( size_t n ){
+            if ( n <= size_now ){
+                shrink_to_size( n );
+                return;
+            }
+            isCheia( n-size_now );
+            append_constructed( n, [this]( pointer p ){ alloc_traits::construct( allocator, p ); } );
+        }
 
-            // Passo 2: copiar os dados da memória antiga para a nova.
-            std::copy( &storage[0], &storage[size_now],  temp );
-            //std::copy( begin(), end(), temp );
+        /**
+        * @brief muda o tamanho para 'n': apaga os dados do fim ou acrescenta cópias de 'value'
+        * @param n novo tamanho
+        * @param value valor dos dados acrescentados
+        */
+        void resize( size_t n, const T& value ){
+            if ( n <= size_now ){
+                shrink_to_size( n );
+                return;
+            }
+            T temp( value ); // value pode ser um elemento do próprio vector
+            isCheia( n-size_now );
+            append_constructed( n, [this, &temp]( pointer p ){ alloc_traits::construct( allocator, p, temp ); } );
+        }
 
-            // Passo 3: Liberar a memória antiga.
-            delete[] storage;
+        /**
+        * @brief como resize(n), mas para T trivial os dados acrescentados não são inicializados: quem chama vai
+        *        sobrescrevê-los (ex: com read() em data()+antigo_size()), sem pagar o preenchimento com zeros.
+        *        Para os demais T, igual a resize(n)
+        * @param n novo tamanho
+        */
+        void resize_for_overwrite( size_t n ){
+            if ( n <= size_now || !( std::is_trivially_default_constructible<T>::value && std::is_trivially_destructible<T>::value ) ){
+                resize( n );
+                return;
+            }
+            isCheia( n-size_now );
+            size_now = n;
+            EDBI_STATS( stats_size( stats_now, size_now ); )
+        }
 
-            // Passo 4: Redirecionar ponteiro para a nova (maior) memória.
-            storage = temp;
+        /**
+        * @brief garante espaço para mais 'n' dados no fim e devolve onde eles ficarão: data()+size(). A memória
+        *        não é inicializada; escreva nela (ex: read/pread/recv direto no vector, sem buffer intermediário)
+        *        e chame commit_spare com quantos dados foram escritos
+        * @param n quantidade de dados que podem ser escritos
+        * @return ponteiro para os 'n' espaços livres depois do último dado
+        */
+        pointer spare_capacity( size_t n ){
+            isCheia( n );
+            return storage+size_now;
+        }
 
-            // Passo 5: Atualizações internas.
-            capacity_now = new_cap;
+        /**
+        * @brief acrescenta ao tamanho os 'n' dados escritos depois do último por meio de spare_capacity
+        * @param n quantidade de dados escritos, no máximo o pedido a spare_capacity
+        */
+        void commit_spare( size_t n ){
+            static_assert( std::is_trivially_copyable<T>::value, "commit_spare: os dados são bytes escritos direto na memória, T precisa ser trivialmente copiável" );
+            size_now += n;
+            EDBI_STATS( stats_size( stats_now, size_now ); )
         }
 
         /**
@@ -513,12 +1036,40 @@ class vector {
         * @return um iterator para o local onde o dado foi inserido
         */
         MyIterator insert(MyIterator it , const T& r){
-            int dif = it-begin(); //pode ser alocado um novo vetor. perda da diferença para o it
+            size_t dif = it-begin(); //pode ser alocado um novo vetor. perda da diferença para o it
+            T temp( r ); // r pode ser um elemento do próprio vector
             isCheia();
-            std::copy( &storage[dif], &storage[size_now],  &storage[dif+1] );
-            size_now++;
-            storage[dif] = r;
- 			
+            insert_range( dif, std::make_move_iterator(&temp), 1 );
+
+            return MyIterator(storage+dif);
+        }
+
+        /**
+        * @brief insere um dado, numa posição especifica, movendo o valor
+        * @param it local onde será o novo valor
+        * @param r novo dado que será inserido
+        * @return um iterator para o local onde o dado foi inserido
+        */
+        MyIterator insert(MyIterator it , T&& r){
+            return emplace( it, std::move(r) );
+        }
+
+        /**
+        * @brief constroi um dado, numa posição especifica, a partir dos argumentos
+        * @param it local onde será o novo valor
+        * @param args argumentos repassados ao construtor de T
+        * @return um iterator para o local onde o dado foi construido
+        */
+        template <typename... Args>
+        MyIterator emplace(MyIterator it, Args&&... args){
+            size_t dif = it-begin();
+            if ( (size_t) dif == size_now ){
+                emplace_back( std::forward<Args>(args)... );
+            }else{
+                T temp( std::forward<Args>(args)... ); // os argumentos podem ser elementos do próprio vector
+                isCheia();
+                insert_range( dif, std::make_move_iterator(&temp), 1 );
+            }
             return MyIterator(storage+dif);
         }
 
@@ -528,21 +1079,16 @@ class vector {
         * @param first começo da seuqncia de dados
         * @param last o posterior ao fim da seuqncia de dados
         * @return um iterator para o local onde o dado foi inserido
+        * @note o tamanho final é calculado antes, então há no máximo uma realocação
         */
-        template <typename InputIterator>
+        template < typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category >
         MyIterator insert(MyIterator it, InputIterator first, InputIterator last){
-        	int size_list_temp = last-first;
-        	int dif = it-begin();
+        	size_t size_list_temp = std::distance( first, last );
+        	size_t dif = it-begin();
         	isCheia(size_list_temp);
 
-        	std::copy( &storage[dif], &storage[size_now],  &storage[dif+size_list_temp] ); // deslocando elementos size_list_temp 
-        	
-        	for (int i = 0; i < size_list_temp; ++i){
-        		storage[dif+i] = *first;
-        		first++;
-        	}
+        	insert_range( dif, first, size_list_temp );
 
-        	size_now += size_list_temp;
         	return MyIterator(storage+dif);
         }
 
@@ -553,19 +1099,17 @@ class vector {
         * @return um iterator para o local onde o dado foi inserido
         */
         MyIterator insert(MyIterator it,const std::initializer_list<T>& list){
-        	int dif = it-begin();
-        	isCheia(list.size());
-        	
-        	std::copy( &storage[dif], &storage[size_now],  &storage[dif+list.size()] ); // deslocando elementos list.size
-
-        	insert(MyIterator(&storage[dif]), list.begin(), list.end());
-        	
-        	return MyIterator(&storage[dif]);
+        	return insert( it, list.begin(), list.end() );
         }
 
-        /** @brief iguala a capacidade do vector a seu tamanho de elementos. */
+        /**
+        * @brief devolve ao alocador a memória que sobra: o bloco passa a ter exatamente size() elementos
+        *        (com realloc quando o alocador e o tipo permitem). O buffer interno de um small_vector é mantido
+        */
         void shrink_to_fit(void){
-            capacity_now = size_now;
+            if ( block() == inline_storage || block_capacity() == size_now ) return;
+            EDBI_STATS( stats_realloc_timer timer( stats_now, size_now*sizeof(T) ); )
+            reallocate_block( size_now );
         }
 
         /** @brief recria o vector para ser uma 'lista' de tamanho 'qtd', em que todos os dados são igual a 'value'
@@ -573,13 +1117,20 @@ class vector {
 		* @param value valor a ser copiado para todos os dados do vector
         */
         void assign(int qtd, const T & value ){
-            if ( capacity_now < qtd){
+            T temp( value ); // value pode ser um elemento do próprio vector
+            if ( capacity_now < (size_t) qtd ){
+                clear();
                 reserve(qtd);
             }
-            
-            for (int i = 0; i < qtd; i++){
-                storage[i] = value;
+
+            size_t i = 0;
+            for ( ; i < size_now && i < (size_t) qtd; i++){
+                storage[i] = temp;
+            }
+            for ( ; i < (size_t) qtd; i++, size_now++){
+                alloc_traits::construct( allocator, storage+i, temp );
             }
+            destroy( storage+qtd, storage+size_now );
 
             size_now = qtd;
         }
@@ -588,34 +1139,20 @@ class vector {
 		* @param list lista a ser igual a os dados do vector
         */
         void assign(const std::initializer_list<T>& list){
-            if ( capacity_now < list.size()){
-                reserve(list.size());
-            }
-            
-            std::copy( list.begin(), list.end(), storage);
-
-            size_now = list.size();
+            assign_copy( list.begin(), list.size() );
         }
 
 
         /** @brief recria o vector apartir de dois InputIterator
 		* @param first começo da lista a ser copiada
 		* @param last sucessor do fim da lista a ser copiada
+		* @note a capacidade, se precisar aumentar, vai direto para o tamanho da lista (uma realocação)
         */
-        template <typename InputIterator >
+        template < typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category >
         void assign(InputIterator first, InputIterator last ){
-            int size_list = last-first;
+            size_t size_list = std::distance( first, last );
 
-            if ( capacity_now < size_list){
-                reserve(size_list);
-            }
-            size_now = size_list;
-            
-            size_list = 0;
-            while(first != last){
-                storage[size_list++] = *first++;
-            }
-            
+            assign_copy( first, size_list );
         }
 
 		/**
@@ -624,18 +1161,84 @@ class vector {
         * @return um iterator para o local onde o dado foi removido
         */
         MyIterator erase(MyIterator it){
-            int size_temp = it - begin();
-            
-            if(size_temp == capacity_now){
-                pop_back();
-                return end();
-            }else if(size_temp == 0){
+            size_t size_temp = it - begin();
+
+            if ( size_temp == 0 ){
                 pop_front();
                 return begin();
-            }else{
-                std::copy( storage+(size_temp+1), storage+size_now, storage+size_temp);
-            	return MyIterator(storage+size_temp);
             }
+            erase_n( size_temp, 1, relocatable() );
+            shrink_if_underused( shrinks() );
+            return MyIterator(storage+size_temp);
+        }
+
+        /**
+        * @brief apaga os dados de [first, last) de uma vez: o final é deslocado uma única vez
+        * @param first primeiro dado apagado
+        * @param last sucessor do último dado apagado
+        * @return um iterator para o local onde os dados foram removidos
+        */
+        MyIterator erase(MyIterator first, MyIterator last){
+            size_t pos = first - begin();
+            size_t n = last - first;
+            if ( n == 0 ) return MyIterator(storage+pos);
+
+            if ( pos == 0 ){
+                // como no pop_front, os dados apagados viram espaço livre do começo.
+                destroy( storage, storage+n );
+                storage += n;
+                front_gap += n;
+                capacity_now -= n;
+                size_now -= n;
+                recenter_empty();
+                shrink_if_underused( shrinks() );
+                return begin();
+            }
+            erase_n( pos, n, relocatable() );
+            shrink_if_underused( shrinks() );
+            return MyIterator(storage+pos);
+        }
+
+        /**
+        * @brief apaga os dados em que pred(dado) é true, mantendo a ordem dos demais, numa única passada
+        * @param pred predicado chamado uma vez por dado
+        * @return quantidade de dados apagados
+        */
+        template < typename Predicate >
+        size_t erase_if( Predicate pred ){
+            size_t kept = compact_if( pred, std::is_trivially_copyable<T>() );
+            size_t removed = size_now - kept;
+            destroy( storage+kept, storage+size_now );
+            size_now = kept;
+            shrink_if_underused( shrinks() );
+            return removed;
+        }
+
+        /**
+        * @brief apaga os dados em que pred(dado) é true sem manter a ordem: cada buraco recebe um dado do final,
+        *        então só são movidos tantos dados quanto os apagados
+        * @param pred predicado chamado uma vez por dado
+        * @return quantidade de dados apagados
+        */
+        template < typename Predicate >
+        size_t erase_if_unordered( Predicate pred ){
+            size_t i = 0, j = size_now;
+            EDBI_STATS( size_t moves = 0; )
+            for (;;){
+                while ( i < j && !pred( storage[i] ) ) ++i;
+                if ( i == j ) break;
+                // storage[i] sai: procura, do final para trás, o último que fica.
+                do { --j; } while ( j > i && pred( storage[j] ) );
+                if ( j == i ) break;
+                storage[i++] = std::move( storage[j] );
+                EDBI_STATS( ++moves; )
+            }
+            EDBI_STATS( stats_moves( stats_now, moves ); )
+            size_t removed = size_now - j;
+            destroy( storage+j, storage+size_now );
+            size_now = j;
+            shrink_if_underused( shrinks() );
+            return removed;
         }
         // fim [IV]
 
@@ -648,7 +1251,7 @@ class vector {
         * @return uma referencia constante para o ultimo elemento do vector
         */
         const_reference back(void) const{
-            return ConstMyIterator(storage+size_now-1);
+            return storage[size_now-1];
         }
 
         /**
@@ -656,7 +1259,7 @@ class vector {
         * @return uma referencia para o ultimo elemento do vector
         */
         reference back(void){
-            return MyIterator(storage+size_now-1);
+            return storage[size_now-1];
         }
 
         /**
@@ -664,15 +1267,15 @@ class vector {
         * @return uma referencia constante para o primeiro elemento do vector
         */
         const_reference front(void) const{
-            return ConstMyIterator(storage);
+            return storage[0];
         }
 
         /**
-        * @brief primeiro elemento do vector 
+        * @brief primeiro elemento do vector
         * @return uma referencia para o primeiro elemento do vector
         */
         reference front(void){
-            return MyIterator(storage);
+            return storage[0];
         }
 
         /**
@@ -697,42 +1300,46 @@ class vector {
         * @brief referencia constante para um dado num indice
         * @param indice posicao a ser buscada
         * @return uma referencia constante para o dado da posição 'indice' elemento do vector
+        * @throw std::out_of_range se indice >= size()
         */
         const_reference at( size_type indice) const{
-            if(indice >= 0 && indice < size_now){
-                return storage[indice];
+            if ( indice >= size_now ){
+                throw std::out_of_range( "vector::at" );
             }
+            return storage[indice];
         }
 
         /**
         * @brief referencia para um dado num indice
         * @param indice posicao a ser buscada
         * @return uma referencia para o dado da posição 'indice' elemento do vector
+        * @throw std::out_of_range se indice >= size()
         */
         reference at( size_type indice){
-            if(indice >= 0 && indice < size_now){
-                return storage[indice];
+            if ( indice >= size_now ){
+                throw std::out_of_range( "vector::at" );
             }
+            return storage[indice];
         }
 
         /**
-        * @brief referencia para os dados
-        * @return referencia dos dados armazenados
+        * @brief ponteiro para os dados
+        * @return ponteiro para o primeiro elemento armazenado
         */
-        reference data(void){
+        pointer data(void){
             return storage;
         }
 
         /**
-        * @brief referencia constante para os dados
-        * @return referencia constante dos dados armazenados
+        * @brief ponteiro constante para os dados
+        * @return ponteiro constante para o primeiro elemento armazenado
         */
-        const_reference data(void) const{
+        const T * data(void) const{
             return storage;
         }
 
         // fim [V]
-   		
+
    		// [VII] Friend functions.
         /**
         * @brief mostra os dados do vector
@@ -740,7 +1347,7 @@ class vector {
         * @param v vector a ser mostrado
         * @return um ostream a ser mostrado
         */
-        friend ostream& operator<<(ostream& os, const vector<value_type>& v){
+        friend ostream& operator<<(ostream& os, const vector& v){
         	os << "[ ";
         	for (int i = 0; i < v.size(); ++i){
         		os << v[i];
@@ -751,8 +1358,566 @@ class vector {
    		// fim [VII]
         //---------------------------------------------------------------------------------------------------
 
+    protected:
+        /**
+        * @brief construtor para classes que guardam os primeiros elementos num buffer próprio (ex: small_vector)
+        * @param buffer memória bruta que não pertence ao alocador, nunca é liberada pelo vector
+        * @param buffer_cap quantidade de elementos que cabem em buffer
+        * @param alloc alocador usado quando os elementos não couberem mais em buffer
+        */
+        vector( pointer buffer, size_t buffer_cap, const Allocator& alloc ) :
+            allocator{ alloc },
+            storage{ buffer },
+            size_now { 0 },
+            capacity_now { buffer_cap },
+            front_gap{ 0 },
+            inline_storage{ buffer }
+        { /* empty */ }
+
+        /**
+        * @brief volta a usar o buffer próprio depois que a memória do vector foi tomada por um move
+        * @param buffer o mesmo buffer passado ao construtor
+        * @param buffer_cap quantidade de elementos que cabem em buffer
+        */
+        void use_buffer( pointer buffer, size_t buffer_cap ){
+            if ( storage != nullptr ) return;
+            storage = buffer;
+            capacity_now = buffer_cap;
+            front_gap = 0;
+        }
+
+        /**
+        * @brief traz os elementos de volta para o buffer próprio e devolve o bloco do alocador
+        * @param buffer o mesmo buffer passado ao construtor
+        * @param buffer_cap quantidade de elementos que cabem em buffer, no mínimo size()
+        */
+        void move_to_buffer( pointer buffer, size_t buffer_cap ){
+            if ( block() == buffer ) return;
+            relocate_to( buffer );
+            deallocate( block(), block_capacity() );
+            storage = buffer;
+            capacity_now = buffer_cap;
+            front_gap = 0;
+        }
+
+        /**
+        * @brief passa a usar um bloco do alocador que já contém elementos vivos (ex: mapped_vector reabrindo um arquivo).
+        *        O vector deve estar vazio e sem memória; o bloco será devolvido ao alocador como se ele o tivesse alocado
+        * @param p começo do bloco
+        * @param total quantidade de elementos que cabem no bloco
+        * @param gap posições livres antes do primeiro elemento
+        * @param count quantidade de elementos vivos a partir de p+gap
+        */
+        void adopt( pointer p, size_t total, size_t gap, size_t count ){
+            storage = p + gap;
+            front_gap = gap;
+            capacity_now = total - gap;
+            size_now = count;
+            EDBI_STATS( stats_size( stats_now, size_now ); )
+        }
+
     private:
+        typedef std::allocator_traits<Allocator> alloc_traits; //!< acesso uniforme ao alocador.
+        typedef std::integral_constant< bool, is_relocatable<T>::value > relocatable; //!< elementos podem ser movidos com memmove.
+        typedef std::integral_constant< bool, is_relocatable<T>::value
+                                              && allocator_can_reallocate<Allocator>::value > can_reallocate; //!< a memória pode crescer com realloc.
+        typedef std::integral_constant< bool, growth_policy_shrinks<GrowthPolicy>::value > shrinks; //!< a política devolve memória nas remoções.
+
+        // [VI] Memória bruta
+
+        /**
+        * @brief aloca memória bruta (sem construir elementos)
+        * @param n quantidade de elementos que cabem na memória
+        * @return ponteiro para a memória, ou nullptr se n == 0
+        */
+        pointer allocate( size_t n ){
+            EDBI_STATS( if ( n != 0 ) stats_allocation( stats_now, n*sizeof(T), n ); )
+            return ( n == 0 ) ? nullptr : alloc_traits::allocate( allocator, n );
+        }
+
+        /**
+        * @brief devolve ao alocador uma memória obtida com allocate
+        * @param p memória a ser devolvida
+        * @param n quantidade usada na alocação
+        */
+        void deallocate( pointer p, size_t n ){
+            if ( p != nullptr && p != inline_storage ) alloc_traits::deallocate( allocator, p, n );
+        }
+
+        /**
+        * @brief destroi no lugar os elementos de [first, last), a memória continua alocada
+        */
+        void destroy( pointer first, pointer last ){
+            for ( ; first != last; ++first ){
+                alloc_traits::destroy( allocator, first );
+            }
+        }
+
+        /** @brief começo do bloco alocado, antes do espaço livre do começo */
+        pointer block( void ) const{
+            return storage - front_gap;
+        }
+
+        /** @brief tamanho do bloco alocado, contando o espaço livre do começo */
+        size_t block_capacity( void ) const{
+            return front_gap + capacity_now;
+        }
+
+        /** @brief vector vazio: todo o espaço livre do começo volta para o fim */
+        void recenter_empty( void ){
+            if ( size_now != 0 || front_gap == 0 ) return;
+            storage -= front_gap;
+            capacity_now += front_gap;
+            front_gap = 0;
+        }
+
+        /**
+        * @brief desloca todos os elementos 'd' posições para trás, dentro do espaço livre do começo
+        * @param d deslocamento, no máximo front_gap
+        */
+        void shift_left( size_t d ){
+            EDBI_STATS( stats_moves( stats_now, size_now ); )
+            shift_left( d, relocatable() );
+            storage -= d;
+            front_gap -= d;
+            capacity_now += d;
+        }
+
+        void shift_left( size_t d, std::true_type ){
+            std::memmove( static_cast<void*>(storage-d), static_cast<void*>(storage), size_now*sizeof(T) );
+        }
+
+        void shift_left( size_t d, std::false_type ){
+            // destinos antes de storage são memória bruta (construidos), os demais são elementos vivos (atribuidos).
+            for ( size_t k = 0; k < size_now; ++k ){
+                if ( k < d ) alloc_traits::construct( allocator, storage+k-d, std::move( storage[k] ) );
+                else storage[k-d] = std::move( storage[k] );
+            }
+            destroy( storage + ( size_now > d ? size_now-d : 0 ), storage+size_now );
+        }
+
+        /**
+        * @brief desloca todos os elementos 'd' posições para frente, dentro do espaço livre do fim
+        * @param d deslocamento, no máximo capacity() - size()
+        */
+        void shift_right( size_t d ){
+            EDBI_STATS( stats_moves( stats_now, size_now ); )
+            shift_right( d, relocatable() );
+            storage += d;
+            front_gap += d;
+            capacity_now -= d;
+        }
+
+        void shift_right( size_t d, std::true_type ){
+            std::memmove( static_cast<void*>(storage+d), static_cast<void*>(storage), size_now*sizeof(T) );
+        }
+
+        void shift_right( size_t d, std::false_type ){
+            // de trás para frente; destinos depois do fim são memória bruta (construidos), os demais atribuidos.
+            for ( size_t k = size_now; k-- > 0; ){
+                if ( k+d >= size_now ) alloc_traits::construct( allocator, storage+k+d, std::move( storage[k] ) );
+                else storage[k+d] = std::move( storage[k] );
+            }
+            destroy( storage, storage + std::min( d, size_now ) );
+        }
+
+        /**
+        * @brief garante espaço livre antes do primeiro elemento. Se metade do bloco está livre os elementos
+        *        são deslocados para o meio dele; se não, um bloco maior é alocado com os elementos no meio.
+        *        Cada caso abre espaço proporcional ao tamanho, então push_front fica O(1) amortizado
+        */
+        void make_front_room( void ){
+            size_t total = block_capacity();
+            size_t free = total - size_now;
+            if ( free*2 >= total && free > 0 ){
+                shift_right( free - free/2 );
+                return;
+            }
+
+            EDBI_STATS( stats_growth( stats_now ); )
+            size_t new_total = std::max( size_now+1, GrowthPolicy::next_capacity( total, size_now+1, sizeof(T) ) );
+            size_t new_gap = std::max( (size_t) 1, ( new_total - size_now ) / 2 );
+            EDBI_STATS( stats_realloc_timer timer( stats_now, new_total*sizeof(T) ); )
+            // com reallocate o bloco cresce no lugar (ou no mesmo arquivo, ver mapped_vector) e os elementos vão para o meio.
+            if ( reallocate_to( new_total, can_reallocate() ) ){
+                shift_right( new_gap );
+                return;
+            }
+            T * temp = allocate( new_total );
+            try{
+                relocate_to( temp+new_gap );
+            }catch(...){
+                deallocate( temp, new_total );
+                throw;
+            }
+            deallocate( block(), block_capacity() );
+            storage = temp+new_gap;
+            front_gap = new_gap;
+            capacity_now = new_total - new_gap;
+        }
+
+        /**
+        * @brief próxima capacidade segundo a GrowthPolicy
+        * @param required quantidade mínima de elementos que precisa caber
+        */
+        size_t next_capacity( size_t required ) const{
+            return std::max( required, GrowthPolicy::next_capacity( capacity_now, required, sizeof(T) ) );
+        }
+
+        /**
+        * @brief move os elementos para a memória bruta 'dest' (copia se o move de T puder lançar)
+        *        e destroi os originais; em caso de exceção o vector continua intacto
+        * @param dest memória com espaço para size() elementos
+        */
+        void relocate_to( pointer dest ){
+            EDBI_STATS( stats_moves( stats_now, size_now ); )
+            relocate_to( dest, relocatable() );
+        }
+
+        void relocate_to( pointer dest, std::true_type ){
+            if ( size_now != 0 ) std::memcpy( static_cast<void*>(dest), static_cast<void*>(storage), size_now*sizeof(T) );
+        }
+
+        void relocate_to( pointer dest, std::false_type ){
+            size_t i = 0;
+            try{
+                for ( ; i < size_now; ++i ){
+                    alloc_traits::construct( allocator, dest+i, std::move_if_noexcept( storage[i] ) );
+                }
+            }catch(...){
+                destroy( dest, dest+i );
+                throw;
+            }
+            destroy( storage, storage+size_now );
+        }
+
+        /**
+        * @brief troca o bloco por um de exatamente 'new_cap' elementos (maior ou menor), sem espaço livre no começo
+        * @param new_cap nova capacidade, no mínimo size()
+        */
+        void reallocate_block( size_t new_cap ){
+            if ( new_cap == 0 ){
+                deallocate( block(), block_capacity() );
+                storage = nullptr;
+                capacity_now = 0;
+                front_gap = 0;
+                return;
+            }
+
+            // T relocável e alocador com realloc: o bloco muda no lugar, ou é movido pelo próprio realloc/mremap.
+            if ( reallocate_to( new_cap, can_reallocate() ) ) return;
+
+            // Passo 1: alocar nova memória (bruta) com tamanho solicitado.
+            T * temp = allocate( new_cap );
+
+            // Passo 2: mover (ou copiar, se o move puder lançar) os dados da memória antiga para a nova.
+            try{
+                relocate_to( temp );
+            }catch(...){
+                deallocate( temp, new_cap );
+                throw;
+            }
+
+            // Passo 3: liberar a memória antiga.
+            deallocate( block(), block_capacity() );
+
+            // Passo 4: Redirecionar ponteiro para a nova memória.
+            storage = temp;
+
+            // Passo 5: Atualizações internas.
+            capacity_now = new_cap;
+            front_gap = 0;
+        }
+
+        /**
+        * @brief depois de uma remoção, pergunta à política de crescimento se a capacidade deve diminuir
+        *        (só existe para políticas com shrink_capacity, ex: shrink_on_low_use)
+        */
+        void shrink_if_underused( std::true_type ){
+            if ( block() == inline_storage ) return;
+            size_t total = block_capacity();
+            size_t cap = GrowthPolicy::shrink_capacity( total, size_now, sizeof(T) );
+            if ( cap >= total ) return;
+            EDBI_STATS( stats_realloc_timer timer( stats_now, cap*sizeof(T) ); )
+            reallocate_block( std::max( cap, (size_t) size_now ) );
+        }
+
+        void shrink_if_underused( std::false_type ){ /* empty */ }
+
+        /**
+        * @brief constroi no fim do vector cópias de [first, last), a capacidade deve ser suficiente
+        */
+        template <typename InputIterator>
+        void construct_copy( InputIterator first, InputIterator last ){
+            EDBI_STATS( size_t old_size = size_now; )
+            for ( ; first != last; ++first, ++size_now ){
+                alloc_traits::construct( allocator, storage+size_now, *first );
+            }
+            EDBI_STATS( stats_written( stats_now, size_now-old_size, first ); stats_size( stats_now, size_now ); )
+        }
+
+        /**
+        * @brief constroi com make( ponteiro ) os dados de [size(), n), a capacidade deve ser suficiente. Se um
+        *        construtor lança, os já construidos são destruidos e o tamanho não muda
+        */
+        template < typename Make >
+        void append_constructed( size_t n, Make make ){
+            size_t i = size_now;
+            try{
+                for ( ; i < n; ++i ) make( storage+i );
+            }catch(...){
+                destroy( storage+size_now, storage+i );
+                throw;
+            }
+            size_now = n;
+            EDBI_STATS( stats_size( stats_now, size_now ); )
+        }
+
+        /** @brief apaga os dados de [n, size()) */
+        void shrink_to_size( size_t n ){
+            destroy( storage+n, storage+size_now );
+            size_now = n;
+            shrink_if_underused( shrinks() );
+        }
+
+        /**
+        * @brief substitui os elementos do vector por 'n' cópias a partir de first,
+        *        reaproveitando os elementos já construidos
+        */
+        template <typename InputIterator>
+        void assign_copy( InputIterator first, size_t n ){
+            if ( capacity_now < n ){
+                clear();
+                reserve(n);
+            }
+            EDBI_STATS( stats_written( stats_now, n, first ); stats_size( stats_now, n ); )
+
+            size_t i = 0;
+            for ( ; i < size_now && i < n; ++i, ++first ){
+                storage[i] = *first;
+            }
+            for ( ; i < n; ++i, ++first, ++size_now ){
+                alloc_traits::construct( allocator, storage+i, *first );
+            }
+            destroy( storage+n, storage+size_now );
+
+            size_now = n;
+        }
+
+        /**
+        * @brief abre espaço para 'n' elementos na posição 'pos' e copia para ele os dados a partir de first
+        *        (um move_iterator faz a inserção por move); a capacidade deve ser suficiente.
+        *        Os elementos deslocados são movidos; posições além do tamanho antigo são construidas, as demais atribuidas
+        */
+        template <typename InputIterator>
+        void insert_range( size_t pos, InputIterator first, size_t n ){
+            if ( n == 0 ) return;
+            EDBI_STATS( stats_written( stats_now, n, first ); stats_moves( stats_now, size_now-pos ); stats_size( stats_now, size_now+n ); )
+            insert_range( pos, first, n, relocatable() );
+        }
+
+        /** @brief insert_range para T relocável: desloca o final com um único memmove e constroi os novos no buraco */
+        template <typename InputIterator>
+        void insert_range( size_t pos, InputIterator first, size_t n, std::true_type ){
+            size_t tail = size_now - pos;
+            std::memmove( static_cast<void*>(storage+pos+n), static_cast<void*>(storage+pos), tail*sizeof(T) );
+
+            size_t i = 0;
+            try{
+                for ( ; i < n; ++i, ++first ){
+                    alloc_traits::construct( allocator, storage+pos+i, *first );
+                }
+            }catch(...){
+                // fecha o buraco, o vector volta a ser o que era.
+                destroy( storage+pos, storage+pos+i );
+                std::memmove( static_cast<void*>(storage+pos), static_cast<void*>(storage+pos+n), tail*sizeof(T) );
+                throw;
+            }
+            size_now += n;
+        }
+
+        template <typename InputIterator>
+        void insert_range( size_t pos, InputIterator first, size_t n, std::false_type ){
+            pointer old_end = storage+size_now;
+            size_t tail = size_now - pos;
+
+            if ( tail > n ){
+                // os n últimos vão para a memória bruta, o resto desloca entre elementos vivos.
+                for ( size_t i = 0; i < n; ++i ){
+                    alloc_traits::construct( allocator, old_end+i, std::move( *(old_end-n+i) ) );
+                }
+                size_now += n;
+                std::move_backward( storage+pos, old_end-n, old_end );
+                for ( size_t i = 0; i < n; ++i, ++first ){
+                    storage[pos+i] = *first;
+                }
+            }else{
+                // todo o final vai para a memória bruta, parte dos novos dados também.
+                for ( size_t i = 0; i < tail; ++i ){
+                    alloc_traits::construct( allocator, storage+pos+n+i, std::move( storage[pos+i] ) );
+                }
+                size_t i = 0;
+                for ( ; i < tail; ++i, ++first ){
+                    storage[pos+i] = *first;
+                }
+                for ( ; i < n; ++i, ++first ){
+                    alloc_traits::construct( allocator, storage+pos+i, *first );
+                }
+                size_now += n;
+            }
+        }
+
+        /**
+        * @brief remove os 'n' elementos a partir de 'pos', trazendo o final para trás
+        * @param pos posição do primeiro elemento removido
+        * @param n quantidade de elementos removidos
+        */
+        void erase_n( size_t pos, size_t n, std::true_type ){
+            EDBI_STATS( stats_moves( stats_now, size_now-pos-n ); )
+            destroy( storage+pos, storage+pos+n );
+            std::memmove( static_cast<void*>(storage+pos), static_cast<void*>(storage+pos+n), (size_now-pos-n)*sizeof(T) );
+            size_now -= n;
+        }
+
+        void erase_n( size_t pos, size_t n, std::false_type ){
+            EDBI_STATS( stats_moves( stats_now, size_now-pos-n ); )
+            std::move( storage+pos+n, storage+size_now, storage+pos );
+            destroy( storage+size_now-n, storage+size_now );
+            size_now -= n;
+        }
+
+        /**
+        * @brief junta no começo os dados em que pred é false, na ordem
+        * @return quantidade de dados mantidos; [retorno, size_now) fica para ser destruido
+        */
+        template < typename Predicate >
+        size_t compact_if( Predicate& pred, std::true_type ){
+            // tipo trivialmente copiável: sem desvio por dado, cada um é copiado e a posição de escrita só
+            // avança se ele fica. Até o primeiro apagado nada precisa ser escrito.
+            size_t r = 0;
+            while ( r < size_now && !pred( storage[r] ) ) ++r;
+            if ( r == size_now ) return r;
+            // storage[r] já foi testado e sai: a compactação começa no seguinte.
+            EDBI_STATS( size_t first = r; )
+            size_t w = r;
+            for ( ++r; r < size_now; ++r ){
+                T x = storage[r];
+                storage[w] = x;
+                w += !pred( x );
+            }
+            EDBI_STATS( stats_moves( stats_now, w-first ); )
+            return w;
+        }
+
+        template < typename Predicate >
+        size_t compact_if( Predicate& pred, std::false_type ){
+            size_t r = 0;
+            while ( r < size_now && !pred( storage[r] ) ) ++r;
+            if ( r == size_now ) return r;
+            EDBI_STATS( size_t first = r; )
+            size_t w = r;
+            for ( ++r; r < size_now; ++r ){
+                if ( !pred( storage[r] ) ) storage[w++] = std::move( storage[r] );
+            }
+            EDBI_STATS( stats_moves( stats_now, w-first ); )
+            return w;
+        }
+
+        /**
+        * @brief aumenta a capacidade com o reallocate do alocador, sem mover os elementos um a um
+        * @return false se o alocador/tipo não permite, nesse caso nada é feito
+        */
+        bool reallocate_to( size_t new_cap, std::true_type ){
+            if ( block() == inline_storage ) return false; // o buffer interno não veio do alocador
+            // o realloc mantém o bloco inteiro, então o espaço livre do começo é fechado antes (um memmove).
+            if ( front_gap != 0 ) shift_left( front_gap );
+            EDBI_STATS( stats_allocation( stats_now, new_cap*sizeof(T), new_cap ); stats_moves( stats_now, size_now ); )
+            storage = allocator.reallocate( storage, capacity_now, new_cap );
+            capacity_now = new_cap;
+            return true;
+        }
+
+        bool reallocate_to( size_t, std::false_type ){
+            return false;
+        }
+
+        /**
+        * @brief emplace_back com o vector cheio. Os argumentos podem referenciar elementos do próprio vector:
+        *        o novo elemento é construido antes da memória antiga ser liberada
+        */
+        template <typename... Args>
+        void grow_and_emplace( std::true_type, Args&&... args ){
+            // realloc pode liberar o bloco antigo, então o valor é construido fora dele primeiro.
+            T temp( std::forward<Args>(args)... );
+            reserve( next_capacity( size_now+1 ) );
+            alloc_traits::construct( allocator, storage+size_now, std::move(temp) );
+        }
+
+        template <typename... Args>
+        void grow_and_emplace( std::false_type, Args&&... args ){
+            size_t new_cap = next_capacity( size_now+1 );
+            EDBI_STATS( stats_realloc_timer timer( stats_now, new_cap*sizeof(T) ); )
+            T * temp = allocate( new_cap );
+            try{
+                alloc_traits::construct( allocator, temp+size_now, std::forward<Args>(args)... );
+            }catch(...){
+                deallocate( temp, new_cap );
+                throw;
+            }
+            try{
+                relocate_to( temp );
+            }catch(...){
+                alloc_traits::destroy( allocator, temp+size_now );
+                deallocate( temp, new_cap );
+                throw;
+            }
+            deallocate( block(), block_capacity() );
+            storage = temp;
+            capacity_now = new_cap;
+            front_gap = 0;
+        }
+
+        /** @brief troca o alocador na atribuição, apenas se o alocador pede propagação */
+        void copy_allocator( const Allocator& a, std::true_type ){ allocator = a; }
+        void copy_allocator( const Allocator&, std::false_type ){ /* empty */ }
+
+        /** @brief troca o alocador no move, apenas se o alocador pede propagação */
+        void move_allocator( Allocator& a, std::true_type ){ allocator = std::move(a); }
+        void move_allocator( Allocator&, std::false_type ){ /* empty */ }
+
+        // fim [VI]
+
+        Allocator allocator; //!< Alocador da memória de armazenamento.
         T * storage; //!< Area de armazenamento.
         size_t size_now; //!< Número de elementos atualmente no vector.
         size_t capacity_now; //!< Capacidade máxima (atual) do vector.
-};
\ No newline at end of file
+        size_t front_gap; //!< Posições livres antes do primeiro elemento, tornam push_front/pop_front O(1).
+        T * inline_storage; //!< Buffer que não pertence ao alocador (small_vector), ou nullptr.
+#ifdef EDBI_VECTOR_STATS
+        vector_stats stats_now; //!< Contadores deste vector.
+#endif
+};
+
+//---------------------------------------------------------------------------------------------------
+
+// [Remoção condicional]
+
+/**
+* @brief apaga de v os dados em que pred(dado) é true, mantendo a ordem, como o std::erase_if
+* @return quantidade de dados apagados
+*/
+template < typename T, typename Allocator, typename GrowthPolicy, typename Predicate >
+size_t erase_if( ::vector<T, Allocator, GrowthPolicy>& v, Predicate pred ){
+    return v.erase_if( pred );
+}
+
+/**
+* @brief apaga de v os dados iguais a value, mantendo a ordem, como o std::erase
+* @return quantidade de dados apagados
+*/
+template < typename T, typename Allocator, typename GrowthPolicy, typename U >
+size_t erase( ::vector<T, Allocator, GrowthPolicy>& v, const U& value ){
+    return v.erase_if( [&value]( const T& x ){ return x == value; } );
+}
+
+// fim [Remoção condicional]
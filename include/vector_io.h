@@ -0,0 +1,535 @@
+/*! @file vector_io.h
+    @brief gravação e leitura do vector em binário (em bloco ou em pedaços) e em texto com std::to_chars.
+
+    Formato binário (versão 1), todos os campos no endian de quem gravou:
+    - cabeçalho de 32 bytes: vector_io_header
+    - em bloco: 'count' elementos seguidos, escritos de uma vez a partir de data()
+    - em pedaços (count == vector_io_chunked): sequência de [uint64 n][n elementos], terminada por n == 0;
+      quem grava não precisa saber o total e quem lê pode processar um pedaço de cada vez
+    Só para T trivialmente copiável. Na leitura, um arquivo do outro endian é convertido se T for aritmético.
+    Destinos e origens: descritor (int), FILE* ou std::ostream/std::istream. Erros lançam std::system_error.
+    append_from lê bytes crus de um descritor (read/pread) direto no espaço livre do fim do vector.
+*/
+
+#ifndef CHARCONV
+#define CHARCONV
+#include <charconv>
+#endif
+
+#ifndef CSTDINT
+#define CSTDINT
+#include <cstdint>
+#endif
+
+#ifndef CSTDIO
+#define CSTDIO
+#include <cstdio>
+#endif
+
+#ifndef CSTRING
+#define CSTRING
+#include <cstring>
+#endif
+
+#ifndef CERRNO
+#define CERRNO
+#include <cerrno>
+#endif
+
+#ifndef IOSTREAM
+#define IOSTREAM
+#include <iostream>
+#endif
+
+#ifndef SYSTEM_ERROR
+#define SYSTEM_ERROR
+#include <system_error>
+#endif
+
+#ifndef UNISTD_H
+#define UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "vector.h"
+#endif
+
+// [I] Formato
+
+/*! @brief cabeçalho do formato binário */
+struct vector_io_header {
+    char magic[8];  //!< "EDBIVIO" e um '\0'
+    uint32_t version;  //!< versão do formato, hoje 1
+    uint32_t flags;  //!< bit 0: gravado em little endian
+    uint32_t element_size;  //!< sizeof(T) de quem gravou
+    uint32_t reserved;  //!< zero
+    uint64_t count;  //!< quantidade de elementos, ou vector_io_chunked
+};
+
+static_assert( sizeof(vector_io_header) == 32, "cabecalho deve ter 32 bytes" );
+
+const uint64_t vector_io_chunked = ~uint64_t(0); //!< count de um arquivo gravado em pedaços
+const uint32_t vector_io_little = 1; //!< flag: little endian
+
+/** @brief endian desta máquina, no formato do campo flags */
+inline uint32_t vector_io_host_flags( void ){
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return 0;
+#else
+    return vector_io_little;
+#endif
+}
+
+/** @brief erro de formato ou de E/S */
+[[noreturn]] inline void vector_io_fail( const char * what, int e = EINVAL ){
+    throw std::system_error( e, std::generic_category(), std::string( "vector_io: " ) + what );
+}
+
+/** @brief inverte os bytes de cada um dos n elementos de 'size' bytes em p */
+inline void vector_io_swap( void * p, size_t n, size_t size ){
+    unsigned char * b = static_cast<unsigned char*>( p );
+    for ( size_t i = 0; i < n; ++i, b += size ){
+        for ( size_t k = 0; k < size/2; ++k ) std::swap( b[k], b[size-1-k] );
+    }
+}
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Destinos e origens
+
+/*! @brief grava num descritor, repetindo enquanto a escrita for parcial */
+struct fd_sink {
+    int fd;
+    void write( const void * p, size_t n ){
+        const char * c = static_cast<const char*>( p );
+        while ( n > 0 ){
+            ssize_t w = ::write( fd, c, n );
+            if ( w < 0 && errno == EINTR ) continue;
+            if ( w <= 0 ) vector_io_fail( "write", errno );
+            c += w;
+            n -= (size_t) w;
+        }
+    }
+};
+
+/*! @brief grava num FILE* */
+struct file_sink {
+    FILE * f;
+    void write( const void * p, size_t n ){
+        if ( n != 0 && std::fwrite( p, 1, n, f ) != n ) vector_io_fail( "fwrite", errno ? errno : EIO );
+    }
+};
+
+/*! @brief grava num std::ostream */
+struct ostream_sink {
+    std::ostream& os;
+    void write( const void * p, size_t n ){
+        if ( !os.write( static_cast<const char*>( p ), (std::streamsize) n ) ) vector_io_fail( "ostream::write", EIO );
+    }
+};
+
+/*! @brief lê de um descritor; read devolve menos que n só no fim do arquivo */
+struct fd_source {
+    int fd;
+    size_t read( void * p, size_t n ){
+        char * c = static_cast<char*>( p );
+        size_t got = 0;
+        while ( got < n ){
+            ssize_t r = ::read( fd, c+got, n-got );
+            if ( r < 0 && errno == EINTR ) continue;
+            if ( r < 0 ) vector_io_fail( "read", errno );
+            if ( r == 0 ) break;
+            got += (size_t) r;
+        }
+        return got;
+    }
+};
+
+/*! @brief lê de um FILE* */
+struct file_source {
+    FILE * f;
+    size_t read( void * p, size_t n ){
+        size_t got = std::fread( p, 1, n, f );
+        if ( got < n && std::ferror( f ) ) vector_io_fail( "fread", errno ? errno : EIO );
+        return got;
+    }
+};
+
+/*! @brief lê de um std::istream */
+struct istream_source {
+    std::istream& is;
+    size_t read( void * p, size_t n ){
+        is.read( static_cast<char*>( p ), (std::streamsize) n );
+        if ( is.bad() ) vector_io_fail( "istream::read", EIO );
+        return (size_t) is.gcount();
+    }
+};
+
+inline fd_sink io_sink( int fd ){ return fd_sink{ fd }; }
+inline file_sink io_sink( FILE * f ){ return file_sink{ f }; }
+inline ostream_sink io_sink( std::ostream& os ){ return ostream_sink{ os }; }
+
+inline fd_source io_source( int fd ){ return fd_source{ fd }; }
+inline file_source io_source( FILE * f ){ return file_source{ f }; }
+inline istream_source io_source( std::istream& is ){ return istream_source{ is }; }
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] Binário
+
+/** @brief cabeçalho para 'count' elementos de T */
+template < typename T >
+vector_io_header vector_io_make_header( uint64_t count ){
+    vector_io_header h;
+    std::memcpy( h.magic, "EDBIVIO", 8 );
+    h.version = 1;
+    h.flags = vector_io_host_flags();
+    h.element_size = (uint32_t) sizeof(T);
+    h.reserved = 0;
+    h.count = count;
+    return h;
+}
+
+/**
+* @brief grava o vector: cabeçalho e os elementos numa única escrita
+* @param v vector
+* @param out descritor, FILE* ou std::ostream
+*/
+template < typename T, typename A, typename G, typename Out >
+void write_to( const ::vector<T, A, G>& v, Out&& out ){
+    static_assert( std::is_trivially_copyable<T>::value, "write_to grava bytes: T precisa ser trivialmente copiavel" );
+    auto sink = io_sink( out );
+    vector_io_header h = vector_io_make_header<T>( v.size() );
+    sink.write( &h, sizeof(h) );
+    sink.write( v.data(), v.size()*sizeof(T) );
+}
+
+/*! @brief grava em pedaços, sem saber o total antes: write() quantas vezes precisar e close() no fim
+    @tparam T tipo dos elementos
+    @tparam Sink fd_sink, file_sink ou ostream_sink
+*/
+template < typename T, typename Sink >
+class chunked_writer {
+    public:
+        static_assert( std::is_trivially_copyable<T>::value, "chunked_writer grava bytes: T precisa ser trivialmente copiavel" );
+
+        /** @brief grava o cabeçalho */
+        explicit chunked_writer( Sink s ) : sink( s ), closed{ false } {
+            vector_io_header h = vector_io_make_header<T>( vector_io_chunked );
+            sink.write( &h, sizeof(h) );
+        }
+
+        chunked_writer( const chunked_writer& ) = delete;
+        chunked_writer& operator=( const chunked_writer& ) = delete;
+
+        /** @brief grava o terminador se close() não foi chamado; erros aqui são ignorados */
+        ~chunked_writer(){
+            if ( closed ) return;
+            try{ close(); }catch(...){ /* empty */ }
+        }
+
+        /**
+        * @brief grava um pedaço
+        * @param p elementos
+        * @param n quantidade de elementos; pedaços vazios são ignorados
+        */
+        void write( const T * p, size_t n ){
+            if ( n == 0 ) return;
+            uint64_t len = n;
+            sink.write( &len, sizeof(len) );
+            sink.write( p, n*sizeof(T) );
+        }
+
+        /** @brief grava o terminador */
+        void close( void ){
+            closed = true;
+            uint64_t zero = 0;
+            sink.write( &zero, sizeof(zero) );
+        }
+
+    private:
+        Sink sink; //!< destino
+        bool closed; //!< terminador já gravado
+};
+
+/**
+* @brief cria um chunked_writer para o destino
+* @param out descritor, FILE* ou std::ostream
+*/
+template < typename T, typename Out >
+chunked_writer< T, decltype( io_sink( std::declval<Out&>() ) ) > make_chunked_writer( Out&& out ){
+    return chunked_writer< T, decltype( io_sink( std::declval<Out&>() ) ) >( io_sink( out ) );
+}
+
+/**
+* @brief grava o vector em pedaços de no máximo 'chunk' elementos
+* @param v vector
+* @param out descritor, FILE* ou std::ostream
+* @param chunk elementos por pedaço (padrão: 1MB de dados)
+*/
+template < typename T, typename A, typename G, typename Out >
+void write_chunked( const ::vector<T, A, G>& v, Out&& out, size_t chunk = ( 1 << 20 ) / sizeof(T) + 1 ){
+    chunked_writer< T, decltype( io_sink( out ) ) > w( io_sink( out ) );
+    for ( size_t i = 0; i < v.size(); i += chunk ){
+        w.write( v.data()+i, std::min( chunk, v.size()-i ) );
+    }
+    w.close();
+}
+
+/**
+* @brief lê e confere o cabeçalho
+* @param source origem
+* @param swap recebe true se o arquivo é do outro endian
+* @return o cabeçalho, com count já no endian desta máquina
+*/
+template < typename T, typename Source >
+vector_io_header vector_io_read_header( Source& source, bool& swap ){
+    vector_io_header h;
+    if ( source.read( &h, sizeof(h) ) != sizeof(h) ) vector_io_fail( "cabecalho incompleto" );
+    if ( std::memcmp( h.magic, "EDBIVIO", 8 ) != 0 ) vector_io_fail( "cabecalho invalido" );
+    swap = ( h.flags & vector_io_little ) != vector_io_host_flags();
+    if ( swap ){
+        vector_io_swap( &h.version, 1, sizeof(h.version) );
+        vector_io_swap( &h.element_size, 1, sizeof(h.element_size) );
+        vector_io_swap( &h.count, 1, sizeof(h.count) );
+        if ( !std::is_arithmetic<T>::value ) vector_io_fail( "endian diferente e T nao aritmetico" );
+    }
+    if ( h.version != 1 ) vector_io_fail( "versao desconhecida" );
+    if ( h.element_size != sizeof(T) ) vector_io_fail( "sizeof(T) diferente do gravado" );
+    return h;
+}
+
+/**
+* @brief lê os elementos depois do cabeçalho e os entrega em pedaços de até 1MB
+* @param source origem, logo depois do cabeçalho
+* @param h cabeçalho lido por vector_io_read_header
+* @param swap arquivo do outro endian
+* @param f chamada com (const T*, size_t) para cada pedaço, em ordem
+* @return total de elementos lidos
+*/
+template < typename T, typename Source, typename F >
+size_t vector_io_read_body( Source& source, const vector_io_header& h, bool swap, F& f ){
+    size_t buffer_elems = ( 1 << 20 ) / sizeof(T) + 1;
+    if ( h.count != vector_io_chunked && h.count < buffer_elems ) buffer_elems = std::max<size_t>( (size_t) h.count, 1 );
+    ::vector<T> buffer;
+    buffer.reserve( buffer_elems );
+    T * buf = buffer.data();
+
+    // lê 'n' elementos, um buffer de cada vez.
+    auto pump = [&]( uint64_t n ){
+        while ( n > 0 ){
+            size_t k = (size_t) std::min<uint64_t>( n, buffer_elems );
+            if ( source.read( buf, k*sizeof(T) ) != k*sizeof(T) ) vector_io_fail( "dados incompletos" );
+            if ( swap ) vector_io_swap( buf, k, sizeof(T) );
+            f( static_cast<const T*>( buf ), k );
+            n -= k;
+        }
+    };
+
+    if ( h.count != vector_io_chunked ){
+        pump( h.count );
+        return (size_t) h.count;
+    }
+    size_t total = 0;
+    for (;;){
+        uint64_t n;
+        if ( source.read( &n, sizeof(n) ) != sizeof(n) ) vector_io_fail( "pedaco incompleto" );
+        if ( swap ) vector_io_swap( &n, 1, sizeof(n) );
+        if ( n == 0 ) return total;
+        pump( n );
+        total += (size_t) n;
+    }
+}
+
+/**
+* @brief lê um arquivo binário (em bloco ou em pedaços) sem montar um vector, um pedaço de até 1MB por vez
+* @param in descritor, FILE* ou std::istream
+* @param f chamada com (const T*, size_t) para cada pedaço, em ordem
+* @return total de elementos lidos
+*/
+template < typename T, typename In, typename F >
+size_t read_chunks( In&& in, F f ){
+    static_assert( std::is_trivially_copyable<T>::value, "read_chunks le bytes: T precisa ser trivialmente copiavel" );
+    auto source = io_source( in );
+    bool swap = false;
+    vector_io_header h = vector_io_read_header<T>( source, swap );
+    return vector_io_read_body<T>( source, h, swap, f );
+}
+
+/**
+* @brief lê 'n' elementos direto para o espaço livre do fim do vector (spare_capacity), sem buffer intermediário.
+*        O espaço é reservado antes da leitura: n não deve vir direto do arquivo, quem chama o limita a uma parte
+*/
+template < typename T, typename A, typename G, typename Source >
+void vector_io_read_into( ::vector<T, A, G>& v, Source& source, size_t n, bool swap ){
+    T * p = v.spare_capacity( n );
+    if ( source.read( p, n*sizeof(T) ) != n*sizeof(T) ) vector_io_fail( "dados incompletos" );
+    if ( swap ) vector_io_swap( p, n, sizeof(T) );
+    v.commit_spare( n );
+}
+
+/**
+* @brief lê um arquivo binário (em bloco ou em pedaços), acrescentando os elementos ao fim do vector. Os bytes
+*        vão da origem direto para a memória do vector, em partes de até 1MB, que só reservam espaço para o
+*        que já foi lido mais uma parte. Se a leitura falha, o vector mantém os elementos das partes lidas
+* @param v vector
+* @param in descritor, FILE* ou std::istream
+* @return quantidade de elementos lidos
+*/
+template < typename T, typename A, typename G, typename In >
+size_t read_from( ::vector<T, A, G>& v, In&& in ){
+    static_assert( std::is_trivially_copyable<T>::value, "read_from le bytes: T precisa ser trivialmente copiavel" );
+    auto source = io_source( in );
+    bool swap = false;
+    vector_io_header h = vector_io_read_header<T>( source, swap );
+    // as quantidades gravadas (total em bloco ou tamanho de pedaço) vêm do arquivo e podem estar corrompidas:
+    // lidas em partes de até 1MB, para que uma quantidade falsa falhe na leitura antes de reservar memória demais.
+    const size_t part = ( 1 << 20 ) / sizeof(T) + 1;
+    auto read_parts = [&]( uint64_t n ){
+        for ( uint64_t left = n; left > 0; ){
+            size_t k = (size_t) std::min<uint64_t>( left, part );
+            vector_io_read_into( v, source, k, swap );
+            left -= k;
+        }
+    };
+    if ( h.count != vector_io_chunked ){
+        read_parts( h.count );
+        return (size_t) h.count;
+    }
+    size_t total = 0;
+    for (;;){
+        uint64_t n;
+        if ( source.read( &n, sizeof(n) ) != sizeof(n) ) vector_io_fail( "pedaco incompleto" );
+        if ( swap ) vector_io_swap( &n, 1, sizeof(n) );
+        if ( n == 0 ) return total;
+        read_parts( n );
+        total += (size_t) n;
+    }
+}
+
+// fim [III]
+
+//---------------------------------------------------------------------------------------------------
+
+// [IV] Texto
+
+/**
+* @brief grava os elementos como texto com std::to_chars (menor representação que volta ao mesmo valor),
+*        separados por 'sep', num buffer de 64KB descarregado de uma vez
+* @param v vector de T aritmético
+* @param out descritor, FILE* ou std::ostream
+* @param sep separador escrito depois de cada elemento
+*/
+template < typename T, typename A, typename G, typename Out >
+void write_text( const ::vector<T, A, G>& v, Out&& out, char sep = '\n' ){
+    static_assert( std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "write_text: T precisa ser numerico" );
+    auto sink = io_sink( out );
+    const size_t buffer_bytes = 1 << 16;
+    const size_t max_chars = 64; // maior texto de um número, com folga
+    char buffer[ buffer_bytes ];
+    char * cur = buffer;
+    const T * p = v.data();
+    for ( size_t i = 0; i < v.size(); ++i ){
+        if ( (size_t) ( buffer + buffer_bytes - cur ) < max_chars ){
+            sink.write( buffer, cur - buffer );
+            cur = buffer;
+        }
+        cur = std::to_chars( cur, buffer + buffer_bytes - 1, p[i] ).ptr;
+        *cur++ = sep;
+    }
+    sink.write( buffer, cur - buffer );
+}
+
+/**
+* @brief lê números em texto com std::from_chars, acrescentando-os ao fim do vector. Espaços, tabulações,
+*        quebras de linha, ',' e ';' separam os elementos
+* @param v vector de T aritmético
+* @param in descritor, FILE* ou std::istream
+* @return quantidade de elementos lidos
+* @throw std::system_error se um trecho não for um número de T válido
+*/
+template < typename T, typename A, typename G, typename In >
+size_t read_text( ::vector<T, A, G>& v, In&& in ){
+    static_assert( std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "read_text: T precisa ser numerico" );
+    auto source = io_source( in );
+    const size_t buffer_bytes = 1 << 16;
+    char buffer[ buffer_bytes ];
+    size_t kept = 0, count = 0;
+    auto is_sep = []( char c ){
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == ',' || c == ';';
+    };
+    for (;;){
+        size_t got = source.read( buffer + kept, buffer_bytes - kept );
+        size_t len = kept + got;
+        bool last = ( got == 0 || len < buffer_bytes );
+        const char * cur = buffer;
+        const char * end = buffer + len;
+        for (;;){
+            while ( cur != end && is_sep( *cur ) ) ++cur;
+            const char * tok = cur;
+            while ( cur != end && !is_sep( *cur ) ) ++cur;
+            if ( tok == cur ) break;
+            if ( cur == end && !last ){ cur = tok; break; } // número pode continuar no próximo bloco
+            T value;
+            const char * num = ( *tok == '+' ) ? tok+1 : tok;
+            std::from_chars_result r = std::from_chars( num, cur, value );
+            if ( r.ec != std::errc() || r.ptr != cur ) vector_io_fail( "numero invalido" );
+            v.push_back( value );
+            ++count;
+        }
+        kept = (size_t) ( end - cur );
+        if ( kept == buffer_bytes ) vector_io_fail( "numero longo demais" );
+        std::memmove( buffer, cur, kept );
+        if ( last ) return count;
+    }
+}
+
+// fim [IV]
+
+//---------------------------------------------------------------------------------------------------
+
+// [V] Bytes crus
+
+/**
+* @brief uma chamada de read (ou pread, se offset >= 0) com até max_bytes direto no fim do vector, sem
+*        preencher nem copiar: para ingestão de sockets, pipes e arquivos. Se a leitura devolve um elemento pela
+*        metade, lê o resto dele antes de voltar
+* @param v vector de T trivialmente copiável
+* @param fd descritor
+* @param max_bytes limite da leitura (arredondado para baixo a um múltiplo de sizeof(T))
+* @param offset posição no arquivo para pread, ou -1 para read na posição atual
+* @return quantidade de elementos acrescentados; 0 no fim do arquivo (ou se max_bytes < sizeof(T))
+* @throw std::system_error se read falha ou se o arquivo termina no meio de um elemento
+*/
+template < typename T, typename A, typename G >
+size_t append_from( ::vector<T, A, G>& v, int fd, size_t max_bytes, off_t offset = -1 ){
+    static_assert( std::is_trivially_copyable<T>::value, "append_from le bytes: T precisa ser trivialmente copiavel" );
+    size_t n = max_bytes / sizeof(T);
+    if ( n == 0 ) return 0;
+    char * p = reinterpret_cast<char*>( v.spare_capacity( n ) );
+    size_t want = n*sizeof(T), got = 0;
+    auto once = [&]( size_t k ){
+        for (;;){
+            ssize_t r = ( offset < 0 ) ? ::read( fd, p+got, k ) : ::pread( fd, p+got, k, offset + (off_t) got );
+            if ( r < 0 && errno == EINTR ) continue;
+            if ( r < 0 ) vector_io_fail( offset < 0 ? "read" : "pread", errno );
+            return (size_t) r;
+        }
+    };
+    got = once( want );
+    while ( got % sizeof(T) != 0 ){
+        size_t r = once( sizeof(T) - got % sizeof(T) );
+        if ( r == 0 ) vector_io_fail( "elemento incompleto" );
+        got += r;
+    }
+    v.commit_spare( got / sizeof(T) );
+    return got / sizeof(T);
+}
+
+// fim [V]
@@ -0,0 +1,181 @@
+/*! @file vector_stats.h
+    @brief contadores de alocação, realocação, cópias e moves do vector.
+
+    Só é usado quando o código é compilado com -DEDBI_VECTOR_STATS; sem a macro o vector não tem nenhum
+    membro ou instrução a mais. Cada evento é contado no próprio vector (vector::stats()) e no total
+    do programa (vector_global_stats()), que também guarda histogramas de tamanho e latência das realocações.
+*/
+
+#ifndef ATOMIC
+#define ATOMIC
+#include <atomic>
+#endif
+
+#ifndef CHRONO
+#define CHRONO
+#include <chrono>
+#endif
+
+#ifndef IOSTREAM
+#define IOSTREAM
+#include <iostream>
+#endif
+
+#ifndef ITERATOR
+#define ITERATOR
+#include <iterator>
+#endif
+
+/*! @brief contadores de um vector */
+struct vector_stats {
+    size_t allocations = 0;  //!< blocos pedidos ao alocador (inclui reallocate)
+    size_t bytes_allocated = 0;  //!< soma dos bytes pedidos ao alocador
+    size_t reallocations = 0;  //!< trocas de bloco (reserve ou crescimento automático)
+    size_t growths = 0;  //!< realocações disparadas pelo crescimento automático (isCheia/emplace_back cheio)
+    size_t copies = 0;  //!< elementos copiados para dentro do vector
+    size_t moves = 0;  //!< elementos movidos, no reserve e nos deslocamentos do insert/erase
+    size_t peak_capacity = 0;  //!< maior capacidade já alcançada
+    size_t peak_size = 0;  //!< maior tamanho já alcançado
+
+    /** @brief elementos reservados e nunca usados no pico: peak_capacity - peak_size */
+    size_t wasted( void ) const{
+        return peak_capacity - peak_size;
+    }
+};
+
+/*! @brief histograma em escala log2: o balde k conta valores em [2^k, 2^(k+1)) */
+class log2_histogram {
+    public:
+        static const int buckets = 64;  //!< quantidade de baldes
+
+        /** @brief conta um valor */
+        void add( size_t value ){
+            int k = 0;
+            while ( value > 1 ){ value >>= 1; ++k; }
+            count[k].fetch_add( 1, std::memory_order_relaxed );
+        }
+
+        /** @brief quantidade de valores no balde k */
+        size_t at( int k ) const{
+            return count[k].load( std::memory_order_relaxed );
+        }
+
+        /**
+        * @brief escreve os baldes não vazios, um por linha
+        * @param os destino
+        * @param unit unidade dos valores, ex: "B" ou "ns"
+        */
+        void dump( std::ostream& os, const char * unit ) const{
+            for ( int k = 0; k < buckets; ++k ){
+                size_t c = at(k);
+                if ( c == 0 ) continue;
+                os << "  [2^" << k << ", 2^" << (k+1) << ") " << unit << ": " << c << "\n";
+            }
+        }
+
+    private:
+        std::atomic<size_t> count[ buckets ] = {}; //!< contagem de cada balde
+};
+
+/*! @brief totais de todos os vectors do programa, podem ser atualizados de várias threads */
+struct vector_global_stats_t {
+    std::atomic<size_t> allocations{ 0 };  //!< ver vector_stats::allocations
+    std::atomic<size_t> bytes_allocated{ 0 };  //!< ver vector_stats::bytes_allocated
+    std::atomic<size_t> reallocations{ 0 };  //!< ver vector_stats::reallocations
+    std::atomic<size_t> growths{ 0 };  //!< ver vector_stats::growths
+    std::atomic<size_t> copies{ 0 };  //!< ver vector_stats::copies
+    std::atomic<size_t> moves{ 0 };  //!< ver vector_stats::moves
+    log2_histogram realloc_bytes;  //!< tamanho, em bytes, do bloco novo em cada realocação
+    log2_histogram realloc_ns;  //!< duração, em ns, de cada realocação
+
+    /** @brief escreve os totais e os histogramas */
+    void dump( std::ostream& os ) const{
+        os << "allocations: " << allocations.load() << "\n"
+           << "bytes_allocated: " << bytes_allocated.load() << "\n"
+           << "reallocations: " << reallocations.load() << "\n"
+           << "growths: " << growths.load() << "\n"
+           << "copies: " << copies.load() << "\n"
+           << "moves: " << moves.load() << "\n"
+           << "realloc_bytes:\n";
+        realloc_bytes.dump( os, "B" );
+        os << "realloc_ns:\n";
+        realloc_ns.dump( os, "ns" );
+    }
+};
+
+/** @brief totais do programa */
+inline vector_global_stats_t& vector_global_stats( void ){
+    static vector_global_stats_t g;
+    return g;
+}
+
+// [Registro dos eventos] chamados pelo vector
+
+/*! @brief diz se o iterator move os valores (std::move_iterator) em vez de copiar */
+template < typename It > struct is_move_iterator : std::false_type {};
+template < typename It > struct is_move_iterator< std::move_iterator<It> > : std::true_type {};
+
+/** @brief um bloco de 'bytes' foi pedido ao alocador, a capacidade passou a ser 'capacity' */
+inline void stats_allocation( vector_stats& s, size_t bytes, size_t capacity ){
+    s.allocations++;
+    s.bytes_allocated += bytes;
+    if ( capacity > s.peak_capacity ) s.peak_capacity = capacity;
+    vector_global_stats().allocations.fetch_add( 1, std::memory_order_relaxed );
+    vector_global_stats().bytes_allocated.fetch_add( bytes, std::memory_order_relaxed );
+}
+
+/** @brief o crescimento automático precisou realocar */
+inline void stats_growth( vector_stats& s ){
+    s.growths++;
+    vector_global_stats().growths.fetch_add( 1, std::memory_order_relaxed );
+}
+
+/** @brief 'n' elementos foram escritos a partir de dados de fora; moves se o iterator for um move_iterator */
+template < typename It >
+inline void stats_written( vector_stats& s, size_t n, It ){
+    if ( is_move_iterator<It>::value ){
+        s.moves += n;
+        vector_global_stats().moves.fetch_add( n, std::memory_order_relaxed );
+    }else{
+        s.copies += n;
+        vector_global_stats().copies.fetch_add( n, std::memory_order_relaxed );
+    }
+}
+
+/** @brief 'n' elementos foram movidos dentro do vector (realocação ou deslocamento) */
+inline void stats_moves( vector_stats& s, size_t n ){
+    s.moves += n;
+    vector_global_stats().moves.fetch_add( n, std::memory_order_relaxed );
+}
+
+/** @brief o vector passou a ter 'size' elementos */
+inline void stats_size( vector_stats& s, size_t size ){
+    if ( size > s.peak_size ) s.peak_size = size;
+}
+
+/*! @brief mede uma realocação do início ao fim do escopo */
+class stats_realloc_timer {
+    public:
+        /**
+        * @param s contadores do vector
+        * @param bytes tamanho do bloco novo
+        */
+        stats_realloc_timer( vector_stats& s, size_t bytes )
+            : stats( s ), bytes( bytes ), start( std::chrono::steady_clock::now() )
+        { /* empty */ }
+
+        ~stats_realloc_timer(){
+            size_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+            stats.reallocations++;
+            vector_global_stats().reallocations.fetch_add( 1, std::memory_order_relaxed );
+            vector_global_stats().realloc_bytes.add( bytes );
+            vector_global_stats().realloc_ns.add( ns );
+        }
+
+    private:
+        vector_stats& stats; //!< contadores do vector
+        size_t bytes; //!< tamanho do bloco novo
+        std::chrono::steady_clock::time_point start; //!< início da realocação
+};
+
+// fim [Registro dos eventos]
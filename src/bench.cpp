@@ -0,0 +1,1578 @@
+/*! @file bench.cpp
+    @brief microbenchmarks do vector comparado ao std::vector.
+
+    Uso: ./bench [max_n] [--json] [grupo]
+    - max_n: maior tamanho testado (padrão 1000000, vai de 10 até max_n multiplicando por 10)
+    - --json: resultado em JSON, o padrão é CSV
+    - grupo: roda apenas as operações cujo nome começa com 'grupo', ex: push_back
+    - o grupo scan compara os kernels de simd.h (edbi_ns) com os algoritmos da std (std_ns) para int, float
+      e double; antes de medir, confere cada conjunto de instruções com simd::scalar e acusa divergências
+    - o grupo parallel compara os algoritmos de parallel.h (edbi_ns) com os sequenciais da std (std_ns) para
+      int e double, no pool padrão (uma thread por núcleo), e confere reduce e sort com o resultado da std
+    - o grupo io compara vector_io.h (edbi_ns) com fwrite/fread do std::vector e com o operator<< por elemento
+      (std_ns), num arquivo temporário (page cache, não o disco); io_ingest lê os dados em preads de 64KB com
+      append_from contra resize (que zera) seguido de pread no std::vector; confere a volta dos dados
+    - o grupo concurrent mede n push_back divididos entre 1, 2, 4, ... threads (até o dobro dos núcleos) no
+      concurrent_vector (edbi_ns) e num std::vector protegido por std::mutex (std_ns); a operação leva o número
+      de threads no nome, ex: concurrent_push_8
+    - o grupo algo roda std::sort, std::copy e std::lower_bound pelos iterators dos dois containers; os iterators
+      do vector são contíguos (conferido com static_assert). A libstdc++ 12 só troca std::copy por memmove nos
+      seus próprios iterators, então ali algo_copy de tipos triviais fica atrás do std::vector
+    - o grupo huge lê 2^20 posições aleatórias de um vector<size_t> de n elementos com aligned_allocator (64B e
+      páginas enormes a partir de 2MB) contra std::vector; passe um max_n grande (ex: 100000000 = 800MB) para
+      ver o efeito do TLB; confere o alinhamento do bloco e a soma lida
+    - o grupo shrink faz n push_back seguidos de n pop_back num vector com shrink_on_low_use contra std::vector,
+      que nunca devolve memória; confere que a capacidade final voltou ao mínimo da política
+    - o grupo soa soma um campo int de n registros de 64 bytes: soa_vector (edbi_ns, simd::sum na coluna) contra
+      std::vector<record> (std_ns, laço nos structs); soa_push_back mede a construção dos n registros. Confere
+      as duas somas
+    - o grupo flat compara flat_map<int, int> com std::map<int, int> (std_ns): flat_build monta o mapa com n
+      chaves embaralhadas (insert(first, last) contra n insert), flat_find e flat_eytzinger fazem 4096 buscas
+      aleatórias (metade presentes) com branchless_search e eytzinger_search; confere os valores achados
+    - o grupo cow entrega um vector de n ints a 16 leitores que somam seus elementos: cow_copy copia um
+      cow_vector (O(1), edbi_ns) contra copiar o std::vector (std_ns); cow_snapshot faz n push_back tirando um
+      snapshot() a cada 4096, contra copiar o std::vector a cada 4096. Confere as somas
+    - o grupo static monta n lotes de 32 ints (push_back, insert no começo, erase de um) e soma cada um:
+      static_vector<int, 32> (edbi_ns) contra std::vector<int> com reserve(32) (std_ns); confere as somas
+    - o grupo packed compara packed_vector (edbi_ns) com o std::vector do tipo cheio (std_ns): packed_scan soma
+      n ids de 17 bits em uint32_t com for_each (desempacotamento de simd), packed_random lê 4096 posições
+      aleatórias com operator[] e packed_for_scan soma n timestamps crescentes em frame_of_reference<>. Confere
+      as somas e que os dois packed_vector ocupam menos memória (timestamps: menos da metade)
+    - o grupo latency cronometra cada um de n push_back num vector vazio e mostra o histograma: uma linha por
+      percentil (latency_p50, latency_p99, latency_p99.9, latency_p99.99, latency_max) com o tempo de um
+      push_back no incremental_vector (edbi_ns) e no std::vector (std_ns); o máximo do std::vector é a cópia
+      do último crescimento. Confere as somas
+    - o grupo pmr constroi e descarta 16 vectors de n push_back por repetição: pmr_vector numa arena zerada a
+      cada repetição (pmr_arena) ou no pool da thread (pmr_pool), contra std::vector no heap global (std_ns)
+
+    Cada linha traz o tempo médio de uma operação inteira (ex: n push_back) em nanossegundos,
+    para o vector e para o std::vector, e a razão edbi/std.
+*/
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include "../include/vector.h"
+#endif
+
+#ifndef SIMD_H
+#define SIMD_H
+#include "../include/simd.h"
+#endif
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+#include "../include/parallel.h"
+#endif
+
+#ifndef VECTOR_IO_H
+#define VECTOR_IO_H
+#include "../include/vector_io.h"
+#endif
+
+#ifndef FSTREAM
+#define FSTREAM
+#include <fstream>
+#endif
+
+#ifndef CONCURRENT_VECTOR_H
+#define CONCURRENT_VECTOR_H
+#include "../include/concurrent_vector.h"
+#endif
+
+#ifndef ALLOCATOR_H
+#include "../include/allocator.h"
+#endif
+
+#ifndef MEMORY_RESOURCE_H
+#define MEMORY_RESOURCE_H
+#include "../include/memory_resource.h"
+#endif
+
+#ifndef SOA_VECTOR_H
+#define SOA_VECTOR_H
+#include "../include/soa_vector.h"
+#endif
+
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+#include "../include/flat_map.h"
+#endif
+
+#ifndef COW_VECTOR_H
+#define COW_VECTOR_H
+#include "../include/cow_vector.h"
+#endif
+
+#ifndef STATIC_VECTOR_H
+#define STATIC_VECTOR_H
+#include "../include/static_vector.h"
+#endif
+
+#ifndef PACKED_VECTOR_H
+#define PACKED_VECTOR_H
+#include "../include/packed_vector.h"
+#endif
+
+#ifndef INCREMENTAL_VECTOR_H
+#define INCREMENTAL_VECTOR_H
+#include "../include/incremental_vector.h"
+#endif
+
+#ifndef MAP
+#define MAP
+#include <map>
+#endif
+
+#ifndef IOSTREAM
+#define IOSTREAM
+#include <iostream>
+#endif
+
+#ifndef SSTREAM
+#define SSTREAM
+#include <sstream>
+#endif
+
+#ifndef STRING
+#define STRING
+#include <string>
+#endif
+
+#ifndef STD_VECTOR
+#define STD_VECTOR
+#include <vector>
+#endif
+
+#ifndef ARRAY
+#define ARRAY
+#include <array>
+#endif
+
+#ifndef CHRONO
+#define CHRONO
+#include <chrono>
+#endif
+
+#ifndef CSTRING
+#define CSTRING
+#include <cstring>
+#endif
+
+#ifndef CSTDINT
+#define CSTDINT
+#include <cstdint>
+#endif
+
+#ifndef NUMERIC
+#define NUMERIC
+#include <numeric>
+#endif
+
+#if __cplusplus > 201703L
+#ifndef RANGES
+#define RANGES
+#include <ranges>
+#endif
+#endif
+
+using namespace std;
+
+// [I] Tipos de elemento
+
+/*! @brief elemento POD de 64 bytes */
+struct pod64 {
+    long v[8];
+};
+
+ostream& operator<<( ostream& os, const pod64& p ){
+    return os << p.v[0];
+}
+
+/**
+* @brief gera o i-ésimo valor de teste de cada tipo
+*/
+template < typename T > T make_value( size_t i );
+
+template <> int make_value<int>( size_t i ){ return (int) i; }
+
+template <> float make_value<float>( size_t i ){ return (float) ( i % 1000 ) * 0.25f; }
+
+template <> double make_value<double>( size_t i ){ return (double) ( i % 1000 ) * 0.25; }
+
+template <> pod64 make_value<pod64>( size_t i ){
+    pod64 p;
+    for ( int k = 0; k < 8; ++k ) p.v[k] = (long) (i+k);
+    return p;
+}
+
+template <> string make_value<string>( size_t i ){
+    // maior que o buffer de SSO, para que cada string tenha memória própria.
+    return string( "elemento-de-teste-numero-" ) + to_string( i );
+}
+
+/** @brief valor resumido de um elemento, impede que o compilador descarte o trabalho */
+inline size_t touch( int x ){ return (size_t) x; }
+inline size_t touch( const pod64& p ){ return (size_t) p.v[0]; }
+inline size_t touch( const string& s ){ return s.size(); }
+
+/** @brief predicado das operações erase_if: apaga cerca de um terço dos elementos, sem padrão por posição */
+inline bool dropped( int x ){ return x % 3 == 0; }
+inline bool dropped( const pod64& p ){ return p.v[0] % 3 == 0; }
+inline bool dropped( const string& s ){ return s.back() % 3 == 0; }
+
+/** @brief nome do tipo na saída */
+template < typename T > const char * type_name( void );
+template <> const char * type_name<int>( void ){ return "int"; }
+template <> const char * type_name<float>( void ){ return "float"; }
+template <> const char * type_name<double>( void ){ return "double"; }
+template <> const char * type_name<pod64>( void ){ return "pod64"; }
+template <> const char * type_name<string>( void ){ return "string"; }
+
+// fim [I]
+
+//---------------------------------------------------------------------------------------------------
+
+// [II] Medição e saída
+
+volatile size_t sink = 0; //!< destino dos resultados, para o trabalho não ser eliminado.
+
+/*! @brief uma linha do resultado */
+struct result {
+    string operation;  //!< nome da operação
+    string type;  //!< tipo do elemento
+    size_t n;  //!< tamanho do vector
+    double edbi_ns;  //!< tempo médio no vector
+    double std_ns;  //!< tempo médio no std::vector
+};
+
+/*! @brief opções de linha de comando */
+struct options {
+    size_t max_n = 1000000;  //!< maior tamanho testado
+    bool json = false;  //!< saída em JSON
+    string group;  //!< prefixo das operações a rodar
+};
+
+/** @brief true se a operação 'op' pertence ao grupo pedido */
+bool wanted( const options& opt, const char * op ){
+    return opt.group.empty() || string( op ).compare( 0, opt.group.size(), opt.group ) == 0;
+}
+
+/**
+* @brief quantas vezes repetir uma operação de tamanho n, para que cada medição processe ~10^6 elementos
+*/
+size_t repetitions( size_t n ){
+    size_t r = 1000000 / ( n == 0 ? 1 : n );
+    return ( r == 0 ) ? 1 : ( r > 100000 ? 100000 : r );
+}
+
+/**
+* @brief tempo médio, em ns, de 'op(rep)' chamada 'reps' vezes
+*/
+template < typename Op >
+double measure( size_t reps, Op op ){
+    auto t0 = chrono::steady_clock::now();
+    for ( size_t r = 0; r < reps; ++r ){
+        op( r );
+    }
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration<double, nano>( t1 - t0 ).count() / reps;
+}
+
+/**
+* @brief imprime os resultados em CSV ou JSON
+*/
+void report( const std::vector<result>& rows, bool json ){
+    if ( json ){
+        cout << "[\n";
+        for ( size_t i = 0; i < rows.size(); ++i ){
+            const result& r = rows[i];
+            cout << "  {\"operation\": \"" << r.operation << "\", \"type\": \"" << r.type << "\", \"n\": " << r.n
+                 << ", \"edbi_ns\": " << r.edbi_ns << ", \"std_ns\": " << r.std_ns
+                 << ", \"ratio\": " << ( r.std_ns > 0 ? r.edbi_ns / r.std_ns : 0 ) << "}"
+                 << ( i+1 < rows.size() ? ",\n" : "\n" );
+        }
+        cout << "]" << endl;
+    }else{
+        cout << "operation,type,n,edbi_ns,std_ns,ratio\n";
+        for ( const result& r : rows ){
+            cout << r.operation << "," << r.type << "," << r.n << "," << r.edbi_ns << "," << r.std_ns << ","
+                 << ( r.std_ns > 0 ? r.edbi_ns / r.std_ns : 0 ) << "\n";
+        }
+        cout.flush();
+    }
+}
+
+// fim [II]
+
+//---------------------------------------------------------------------------------------------------
+
+// [III] Operações, escritas uma vez para os dois containers
+
+/** @brief n push_back num vector vazio */
+template < typename Vec >
+size_t op_push_back( const typename Vec::value_type* src, size_t n ){
+    Vec v;
+    for ( size_t i = 0; i < n; ++i ) v.push_back( src[i] );
+    return v.size();
+}
+
+/** @brief reserve(n) seguido de n push_back */
+template < typename Vec >
+size_t op_push_back_reserve( const typename Vec::value_type* src, size_t n ){
+    Vec v;
+    v.reserve( n );
+    for ( size_t i = 0; i < n; ++i ) v.push_back( src[i] );
+    return v.size();
+}
+
+/** @brief insere n elementos no meio de um vector com n elementos */
+template < typename Vec >
+size_t op_insert_range( Vec& base, const typename Vec::value_type* src, size_t n ){
+    Vec v( base );
+    v.insert( v.begin() + n/2, src, src+n );
+    return v.size();
+}
+
+/** @brief apaga até 100 elementos do começo */
+template < typename Vec >
+size_t op_erase_front( Vec& base, size_t n ){
+    Vec v( base );
+    size_t k = std::min( n, (size_t) 100 );
+    for ( size_t i = 0; i < k; ++i ) v.erase( v.begin() );
+    return v.size();
+}
+
+/** @brief apaga até 100 elementos do meio */
+template < typename Vec >
+size_t op_erase_middle( Vec& base, size_t n ){
+    Vec v( base );
+    size_t k = std::min( n, (size_t) 100 );
+    for ( size_t i = 0; i < k; ++i ) v.erase( v.begin() + v.size()/2 );
+    return v.size();
+}
+
+/** @brief apaga a metade do meio de uma vez */
+template < typename Vec >
+size_t op_erase_range( Vec& base, size_t n ){
+    Vec v( base );
+    v.erase( v.begin() + n/4, v.begin() + n/4 + n/2 );
+    return v.size();
+}
+
+/** @brief apaga os elementos 'dropped' mantendo a ordem (no std::vector, erase + remove_if) */
+template < typename T >
+size_t op_erase_if( ::vector<T>& base ){
+    ::vector<T> v( base );
+    v.erase_if( []( const T& x ){ return dropped( x ); } );
+    return v.size();
+}
+
+template < typename T >
+size_t op_erase_if( std::vector<T>& base ){
+    std::vector<T> v( base );
+    v.erase( std::remove_if( v.begin(), v.end(), []( const T& x ){ return dropped( x ); } ), v.end() );
+    return v.size();
+}
+
+/** @brief apaga os elementos 'dropped' sem manter a ordem; o std::vector não tem, usa erase + remove_if */
+template < typename T >
+size_t op_erase_if_unordered( ::vector<T>& base ){
+    ::vector<T> v( base );
+    v.erase_if_unordered( []( const T& x ){ return dropped( x ); } );
+    return v.size();
+}
+
+/** @brief soma de todos os elementos, percorrendo com operator[] */
+template < typename Vec >
+size_t op_iterate( const Vec& v ){
+    size_t s = 0;
+    for ( size_t i = 0; i < v.size(); ++i ) s += touch( v[i] );
+    return s;
+}
+
+/** @brief mesmo formato do operator<< do vector: "[ " elementos "]" */
+template < typename T >
+void stream_out( ostream& os, const ::vector<T>& v ){
+    os << v;
+}
+
+template < typename T >
+void stream_out( ostream& os, const std::vector<T>& v ){
+    os << "[ ";
+    for ( size_t i = 0; i < v.size(); ++i ) os << v[i];
+    os << "]";
+}
+
+/** @brief escreve o vector num ostringstream */
+template < typename Vec >
+size_t op_stream( const Vec& v ){
+    ostringstream os;
+    stream_out( os, v );
+    return os.str().size();
+}
+
+// fim [III]
+
+//---------------------------------------------------------------------------------------------------
+
+// [IV] Rodada por tipo e tamanho
+
+/**
+* @brief roda todas as operações para um tipo e um tamanho
+*/
+template < typename T >
+void run_type( size_t n, const options& opt, std::vector<result>& rows ){
+    typedef ::vector<T> edbi_vec;
+    typedef std::vector<T> std_vec;
+
+    // sem nenhuma operação do grupo pedido, nem monta os dados (com max_n grande eles podem não caber).
+    static const char * const ops[] = { "push_back", "insert_range", "erase_front", "erase_middle", "erase_range",
+                                        "erase_if", "copy", "move", "iterate", "stream" };
+    if ( std::none_of( std::begin( ops ), std::end( ops ), [&]( const char * op ){ return ::wanted( opt, op ); } ) ) return;
+
+    std::vector<T> src_values;
+    src_values.reserve( n );
+    for ( size_t i = 0; i < n; ++i ) src_values.push_back( make_value<T>( i ) );
+    const T * src = src_values.data();
+
+    edbi_vec edbi_full;
+    edbi_full.reserve( n );
+    for ( size_t i = 0; i < n; ++i ) edbi_full.push_back( src[i] );
+    std_vec std_full( src, src+n );
+
+    size_t reps = repetitions( n );
+    size_t copy_reps = repetitions( 2*n );
+
+    auto add = [&]( const char * op, double e, double s ){
+        rows.push_back( result{ op, type_name<T>(), n, e, s } );
+    };
+    auto wanted = [&]( const char * op ){
+        return ::wanted( opt, op );
+    };
+
+    if ( wanted( "push_back" ) ){
+        add( "push_back",
+             measure( reps, [&]( size_t ){ sink = sink + op_push_back<edbi_vec>( src, n ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + op_push_back<std_vec>( src, n ); } ) );
+    }
+    if ( wanted( "push_back_reserve" ) ){
+        add( "push_back_reserve",
+             measure( reps, [&]( size_t ){ sink = sink + op_push_back_reserve<edbi_vec>( src, n ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + op_push_back_reserve<std_vec>( src, n ); } ) );
+    }
+    if ( wanted( "insert_range" ) ){
+        add( "insert_range",
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_insert_range( edbi_full, src, n ); } ),
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_insert_range( std_full, src, n ); } ) );
+    }
+    if ( wanted( "erase_front" ) ){
+        add( "erase_front",
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_front( edbi_full, n ); } ),
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_front( std_full, n ); } ) );
+    }
+    if ( wanted( "erase_middle" ) ){
+        add( "erase_middle",
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_middle( edbi_full, n ); } ),
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_middle( std_full, n ); } ) );
+    }
+    if ( wanted( "erase_range" ) ){
+        add( "erase_range",
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_range( edbi_full, n ); } ),
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_range( std_full, n ); } ) );
+    }
+    if ( wanted( "erase_if" ) ){
+        size_t e = op_erase_if( edbi_full ), s = op_erase_if( std_full );
+        if ( e != s || op_erase_if_unordered( edbi_full ) != s ){
+            cerr << "erase_if: tamanho divergente (" << type_name<T>() << ", n=" << n << ")\n";
+        }
+        add( "erase_if",
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_if( edbi_full ); } ),
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_if( std_full ); } ) );
+        add( "erase_if_unordered",
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_if_unordered( edbi_full ); } ),
+             measure( copy_reps, [&]( size_t ){ sink = sink + op_erase_if( std_full ); } ) );
+    }
+    if ( wanted( "copy" ) ){
+        add( "copy",
+             measure( reps, [&]( size_t ){ edbi_vec c( edbi_full ); sink = sink + c.size(); } ),
+             measure( reps, [&]( size_t ){ std_vec c( std_full ); sink = sink + c.size(); } ) );
+    }
+    if ( wanted( "move" ) ){
+        // vai e volta, para a fonte continuar cheia na próxima repetição.
+        add( "move",
+             measure( reps, [&]( size_t ){ edbi_vec c( std::move(edbi_full) ); edbi_full = std::move(c); sink = sink + edbi_full.size(); } ),
+             measure( reps, [&]( size_t ){ std_vec c( std::move(std_full) ); std_full = std::move(c); sink = sink + std_full.size(); } ) );
+    }
+    if ( wanted( "iterate" ) ){
+        add( "iterate",
+             measure( reps, [&]( size_t ){ sink = sink + op_iterate( edbi_full ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + op_iterate( std_full ); } ) );
+    }
+    if ( wanted( "stream" ) ){
+        size_t stream_reps = repetitions( 10*n );
+        add( "stream",
+             measure( stream_reps, [&]( size_t ){ sink = sink + op_stream( edbi_full ); } ),
+             measure( stream_reps, [&]( size_t ){ sink = sink + op_stream( std_full ); } ) );
+    }
+}
+
+// fim [IV]
+
+//---------------------------------------------------------------------------------------------------
+
+// [V] Busca e redução (simd.h)
+
+/**
+* @brief confere cada conjunto de instruções disponível com simd::scalar
+* @return quantidade de divergências, cada uma descrita em cerr
+*/
+template < typename T >
+size_t check_scan( const T * p, const T * q, size_t n ){
+    const T needle = p[ n/2 ];
+    const T missing = T( -1 );
+    size_t bad = 0;
+    auto expect = [&]( bool ok, const char * what, int level ){
+        if ( ok ) return;
+        ++bad;
+        cerr << "scan: " << what << " diverge de simd::scalar (" << type_name<T>() << ", n=" << n << ", isa=" << level << ")\n";
+    };
+    for ( int level = (int) simd::isa::scalar; level <= (int) simd::detected(); ++level ){
+        simd::force( (simd::isa) level );
+        expect( simd::find( p, n, needle ) == simd::scalar::find( p, n, needle ), "find", level );
+        expect( simd::find( p, n, missing ) == simd::scalar::find( p, n, missing ), "find", level );
+        expect( simd::count( p, n, needle ) == simd::scalar::count( p, n, needle ), "count", level );
+        expect( simd::min_element( p, n ) == simd::scalar::min_element( p, n ), "min_element", level );
+        expect( simd::max_element( p, n ) == simd::scalar::max_element( p, n ), "max_element", level );
+        expect( simd::sum( p, n ) == simd::scalar::sum( p, n ), "sum", level );
+        expect( simd::dot( p, q, n ) == simd::scalar::dot( p, q, n ), "dot", level );
+    }
+    simd::force( simd::detected() );
+    return bad;
+}
+
+/**
+* @brief mede os kernels de simd.h contra os algoritmos equivalentes da std
+* @return quantidade de divergências encontradas por check_scan
+*/
+template < typename T >
+size_t run_scan( size_t n, const options& opt, std::vector<result>& rows ){
+    ::vector<T> a, b;
+    a.reserve( n );
+    b.reserve( n );
+    for ( size_t i = 0; i < n; ++i ){
+        a.push_back( make_value<T>( i ) );
+        b.push_back( make_value<T>( n-i ) );
+    }
+    const T * p = a.data();
+    const T * q = b.data();
+    size_t bad = check_scan( p, q, n );
+
+    // find procura um valor ausente, a busca percorre tudo; count conta um valor presente.
+    const T missing = T( -1 );
+    const T needle = p[ n/2 ];
+    size_t reps = repetitions( n );
+    typedef typename simd::scalar::sum_type<T>::type S;
+
+    auto add = [&]( const char * op, double e, double s ){
+        rows.push_back( result{ op, type_name<T>(), n, e, s } );
+    };
+
+    if ( wanted( opt, "scan_find" ) ){
+        add( "scan_find",
+             measure( reps, [&]( size_t ){ sink = sink + simd::find( a, missing ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + ( std::find( p, p+n, missing ) - p ); } ) );
+    }
+    if ( wanted( opt, "scan_count" ) ){
+        add( "scan_count",
+             measure( reps, [&]( size_t ){ sink = sink + simd::count( a, needle ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + std::count( p, p+n, needle ); } ) );
+    }
+    if ( wanted( opt, "scan_min" ) ){
+        add( "scan_min",
+             measure( reps, [&]( size_t ){ sink = sink + simd::min_element( a ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + ( std::min_element( p, p+n ) - p ); } ) );
+    }
+    if ( wanted( opt, "scan_max" ) ){
+        add( "scan_max",
+             measure( reps, [&]( size_t ){ sink = sink + simd::max_element( a ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + ( std::max_element( p, p+n ) - p ); } ) );
+    }
+    if ( wanted( opt, "scan_sum" ) ){
+        add( "scan_sum",
+             measure( reps, [&]( size_t ){ sink = sink + (size_t) simd::sum( a ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + (size_t) std::accumulate( p, p+n, S() ); } ) );
+    }
+    if ( wanted( opt, "scan_dot" ) ){
+        add( "scan_dot",
+             measure( reps, [&]( size_t ){ sink = sink + (size_t) simd::dot( a, b ); } ),
+             measure( reps, [&]( size_t ){ sink = sink + (size_t) std::inner_product( p, p+n, q, S() ); } ) );
+    }
+    return bad;
+}
+
+// fim [V]
+
+//---------------------------------------------------------------------------------------------------
+
+// [VI] Algoritmos paralelos (parallel.h)
+
+/**
+* @brief mede os algoritmos de parallel.h contra os sequenciais da std
+* @return quantidade de resultados diferentes dos da std, cada um descrito em cerr
+*/
+template < typename T >
+size_t run_parallel( size_t n, const options& opt, std::vector<result>& rows ){
+    ::vector<T> a;
+    a.reserve( n );
+    // embaralhado de forma determinística, para o sort ter trabalho.
+    for ( size_t i = 0; i < n; ++i ) a.push_back( make_value<T>( ( i * 7919 ) % n ) );
+    std::vector<T> s( a.data(), a.data()+n );
+    ::vector<T> out;
+    std::vector<T> std_out( n );
+    size_t reps = repetitions( n );
+    size_t bad = 0;
+    typedef typename simd::scalar::sum_type<T>::type S;
+
+    auto add = [&]( const char * op, double e, double st ){
+        rows.push_back( result{ op, type_name<T>(), n, e, st } );
+    };
+    auto expect = [&]( bool ok, const char * what ){
+        if ( ok ) return;
+        ++bad;
+        cerr << "parallel: " << what << " diverge da std (" << type_name<T>() << ", n=" << n << ")\n";
+    };
+
+    if ( wanted( opt, "parallel_for_each" ) ){
+        add( "parallel_for_each",
+             measure( reps, [&]( size_t ){ parallel_for_each( a, []( T& x ){ x += 1; } ); sink = sink + touch( a[0] ); } ),
+             measure( reps, [&]( size_t ){ std::for_each( s.begin(), s.end(), []( T& x ){ x += 1; } ); sink = sink + touch( s[0] ); } ) );
+    }
+    if ( wanted( opt, "parallel_transform" ) ){
+        add( "parallel_transform",
+             measure( reps, [&]( size_t ){ parallel_transform( a, out, []( const T& x ){ return x / 2 + 1; } ); sink = sink + touch( out[0] ); } ),
+             measure( reps, [&]( size_t ){ std::transform( s.begin(), s.end(), std_out.begin(), []( const T& x ){ return x / 2 + 1; } ); sink = sink + touch( std_out[0] ); } ) );
+    }
+    if ( wanted( opt, "parallel_reduce" ) ){
+        S e = 0, st = 0;
+        add( "parallel_reduce",
+             measure( reps, [&]( size_t ){ e = parallel_reduce( a, S() ); sink = sink + (size_t) e; } ),
+             measure( reps, [&]( size_t ){ st = std::accumulate( s.begin(), s.end(), S() ); sink = sink + (size_t) st; } ) );
+        // soma de ponto flutuante depende da ordem, só os inteiros precisam bater com o sequencial.
+        expect( !std::is_integral<T>::value || e == st, "parallel_reduce" );
+        // acumulação T -> R diferente de T: cada bloco parte da identidade e os blocos se juntam com combine.
+        auto square = []( long long acc, const T& x ){ return acc + (long long) x * (long long) x; };
+        long long sq = parallel_reduce( a, 0LL, square, std::plus<long long>() );
+        expect( !std::is_integral<T>::value || sq == std::accumulate( s.begin(), s.end(), 0LL, square ), "parallel_reduce (quadrados)" );
+    }
+    if ( wanted( opt, "parallel_sort" ) ){
+        // cada repetição ordena uma cópia desordenada; a cópia entra no tempo dos dois lados.
+        size_t sort_reps = repetitions( 10*n );
+        ::vector<T> sorted;
+        std::vector<T> std_sorted;
+        add( "parallel_sort",
+             measure( sort_reps, [&]( size_t ){ sorted = a; parallel_sort( sorted ); sink = sink + touch( sorted[0] ); } ),
+             measure( sort_reps, [&]( size_t ){ std_sorted = s; std::sort( std_sorted.begin(), std_sorted.end() ); sink = sink + touch( std_sorted[0] ); } ) );
+        expect( std::equal( std_sorted.begin(), std_sorted.end(), sorted.data() ), "parallel_sort" );
+    }
+    return bad;
+}
+
+// fim [VI]
+
+//---------------------------------------------------------------------------------------------------
+
+// [VII] Gravação e leitura (vector_io.h)
+
+/**
+* @brief mede write_to/read_from/write_text contra fwrite/fread e operator<< por elemento
+* @return quantidade de leituras que não devolveram os dados gravados, cada uma descrita em cerr
+*/
+template < typename T >
+size_t run_io( size_t n, const options& opt, std::vector<result>& rows ){
+    ::vector<T> a;
+    a.reserve( n );
+    for ( size_t i = 0; i < n; ++i ) a.push_back( make_value<T>( i ) );
+    std::vector<T> s( a.data(), a.data()+n );
+    size_t reps = repetitions( 10*n );
+    size_t bad = 0;
+
+    FILE * f = std::tmpfile();
+    int fd = fileno( f );
+    auto rewind_fd = [&]( void ){ ::lseek( fd, 0, SEEK_SET ); };
+    auto add = [&]( const char * op, double e, double st ){
+        rows.push_back( result{ op, type_name<T>(), n, e, st } );
+    };
+
+    if ( wanted( opt, "io_write" ) ){
+        add( "io_write",
+             measure( reps, [&]( size_t ){ rewind_fd(); write_to( a, fd ); } ),
+             measure( reps, [&]( size_t ){ std::rewind( f ); std::fwrite( s.data(), sizeof(T), n, f ); std::fflush( f ); } ) );
+    }
+    if ( wanted( opt, "io_read" ) ){
+        rewind_fd();
+        write_to( a, fd );
+        ::vector<T> back;
+        std::vector<T> std_back;
+        add( "io_read",
+             measure( reps, [&]( size_t ){ rewind_fd(); back.clear(); read_from( back, fd ); sink = sink + back.size(); } ),
+             measure( reps, [&]( size_t ){
+                 std::rewind( f ); std::fseek( f, sizeof(vector_io_header), SEEK_SET );
+                 std_back.resize( n ); sink = sink + std::fread( std_back.data(), sizeof(T), n, f ); } ) );
+        if ( back.size() != n || !std::equal( s.begin(), s.end(), back.data() ) ){
+            ++bad;
+            cerr << "io: read_from nao devolveu o que write_to gravou (" << type_name<T>() << ", n=" << n << ")\n";
+        }
+    }
+    if ( wanted( opt, "io_ingest" ) ){
+        rewind_fd();
+        write_to( a, fd );
+        const size_t piece = 1 << 16;
+        const off_t start = sizeof(vector_io_header);
+        ::vector<T> back;
+        std::vector<T> std_back;
+        add( "io_ingest",
+             measure( reps, [&]( size_t ){
+                 back.clear();
+                 off_t at = start;
+                 while ( size_t k = append_from( back, fd, piece, at ) ) at += (off_t) ( k*sizeof(T) );
+                 sink = sink + back.size(); } ),
+             measure( reps, [&]( size_t ){
+                 std_back.clear();
+                 off_t at = start;
+                 for (;;){
+                     size_t old = std_back.size();
+                     std_back.resize( old + piece/sizeof(T) );
+                     ssize_t r = ::pread( fd, std_back.data()+old, piece/sizeof(T)*sizeof(T), at );
+                     std_back.resize( old + ( r > 0 ? (size_t) r/sizeof(T) : 0 ) );
+                     if ( r <= 0 ) break;
+                     at += r;
+                 }
+                 sink = sink + std_back.size(); } ) );
+        if ( back.size() != n || !std::equal( s.begin(), s.end(), back.data() ) ){
+            ++bad;
+            cerr << "io: append_from nao devolveu o que write_to gravou (" << type_name<T>() << ", n=" << n << ")\n";
+        }
+    }
+    if ( wanted( opt, "io_text" ) ){
+        size_t text_reps = repetitions( 100*n );
+        ofstream os( "/dev/null" );
+        add( "io_text",
+             measure( text_reps, [&]( size_t ){ write_text( a, os ); } ),
+             measure( text_reps, [&]( size_t ){ for ( size_t i = 0; i < n; ++i ) os << s[i] << '\n'; } ) );
+        std::stringstream text;
+        write_text( a, text );
+        ::vector<T> back;
+        if ( read_text( back, text ) != n || !std::equal( s.begin(), s.end(), back.data() ) ){
+            ++bad;
+            cerr << "io: read_text nao devolveu o que write_text gravou (" << type_name<T>() << ", n=" << n << ")\n";
+        }
+    }
+    std::fclose( f );
+    return bad;
+}
+
+// fim [VII]
+
+//---------------------------------------------------------------------------------------------------
+
+// [VIII] Acréscimo concorrente (concurrent_vector.h)
+
+/**
+* @brief roda 'per_thread(t)' em 'threads' threads que começam juntas
+*/
+template < typename F >
+void run_threads( size_t threads, F per_thread ){
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> pool;
+    for ( size_t t = 0; t < threads; ++t ){
+        pool.emplace_back( [&, t]{
+            while ( !go.load( std::memory_order_acquire ) ) std::this_thread::yield();
+            per_thread( t );
+        } );
+    }
+    go.store( true, std::memory_order_release );
+    for ( std::thread& th : pool ) th.join();
+}
+
+/**
+* @brief n push_back divididos entre threads: concurrent_vector contra std::vector + mutex
+* @return quantidade de execuções que terminaram com tamanho errado, cada uma descrita em cerr
+*/
+size_t run_concurrent( size_t n, const options& opt, std::vector<result>& rows ){
+    size_t max_threads = 2 * std::max( 1u, std::thread::hardware_concurrency() );
+    size_t reps = std::max( (size_t) 1, repetitions( n ) / 10 );
+    size_t bad = 0;
+    for ( size_t threads = 1; threads <= max_threads; threads *= 2 ){
+        string op = "concurrent_push_" + to_string( threads );
+        if ( !wanted( opt, op.c_str() ) ) continue;
+        size_t per = n / threads;
+        size_t edbi_size = 0, std_size = 0;
+        double e = measure( reps, [&]( size_t ){
+            concurrent_vector<int> v;
+            run_threads( threads, [&]( size_t t ){
+                for ( size_t i = 0; i < per; ++i ) v.push_back( (int) ( t*per + i ) );
+            } );
+            edbi_size = v.size();
+        } );
+        double s = measure( reps, [&]( size_t ){
+            std::vector<int> v;
+            std::mutex m;
+            run_threads( threads, [&]( size_t t ){
+                for ( size_t i = 0; i < per; ++i ){
+                    std::lock_guard<std::mutex> lock( m );
+                    v.push_back( (int) ( t*per + i ) );
+                }
+            } );
+            std_size = v.size();
+        } );
+        if ( edbi_size != per*threads || std_size != per*threads ){
+            ++bad;
+            cerr << "concurrent: tamanho final errado (" << threads << " threads, n=" << n << ")\n";
+        }
+        rows.push_back( result{ op, "int", n, e, s } );
+    }
+    return bad;
+}
+
+// fim [VIII]
+
+//---------------------------------------------------------------------------------------------------
+
+// [IX] Vectors de vida curta em memory_resource (memory_resource.h)
+
+/**
+* @brief 16 vectors de n push_back, somados e descartados; o padrão de uma requisição
+* @param make cria um vector vazio
+*/
+template < typename Make >
+size_t short_lived( size_t n, Make make ){
+    size_t total = 0;
+    for ( size_t k = 0; k < 16; ++k ){
+        auto v = make();
+        for ( size_t i = 0; i < n; ++i ) v.push_back( (int) i );
+        total += (size_t) v[ n-1 ] + v.size();
+    }
+    return total;
+}
+
+/**
+* @brief pmr_vector numa arena e no pool da thread contra std::vector no heap global
+* @return quantidade de operações cujo resultado divergiu do std::vector, cada uma descrita em cerr
+*/
+size_t run_pmr( size_t n, const options& opt, std::vector<result>& rows ){
+    size_t reps = std::max( (size_t) 1, repetitions( n ) / 16 );
+    size_t bad = 0;
+    size_t expected = 0, got = 0;
+
+    double s = measure( reps, [&]( size_t ){
+        expected = short_lived( n, []{ return std::vector<int>(); } );
+    } );
+
+    if ( wanted( opt, "pmr_arena" ) ){
+        arena<64*1024> a;
+        double e = measure( reps, [&]( size_t ){
+            got = short_lived( n, [&]{ return pmr_vector<int>( &a ); } );
+            a.reset();
+        } );
+        if ( got != expected ){
+            ++bad;
+            cerr << "pmr_arena: resultado divergente (n=" << n << ")\n";
+        }
+        rows.push_back( result{ "pmr_arena", "int", n, e, s } );
+    }
+    if ( wanted( opt, "pmr_pool" ) ){
+        size_class_pool_resource * pool = thread_local_pool();
+        double e = measure( reps, [&]( size_t ){
+            got = short_lived( n, [&]{ return pmr_vector<int>( pool ); } );
+        } );
+        if ( got != expected ){
+            ++bad;
+            cerr << "pmr_pool: resultado divergente (n=" << n << ")\n";
+        }
+        rows.push_back( result{ "pmr_pool", "int", n, e, s } );
+    }
+    return bad;
+}
+
+// fim [IX]
+
+//---------------------------------------------------------------------------------------------------
+
+// [X] Algoritmos da std pelos iterators
+
+#if __cplusplus > 201703L
+static_assert( std::contiguous_iterator< ::vector<int>::iterator >, "iterator do vector deve ser contíguo" );
+static_assert( std::contiguous_iterator< ::vector<int>::const_iterator >, "const_iterator do vector deve ser contíguo" );
+static_assert( std::random_access_iterator< ::vector<int>::reverse_iterator >, "reverse_iterator deve ser de acesso aleatório" );
+static_assert( std::ranges::contiguous_range< ::vector<int> >, "vector deve ser um contiguous_range" );
+static_assert( std::ranges::contiguous_range< const ::vector<string> >, "vector constante deve ser um contiguous_range" );
+#endif
+
+/**
+* @brief std::sort, std::copy e std::lower_bound nos iterators do vector e do std::vector
+* @return quantidade de operações cujo resultado divergiu do std::vector, cada uma descrita em cerr
+*/
+template < typename T >
+size_t run_algorithms( size_t n, const options& opt, std::vector<result>& rows ){
+    ::vector<T> a;
+    std::vector<T> s;
+    for ( size_t i = 0; i < n; ++i ){
+        T x = make_value<T>( ( i * 2654435761u ) % n );
+        a.push_back( x );
+        s.push_back( x );
+    }
+    size_t reps = std::max( (size_t) 1, repetitions( n ) / 10 );
+    size_t bad = 0;
+    auto add = [&]( const char * op, double e, double t ){
+        rows.push_back( result{ op, type_name<T>(), n, e, t } );
+    };
+
+    if ( wanted( opt, "algo_sort" ) ){
+        ::vector<T> a2( a );
+        std::vector<T> s2( s );
+        double e = measure( reps, [&]( size_t ){ a2 = a; std::sort( a2.begin(), a2.end() ); sink = sink + touch( a2[0] ); } );
+        double t = measure( reps, [&]( size_t ){ s2 = s; std::sort( s2.begin(), s2.end() ); sink = sink + touch( s2[0] ); } );
+        if ( !std::equal( a2.begin(), a2.end(), s2.begin(), s2.end() ) ){
+            ++bad;
+            cerr << "algo_sort: resultado divergente (" << type_name<T>() << ", n=" << n << ")\n";
+        }
+        add( "algo_sort", e, t );
+    }
+    if ( wanted( opt, "algo_copy" ) ){
+        std::vector<T> out( n );
+        add( "algo_copy",
+             measure( reps, [&]( size_t ){ std::copy( a.cbegin(), a.cend(), out.begin() ); sink = sink + touch( out[n-1] ); } ),
+             measure( reps, [&]( size_t ){ std::copy( s.cbegin(), s.cend(), out.begin() ); sink = sink + touch( out[n-1] ); } ) );
+    }
+    if ( wanted( opt, "algo_lower_bound" ) ){
+        std::sort( a.begin(), a.end() );
+        std::sort( s.begin(), s.end() );
+        size_t found_a = 0, found_s = 0;
+        size_t search_reps = repetitions( 10 );  // uma busca é O(log n), repete bastante em qualquer n
+        double e = measure( search_reps, [&]( size_t r ){
+            found_a = std::lower_bound( a.begin(), a.end(), make_value<T>( r % n ) ) - a.begin();
+            sink = sink + found_a;
+        } );
+        double t = measure( search_reps, [&]( size_t r ){
+            found_s = std::lower_bound( s.begin(), s.end(), make_value<T>( r % n ) ) - s.begin();
+            sink = sink + found_s;
+        } );
+        if ( found_a != found_s ){
+            ++bad;
+            cerr << "algo_lower_bound: resultado divergente (" << type_name<T>() << ", n=" << n << ")\n";
+        }
+        add( "algo_lower_bound", e, t );
+    }
+    return bad;
+}
+
+// fim [X]
+
+//---------------------------------------------------------------------------------------------------
+
+// [XI] Acesso aleatório com páginas enormes (allocator.h)
+
+/**
+* @brief soma de 'reads' posições pseudoaleatórias de v (xorshift), as mesmas para qualquer container
+*/
+template < typename Vec >
+size_t random_reads( const Vec& v, size_t reads ){
+    uint64_t x = 88172645463325252ull;
+    size_t n = v.size(), s = 0;
+    for ( size_t r = 0; r < reads; ++r ){
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        s += v[ (size_t) ( ( (unsigned __int128) x * n ) >> 64 ) ];
+    }
+    return s;
+}
+
+/**
+* @brief leituras aleatórias num vector com páginas enormes contra std::vector
+* @return quantidade de execuções com bloco desalinhado ou soma divergente, cada uma descrita em cerr
+*/
+size_t run_huge( size_t n, const options& opt, std::vector<result>& rows ){
+    if ( !wanted( opt, "huge_random" ) ) return 0;
+    typedef aligned_allocator<size_t, 64, aligned_allocator<size_t>::huge_page> huge_alloc;
+    const size_t reads = size_t(1) << 20;
+    size_t bad = 0;
+
+    ::vector<size_t, huge_alloc> a;
+    a.reserve( n );
+    for ( size_t i = 0; i < n; ++i ) a.push_back( i );
+    std::vector<size_t> s( a.begin(), a.end() );
+
+    size_t align = huge_alloc::uses_huge_pages( n*sizeof(size_t) ) ? huge_alloc::huge_page : huge_alloc::alignment;
+    size_t got = 0, expected = 0;
+    double e = measure( 3, [&]( size_t ){ got = random_reads( a, reads ); } );
+    double t = measure( 3, [&]( size_t ){ expected = random_reads( s, reads ); } );
+    if ( reinterpret_cast<uintptr_t>( a.data() ) % align != 0 || got != expected ){
+        ++bad;
+        cerr << "huge_random: bloco desalinhado ou soma divergente (n=" << n << ")\n";
+    }
+    rows.push_back( result{ "huge_random", "size_t", n, e, t } );
+    return bad;
+}
+
+// fim [XI]
+
+//---------------------------------------------------------------------------------------------------
+
+// [XII] Devolução de memória (shrink_on_low_use)
+
+/**
+* @brief n push_back e n pop_back: o vector com shrink_on_low_use devolve memória ao esvaziar
+* @return 1 se a capacidade final não voltou ao mínimo da política, descrito em cerr
+*/
+size_t run_shrink( size_t n, const options& opt, std::vector<result>& rows ){
+    if ( !wanted( opt, "shrink_pop" ) ) return 0;
+    typedef shrink_on_low_use<> policy;
+    size_t reps = std::max( (size_t) 1, repetitions( n ) / 2 );
+    size_t final_cap = 0;
+    double e = measure( reps, [&]( size_t ){
+        ::vector<int, std::allocator<int>, policy> v;
+        for ( size_t i = 0; i < n; ++i ) v.push_back( (int) i );
+        while ( !v.empty() ) v.pop_back();
+        final_cap = v.capacity();
+    } );
+    double t = measure( reps, [&]( size_t ){
+        std::vector<int> v;
+        for ( size_t i = 0; i < n; ++i ) v.push_back( (int) i );
+        while ( !v.empty() ) v.pop_back();
+        sink = sink + v.capacity();
+    } );
+    rows.push_back( result{ "shrink_pop", "int", n, e, t } );
+    if ( final_cap*sizeof(int) > 4096 ){
+        cerr << "shrink_pop: capacidade final " << final_cap << " (n=" << n << ")\n";
+        return 1;
+    }
+    return 0;
+}
+
+// fim [XII]
+
+//---------------------------------------------------------------------------------------------------
+
+// [XIII] Registros por coluna (soa_vector.h)
+
+/*! @brief registro de 64 bytes em que a consulta só lê qty */
+struct record {
+    double price;
+    int qty;
+    int id;
+    char name[ 48 ];
+};
+
+/**
+* @brief soma de qty em n registros, guardados por coluna (soa_vector) e por struct (std::vector<record>)
+* @return 1 se as somas divergem, descrito em cerr
+*/
+size_t run_soa( size_t n, const options& opt, std::vector<result>& rows ){
+    if ( !wanted( opt, "soa_push_back" ) && !wanted( opt, "soa_scan" ) ) return 0;
+    size_t reps = repetitions( n );
+    soa_vector<double, int, int, std::array<char, 48>> columns;
+    std::vector<record> structs;
+    for ( size_t i = 0; i < n; ++i ){
+        columns.emplace_back( make_value<double>( i ), (int) ( i % 1000 ), (int) i, std::array<char, 48>() );
+        structs.push_back( record{ make_value<double>( i ), (int) ( i % 1000 ), (int) i, {} } );
+    }
+
+    if ( wanted( opt, "soa_push_back" ) ){
+        size_t build_reps = std::max( (size_t) 1, reps / 4 );
+        rows.push_back( result{ "soa_push_back", "record", n,
+             measure( build_reps, [&]( size_t ){
+                 soa_vector<double, int, int, std::array<char, 48>> v;
+                 for ( size_t i = 0; i < n; ++i ) v.emplace_back( 0.5, (int) i, (int) i, std::array<char, 48>() );
+                 sink = sink + v.size();
+             } ),
+             measure( build_reps, [&]( size_t ){
+                 std::vector<record> v;
+                 for ( size_t i = 0; i < n; ++i ) v.push_back( record{ 0.5, (int) i, (int) i, {} } );
+                 sink = sink + v.size();
+             } ) } );
+    }
+
+    size_t bad = 0;
+    if ( wanted( opt, "soa_scan" ) ){
+        std::span<const int> qty = columns.column<1>();
+        long long expected = 0;
+        for ( const record& r : structs ) expected += r.qty;
+        if ( simd::sum( qty.data(), qty.size() ) != expected ){
+            cerr << "soa_scan: soma da coluna diverge dos structs (n=" << n << ")\n";
+            ++bad;
+        }
+        rows.push_back( result{ "soa_scan", "record", n,
+             measure( reps, [&]( size_t ){ sink = sink + (size_t) simd::sum( qty.data(), qty.size() ); } ),
+             measure( reps, [&]( size_t ){
+                 long long s = 0;
+                 for ( const record& r : structs ) s += r.qty;
+                 sink = sink + (size_t) s;
+             } ) } );
+    }
+    return bad;
+}
+
+// fim [XIII]
+
+//---------------------------------------------------------------------------------------------------
+
+// [XIV] Mapa ordenado num vector (flat_map.h)
+
+/**
+* @brief soma dos valores achados para as chaves de 'queries' (ausentes contam 0), igual para qualquer mapa
+*/
+template < typename Map >
+size_t lookup_sum( const Map& m, const std::vector<int>& queries ){
+    size_t s = 0;
+    for ( int q : queries ){
+        auto it = m.find( q );
+        s += ( it == m.end() ) ? 0 : (size_t) it->second;
+    }
+    return s;
+}
+
+/**
+* @brief construção e buscas de flat_map contra std::map com n chaves pares embaralhadas
+* @return quantidade de mapas com conteúdo ou buscas divergentes do std::map, cada um descrito em cerr
+*/
+size_t run_flat( size_t n, const options& opt, std::vector<result>& rows ){
+    if ( !wanted( opt, "flat_build" ) && !wanted( opt, "flat_find" ) && !wanted( opt, "flat_eytzinger" ) ) return 0;
+    std::vector< std::pair<int, int> > input;
+    for ( size_t i = 0; i < n; ++i ) input.push_back( std::pair<int, int>( (int) ( 2*i ), (int) i ) );
+    uint64_t x = 88172645463325252ull;
+    for ( size_t i = n; i > 1; --i ){
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        std::swap( input[i-1], input[ x % i ] );
+    }
+    std::vector<int> queries;
+    for ( size_t q = 0; q < 4096; ++q ){
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        queries.push_back( (int) ( x % ( 2*n ) ) );
+    }
+
+    size_t bad = 0;
+    std::map<int, int> tree( input.begin(), input.end() );
+    flat_map<int, int> flat( input.begin(), input.end() );
+    flat_map<int, int, std::less<int>, eytzinger_search> eytzinger( input.begin(), input.end() );
+    if ( flat.size() != tree.size() || !std::equal( flat.begin(), flat.end(), tree.begin(),
+                                                         []( const std::pair<int, int>& a, const std::pair<const int, int>& b ){
+                                                             return a.first == b.first && a.second == b.second; } ) ){
+        cerr << "flat_build: conteúdo diverge do std::map (n=" << n << ")\n";
+        ++bad;
+    }
+    size_t expected = lookup_sum( tree, queries );
+    if ( lookup_sum( flat, queries ) != expected || lookup_sum( eytzinger, queries ) != expected ){
+        cerr << "flat_find: buscas divergem do std::map (n=" << n << ")\n";
+        ++bad;
+    }
+
+    size_t reps = std::max( (size_t) 1, repetitions( n ) / 4 );
+    if ( wanted( opt, "flat_build" ) ){
+        rows.push_back( result{ "flat_build", "int", n,
+             measure( reps, [&]( size_t ){ flat_map<int, int> m( input.begin(), input.end() ); sink = sink + m.size(); } ),
+             measure( reps, [&]( size_t ){
+                 std::map<int, int> m;
+                 for ( const std::pair<int, int>& p : input ) m.insert( p );
+                 sink = sink + m.size();
+             } ) } );
+    }
+    double t = measure( 64, [&]( size_t ){ sink = sink + lookup_sum( tree, queries ); } );
+    if ( wanted( opt, "flat_find" ) ){
+        rows.push_back( result{ "flat_find", "int", n,
+             measure( 64, [&]( size_t ){ sink = sink + lookup_sum( flat, queries ); } ), t } );
+    }
+    if ( wanted( opt, "flat_eytzinger" ) ){
+        rows.push_back( result{ "flat_eytzinger", "int", n,
+             measure( 64, [&]( size_t ){ sink = sink + lookup_sum( eytzinger, queries ); } ), t } );
+    }
+    return bad;
+}
+
+// fim [XIV]
+
+//---------------------------------------------------------------------------------------------------
+
+// [XV] Cópias divididas (cow_vector.h)
+
+/** @brief soma dos elementos de qualquer container de ints, sem alterá-lo */
+template < typename Vec >
+size_t sum_of( const Vec& v ){
+    size_t s = 0;
+    for ( int x : v ) s += (size_t) x;
+    return s;
+}
+
+/**
+* @brief cópias para leitores e snapshots durante acréscimos, cow_vector contra std::vector
+* @return quantidade de somas divergentes, cada uma descrita em cerr
+*/
+size_t run_cow( size_t n, const options& opt, std::vector<result>& rows ){
+    if ( !wanted( opt, "cow_copy" ) && !wanted( opt, "cow_snapshot" ) && !wanted( opt, "cow_edit" ) ) return 0;
+    const size_t readers = 16, every = 4096;
+    size_t reps = std::max( (size_t) 1, repetitions( n ) / 4 );
+    size_t bad = 0;
+
+    if ( wanted( opt, "cow_copy" ) ){
+        cow_vector<int> shared;
+        std::vector<int> plain;
+        for ( size_t i = 0; i < n; ++i ){
+            shared.push_back( make_value<int>( i ) );
+            plain.push_back( make_value<int>( i ) );
+        }
+        size_t got = 0, expected = 0;
+        double e = measure( reps, [&]( size_t ){
+            got = 0;
+            for ( size_t r = 0; r < readers; ++r ){ const cow_vector<int> copy( shared ); got += sum_of( copy ); }
+        } );
+        double t = measure( reps, [&]( size_t ){
+            expected = 0;
+            for ( size_t r = 0; r < readers; ++r ){ const std::vector<int> copy( plain ); expected += sum_of( copy ); }
+        } );
+        if ( got != expected ){
+            cerr << "cow_copy: soma das cópias diverge (n=" << n << ")\n";
+            ++bad;
+        }
+        rows.push_back( result{ "cow_copy", "int", n, e, t } );
+    }
+
+    if ( wanted( opt, "cow_snapshot" ) ){
+        size_t got = 0, expected = 0;
+        double e = measure( reps, [&]( size_t ){
+            cow_vector<int> owner;
+            got = 0;
+            for ( size_t i = 0; i < n; ++i ){
+                owner.push_back( make_value<int>( i ) );
+                if ( i % every == 0 ){ cow_vector<int>::snapshot_type s = owner.snapshot(); got += (size_t) s.back(); }
+            }
+        } );
+        double t = measure( reps, [&]( size_t ){
+            std::vector<int> owner;
+            expected = 0;
+            for ( size_t i = 0; i < n; ++i ){
+                owner.push_back( make_value<int>( i ) );
+                if ( i % every == 0 ){ const std::vector<int> s( owner ); expected += (size_t) s.back(); }
+            }
+        } );
+        if ( got != expected ){
+            cerr << "cow_snapshot: snapshots divergem das cópias (n=" << n << ")\n";
+            ++bad;
+        }
+        rows.push_back( result{ "cow_snapshot", "int", n, e, t } );
+    }
+
+    if ( wanted( opt, "cow_edit" ) ){
+        // pop_back e erase com elementos não triviais, com o bloco só do dono e dividido com um snapshot.
+        auto text = []( size_t i ){ return std::string( 32, 'a' ) + std::to_string( i ); };
+        size_t got = 0, expected = 0;
+        std::vector<std::string> left_e, left_t;
+        double e = measure( reps, [&]( size_t ){
+            cow_vector<std::string> owner;
+            got = 0;
+            for ( size_t i = 0; i < n; ++i ) owner.push_back( text( i ) );
+            for ( size_t i = 0; owner.size() > 1; ++i ){
+                if ( i % every == 0 ){
+                    cow_vector<std::string>::snapshot_type s = owner.snapshot();
+                    owner.pop_back();
+                    owner.erase( owner.cbegin() );
+                    got += s.size() + s.back().size();
+                }else{
+                    owner.pop_back();
+                }
+            }
+            left_e.assign( owner.cbegin(), owner.cend() );
+        } );
+        double t = measure( reps, [&]( size_t ){
+            std::vector<std::string> owner;
+            expected = 0;
+            for ( size_t i = 0; i < n; ++i ) owner.push_back( text( i ) );
+            for ( size_t i = 0; owner.size() > 1; ++i ){
+                if ( i % every == 0 ){
+                    const std::vector<std::string> s( owner );
+                    owner.pop_back();
+                    owner.erase( owner.cbegin() );
+                    expected += s.size() + s.back().size();
+                }else{
+                    owner.pop_back();
+                }
+            }
+            left_t = owner;
+        } );
+        if ( got != expected || left_e != left_t ){
+            cerr << "cow_edit: pop_back/erase divergem do std::vector (n=" << n << ")\n";
+            ++bad;
+        }
+        rows.push_back( result{ "cow_edit", "string", n, e, t } );
+    }
+    return bad;
+}
+
+// fim [XV]
+
+//---------------------------------------------------------------------------------------------------
+
+// [XVI] Capacidade fixa sem heap (static_vector.h)
+
+static_assert( std::is_trivially_copyable< static_vector<int, 32> >::value, "static_vector de int deve ser trivialmente copiável" );
+
+/** @brief trivialmente copiável, mas com construtor padrão não trivial (inicializador de membro) */
+struct with_default_member { int x = 0; };
+
+static_assert( std::is_trivially_copyable< static_vector<with_default_member, 32> >::value,
+               "static_vector de tipo trivialmente copiável deve ser trivialmente copiável" );
+
+/** @brief tabela montada em tempo de compilação: os 16 primeiros quadrados */
+constexpr static_vector<int, 16> square_table( void ){
+    static_vector<int, 16> t;
+    for ( int i = 0; i < 16; ++i ) t.push_back( i*i );
+    return t;
+}
+
+static_assert( square_table().size() == 16 && square_table()[15] == 225, "static_vector deve funcionar em constexpr" );
+
+/**
+* @brief um lote de 32 elementos montado e lido, igual para qualquer container com espaço para 32
+*/
+template < typename Vec >
+size_t fill_batch( Vec& v, size_t seed ){
+    for ( size_t i = 0; i < 31; ++i ) v.push_back( (int) ( seed + i ) );
+    v.insert( v.begin(), (int) seed );
+    v.erase( v.begin() + 7 );
+    v.push_back( 1 );
+    size_t s = 0;
+    for ( int x : v ) s += (size_t) x;
+    return s;
+}
+
+/**
+* @brief n lotes de 32 ints: static_vector sem heap contra std::vector com reserve
+* @return 1 se as somas divergem, descrito em cerr
+*/
+size_t run_static( size_t n, const options& opt, std::vector<result>& rows ){
+    if ( !wanted( opt, "static_batch" ) ) return 0;
+    size_t reps = std::max( (size_t) 1, repetitions( n ) / 32 );
+    size_t got = 0, expected = 0;
+    double e = measure( reps, [&]( size_t ){
+        got = 0;
+        for ( size_t b = 0; b < n; ++b ){ static_vector<int, 32> v; got += fill_batch( v, b ); }
+    } );
+    double t = measure( reps, [&]( size_t ){
+        expected = 0;
+        for ( size_t b = 0; b < n; ++b ){ std::vector<int> v; v.reserve( 32 ); expected += fill_batch( v, b ); }
+    } );
+    sink = sink + got;
+    rows.push_back( result{ "static_batch", "int", n, e, t } );
+    if ( got != expected ){
+        cerr << "static_batch: somas divergem (n=" << n << ")\n";
+        return 1;
+    }
+    return 0;
+}
+
+// fim [XVI]
+
+//---------------------------------------------------------------------------------------------------
+
+// [XVII] Inteiros compactados (packed_vector.h)
+
+/**
+* @brief n inteiros compactados contra o std::vector do tipo cheio: ids de 17 bits (bit_packed, uint32_t) e
+*        timestamps crescentes (frame_of_reference, uint64_t)
+* @return quantidade de somas divergentes ou vectors que não ocupam menos memória, cada um descrito em cerr
+*/
+size_t run_packed( size_t n, const options& opt, std::vector<result>& rows ){
+    if ( !wanted( opt, "packed_scan" ) && !wanted( opt, "packed_random" ) && !wanted( opt, "packed_for_scan" ) ) return 0;
+    size_t reps = std::max( (size_t) 1, repetitions( n ) / 4 );
+    size_t bad = 0;
+
+    packed_vector<uint32_t> ids;
+    std::vector<uint32_t> plain_ids;
+    uint64_t x = 88172645463325252ull;
+    for ( size_t i = 0; i < n; ++i ){
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        ids.push_back( (uint32_t) ( x & 0x1ffff ) );
+        plain_ids.push_back( (uint32_t) ( x & 0x1ffff ) );
+    }
+    ids.shrink_to_fit();
+    if ( n >= 100 && ids.memory_bytes() >= n*sizeof(uint32_t) ){
+        cerr << "packed: " << ids.memory_bytes() << " bytes para " << n << " ids de 17 bits\n";
+        ++bad;
+    }
+
+    if ( wanted( opt, "packed_scan" ) ){
+        size_t got = 0, expected = 0;
+        double e = measure( reps, [&]( size_t ){ got = 0; ids.for_each( [&]( uint32_t v ){ got += v; } ); } );
+        double t = measure( reps, [&]( size_t ){ expected = 0; for ( uint32_t v : plain_ids ) expected += v; } );
+        if ( got != expected ){
+            cerr << "packed_scan: somas divergem (n=" << n << ")\n";
+            ++bad;
+        }
+        rows.push_back( result{ "packed_scan", "uint32", n, e, t } );
+    }
+
+    if ( wanted( opt, "packed_random" ) ){
+        const size_t reads = 4096;
+        size_t got = 0, expected = 0;
+        double e = measure( reps, [&]( size_t ){ got = random_reads( ids, reads ); } );
+        double t = measure( reps, [&]( size_t ){ expected = random_reads( plain_ids, reads ); } );
+        if ( got != expected ){
+            cerr << "packed_random: somas divergem (n=" << n << ")\n";
+            ++bad;
+        }
+        rows.push_back( result{ "packed_random", "uint32", n, e, t } );
+    }
+
+    if ( wanted( opt, "packed_for_scan" ) ){
+        packed_vector< uint64_t, frame_of_reference<> > stamps;
+        std::vector<uint64_t> plain_stamps;
+        uint64_t now = 1700000000000ull;
+        for ( size_t i = 0; i < n; ++i ){
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            now += x % 16;
+            stamps.push_back( now );
+            plain_stamps.push_back( now );
+        }
+        stamps.shrink_to_fit();
+        if ( n >= 100 && 2 * stamps.memory_bytes() >= n*sizeof(uint64_t) ){
+            cerr << "packed_for_scan: " << stamps.memory_bytes() << " bytes para " << n << " timestamps\n";
+            ++bad;
+        }
+        uint64_t got = 0, expected = 0;
+        double e = measure( reps, [&]( size_t ){ got = 0; stamps.for_each( [&]( uint64_t v ){ got += v; } ); } );
+        double t = measure( reps, [&]( size_t ){ expected = 0; for ( uint64_t v : plain_stamps ) expected += v; } );
+        if ( got != expected ){
+            cerr << "packed_for_scan: somas divergem (n=" << n << ")\n";
+            ++bad;
+        }
+        rows.push_back( result{ "packed_for_scan", "uint64", n, e, t } );
+    }
+    return bad;
+}
+
+// fim [XVII]
+
+//---------------------------------------------------------------------------------------------------
+
+// [XVIII] Latência de cada push_back (incremental_vector.h)
+
+/**
+* @brief duração em nanossegundos de cada um de n push_back num Vec vazio, em ordem
+* @param sum recebe a soma dos elementos ao fim, lida pelos iterators
+*/
+template < typename Vec >
+std::vector<double> push_latencies( size_t n, size_t& sum ){
+    std::vector<double> ns( n, 0.0 );
+    Vec v;
+    for ( size_t i = 0; i < n; ++i ){
+        auto t0 = chrono::steady_clock::now();
+        v.push_back( make_value<int>( i ) );
+        auto t1 = chrono::steady_clock::now();
+        ns[i] = chrono::duration<double, nano>( t1 - t0 ).count();
+    }
+    sum = 0;
+    for ( int x : v ) sum += (size_t) x;
+    return ns;
+}
+
+/** @brief valor no percentil p (0 a 100) de amostras já ordenadas */
+double percentile( const std::vector<double>& sorted, double p ){
+    size_t k = (size_t) ( p / 100.0 * ( sorted.size()-1 ) + 0.5 );
+    return sorted[k];
+}
+
+/**
+* @brief histograma da latência de n push_back: incremental_vector contra std::vector, uma linha por percentil
+* @return 1 se as somas divergem, descrito em cerr
+*/
+size_t run_latency( size_t n, const options& opt, std::vector<result>& rows ){
+    static const char * names[] = { "latency_p50", "latency_p99", "latency_p99.9", "latency_p99.99", "latency_max" };
+    static const double points[] = { 50, 99, 99.9, 99.99, 100 };
+    bool any = false;
+    for ( const char * name : names ) any = any || wanted( opt, name );
+    if ( !any ) return 0;
+
+    size_t got = 0, expected = 0;
+    std::vector<double> e = push_latencies< incremental_vector<int> >( n, got );
+    std::vector<double> t = push_latencies< std::vector<int> >( n, expected );
+    std::sort( e.begin(), e.end() );
+    std::sort( t.begin(), t.end() );
+    for ( size_t k = 0; k < 5; ++k ){
+        if ( wanted( opt, names[k] ) ) rows.push_back( result{ names[k], "int", n, percentile( e, points[k] ), percentile( t, points[k] ) } );
+    }
+    if ( got != expected ){
+        cerr << "latency: somas divergem (n=" << n << ")\n";
+        return 1;
+    }
+    return 0;
+}
+
+// fim [XVIII]
+
+int main( int argc, char * argv[] ){
+    options opt;
+    for ( int i = 1; i < argc; ++i ){
+        if ( strcmp( argv[i], "--json" ) == 0 ){
+            opt.json = true;
+        }else if ( argv[i][0] >= '0' && argv[i][0] <= '9' ){
+            opt.max_n = strtoull( argv[i], nullptr, 10 );
+        }else{
+            opt.group = argv[i];
+        }
+    }
+
+    std::vector<result> rows;
+    size_t bad = 0;
+    for ( size_t n = 10; n <= opt.max_n; n *= 10 ){
+        run_type<int>( n, opt, rows );
+        run_type<pod64>( n, opt, rows );
+        run_type<string>( n, opt, rows );
+        if ( wanted( opt, "scan" ) || opt.group.compare( 0, 4, "scan" ) == 0 ){
+            bad += run_scan<int>( n, opt, rows );
+            bad += run_scan<float>( n, opt, rows );
+            bad += run_scan<double>( n, opt, rows );
+        }
+        if ( wanted( opt, "parallel" ) || opt.group.compare( 0, 8, "parallel" ) == 0 ){
+            bad += run_parallel<int>( n, opt, rows );
+            bad += run_parallel<double>( n, opt, rows );
+        }
+        if ( wanted( opt, "io" ) || opt.group.compare( 0, 2, "io" ) == 0 ){
+            bad += run_io<int>( n, opt, rows );
+            bad += run_io<double>( n, opt, rows );
+        }
+        if ( wanted( opt, "concurrent" ) || opt.group.compare( 0, 10, "concurrent" ) == 0 ){
+            bad += run_concurrent( n, opt, rows );
+        }
+        if ( wanted( opt, "algo" ) || opt.group.compare( 0, 4, "algo" ) == 0 ){
+            bad += run_algorithms<int>( n, opt, rows );
+            bad += run_algorithms<string>( n, opt, rows );
+        }
+        if ( wanted( opt, "huge" ) || opt.group.compare( 0, 4, "huge" ) == 0 ){
+            bad += run_huge( n, opt, rows );
+        }
+        if ( wanted( opt, "shrink" ) || opt.group.compare( 0, 6, "shrink" ) == 0 ){
+            bad += run_shrink( n, opt, rows );
+        }
+        if ( wanted( opt, "soa" ) || opt.group.compare( 0, 3, "soa" ) == 0 ){
+            bad += run_soa( n, opt, rows );
+        }
+        if ( wanted( opt, "flat" ) || opt.group.compare( 0, 4, "flat" ) == 0 ){
+            bad += run_flat( n, opt, rows );
+        }
+        if ( wanted( opt, "cow" ) || opt.group.compare( 0, 3, "cow" ) == 0 ){
+            bad += run_cow( n, opt, rows );
+        }
+        if ( wanted( opt, "static" ) || opt.group.compare( 0, 6, "static" ) == 0 ){
+            bad += run_static( n, opt, rows );
+        }
+        if ( wanted( opt, "packed" ) || opt.group.compare( 0, 6, "packed" ) == 0 ){
+            bad += run_packed( n, opt, rows );
+        }
+        if ( wanted( opt, "latency" ) || opt.group.compare( 0, 7, "latency" ) == 0 ){
+            bad += run_latency( n, opt, rows );
+        }
+        if ( wanted( opt, "pmr" ) || opt.group.compare( 0, 3, "pmr" ) == 0 ){
+            bad += run_pmr( n, opt, rows );
+        }
+    }
+
+    report( rows, opt.json );
+    return bad == 0 ? 0 : 1;
+}
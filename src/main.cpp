@@ -2,7 +2,7 @@
     @brief parte principal onde o vector pode ser testaddo.
 */
 
-#ifndef VECTOR_h
+#ifndef VECTOR_H
 #define VECTOR_H
 #include "../include/vector.h"
 #endif